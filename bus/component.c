@@ -60,6 +60,13 @@ struct _BusComponent {
     /* process id of the process (e.g. ibus-config, ibus-engine-*, ..) of the component. */
     GPid     pid;
     guint    child_source_id;
+
+    /* the number of the engines created or being created, and a timeout to
+     * stop the process when it has no engines. */
+    guint    n_engines;
+    guint    idle_stop_id;
+    /* TRUE if the idle process was told to exit and is not reaped yet. */
+    gboolean stopping;
 };
 
 struct _BusComponentClass {
@@ -193,6 +200,11 @@ bus_component_get_property (BusComponent *component,
 static void
 bus_component_destroy (BusComponent *component)
 {
+    if (component->idle_stop_id != 0) {
+        g_source_remove (component->idle_stop_id);
+        component->idle_stop_id = 0;
+    }
+
     if (component->pid != 0) {
         bus_component_stop (component);
         g_spawn_close_pid (component->pid);
@@ -328,11 +340,16 @@ bus_component_child_cb (GPid          pid,
 {
     g_assert (BUS_IS_COMPONENT (component));
     g_assert (component->pid == pid);
+    gboolean stopping = component->stopping;
+
     g_spawn_close_pid (pid);
     component->pid = 0;
     component->child_source_id = 0;
+    component->stopping = FALSE;
 
-    if (component->restart) {
+    /* bus_engine_proxy_new() could be waiting for the factory of the idle
+     * process which was stopped. */
+    if (component->restart || (stopping && component->n_engines > 0)) {
         bus_component_start (component, component->verbose);
     }
 }
@@ -343,6 +360,7 @@ bus_component_start (BusComponent *component,
 {
     g_assert (BUS_IS_COMPONENT (component));
 
+    /* A stopping process is started again by bus_component_child_cb(). */
     if (component->pid != 0)
         return TRUE;
 
@@ -410,6 +428,59 @@ bus_component_is_running (BusComponent *component)
     return (component->pid != 0);
 }
 
+void
+bus_component_hold (BusComponent *component)
+{
+    g_assert (BUS_IS_COMPONENT (component));
+
+    component->n_engines++;
+    if (component->idle_stop_id != 0) {
+        g_source_remove (component->idle_stop_id);
+        component->idle_stop_id = 0;
+    }
+}
+
+static gboolean
+bus_component_idle_stop_cb (BusComponent *component)
+{
+    component->idle_stop_id = 0;
+
+    if (component->n_engines == 0) {
+        if (g_verbose) {
+            g_message ("Stop idle component %s",
+                       ibus_component_get_name (component->component));
+        }
+        /* Do not create engines with the factory of the exiting process. */
+        component->stopping = TRUE;
+        bus_component_set_factory (component, NULL);
+        bus_component_stop (component);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+void
+bus_component_release (BusComponent *component)
+{
+    g_assert (BUS_IS_COMPONENT (component));
+    g_return_if_fail (component->n_engines > 0);
+
+    if (--component->n_engines > 0)
+        return;
+
+    /* Only the process started by ibus-daemon is stopped, and
+     * bus_engine_proxy_new() starts it again. */
+    if (g_engine_idle_timeout <= 0 || component->pid == 0 ||
+        component->restart || component->idle_stop_id != 0) {
+        return;
+    }
+    component->idle_stop_id =
+            g_timeout_add_seconds_full (G_PRIORITY_LOW,
+                                        g_engine_idle_timeout,
+                                        (GSourceFunc) bus_component_idle_stop_cb,
+                                        component,
+                                        NULL);
+}
+
 BusComponent *
 bus_component_from_engine_desc (IBusEngineDesc *engine)
 {
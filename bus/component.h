@@ -99,6 +99,22 @@ gboolean         bus_component_is_running        (BusComponent    *component);
 
 void             bus_component_set_restart       (BusComponent    *component,
                                                   gboolean         restart);
+
+/**
+ * bus_component_hold:
+ *
+ * Count an engine of the component which is created or being created.
+ */
+void             bus_component_hold              (BusComponent    *component);
+
+/**
+ * bus_component_release:
+ *
+ * Release an engine counted by bus_component_hold(). The process started
+ * for the component is stopped when it has no engines for
+ * g_engine_idle_timeout seconds.
+ */
+void             bus_component_release           (BusComponent    *component);
 BusComponent    *bus_component_from_engine_desc  (IBusEngineDesc  *engine);
 
 G_END_DECLS
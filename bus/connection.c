@@ -37,6 +37,21 @@ struct _BusConnection {
     GList  *names;
 
     guint  filter_id;
+
+    /* message statistics updated by the filter function, which could run
+     * in the GDBus's worker thread. */
+    GMutex   stats_lock;
+    guint64  n_incoming;
+    guint64  incoming_bytes;
+    guint64  n_outgoing;
+    guint64  outgoing_bytes;
+    /* the start time and the number of forwarded messages of the current
+     * rate limit window. */
+    gint64   rate_window_start;
+    guint    rate_window_count;
+
+    /* IBusSerializableWireVersion which the client can deserialize. */
+    guint    wire_version;
 };
 
 struct _BusConnectionClass {
@@ -49,6 +64,7 @@ struct _BusConnectionClass {
 
 /* functions prototype */
 static void     bus_connection_destroy      (BusConnection      *connection);
+static void     bus_connection_finalize     (GObject            *object);
 static void     bus_connection_set_dbus_connection
                                             (BusConnection      *connection,
                                              GDBusConnection    *dbus_connection);
@@ -66,14 +82,17 @@ G_DEFINE_TYPE (BusConnection, bus_connection, IBUS_TYPE_OBJECT)
 static void
 bus_connection_class_init (BusConnectionClass *class)
 {
+    GObjectClass *gobject_class = G_OBJECT_CLASS (class);
     IBusObjectClass *ibus_object_class = IBUS_OBJECT_CLASS (class);
 
+    gobject_class->finalize = bus_connection_finalize;
     ibus_object_class->destroy = (IBusObjectDestroyFunc) bus_connection_destroy;
 }
 
 static void
 bus_connection_init (BusConnection *connection)
 {
+    g_mutex_init (&connection->stats_lock);
 }
 
 static void
@@ -107,6 +126,16 @@ bus_connection_destroy (BusConnection *connection)
     IBUS_OBJECT_CLASS(bus_connection_parent_class)->destroy (IBUS_OBJECT (connection));
 }
 
+static void
+bus_connection_finalize (GObject *object)
+{
+    BusConnection *connection = BUS_CONNECTION (object);
+
+    g_mutex_clear (&connection->stats_lock);
+
+    G_OBJECT_CLASS (bus_connection_parent_class)->finalize (object);
+}
+
 static void
 bus_connection_dbus_connection_closed_cb (GDBusConnection *dbus_connection,
                                           gboolean         remote_peer_vanished,
@@ -239,3 +268,102 @@ bus_connection_set_filter (BusConnection             *connection,
         /* Note: g_dbus_connection_add_filter seems not to return zero as a valid id. */
     }
 }
+
+void
+bus_connection_add_message_stats (BusConnection *connection,
+                                  gboolean       incoming,
+                                  gsize          bytes)
+{
+    g_assert (BUS_IS_CONNECTION (connection));
+
+    g_mutex_lock (&connection->stats_lock);
+    if (incoming) {
+        connection->n_incoming++;
+        connection->incoming_bytes += bytes;
+    } else {
+        connection->n_outgoing++;
+        connection->outgoing_bytes += bytes;
+    }
+    g_mutex_unlock (&connection->stats_lock);
+}
+
+gboolean
+bus_connection_check_rate_limit (BusConnection *connection,
+                                 guint          max_per_second)
+{
+    gboolean retval = TRUE;
+    gint64 now;
+
+    g_assert (BUS_IS_CONNECTION (connection));
+
+    if (max_per_second == 0)
+        return TRUE;
+
+    now = g_get_monotonic_time ();
+    g_mutex_lock (&connection->stats_lock);
+    if (now - connection->rate_window_start >= G_USEC_PER_SEC) {
+        connection->rate_window_start = now;
+        connection->rate_window_count = 0;
+    }
+    if (connection->rate_window_count < max_per_second)
+        connection->rate_window_count++;
+    else
+        retval = FALSE;
+    g_mutex_unlock (&connection->stats_lock);
+    return retval;
+}
+
+GVariant *
+bus_connection_serialize_message_stats (BusConnection *connection)
+{
+    GVariant *retval;
+
+    g_assert (BUS_IS_CONNECTION (connection));
+
+    g_mutex_lock (&connection->stats_lock);
+    retval = g_variant_new ("(stttt)",
+                            connection->unique_name ? connection->unique_name
+                                                    : "",
+                            connection->n_incoming,
+                            connection->incoming_bytes,
+                            connection->n_outgoing,
+                            connection->outgoing_bytes);
+    g_mutex_unlock (&connection->stats_lock);
+    return retval;
+}
+
+guint
+bus_connection_get_wire_version (BusConnection *connection)
+{
+    g_assert (BUS_IS_CONNECTION (connection));
+    return connection->wire_version;
+}
+
+void
+bus_connection_set_wire_version (BusConnection *connection,
+                                 guint          version)
+{
+    g_assert (BUS_IS_CONNECTION (connection));
+    connection->wire_version = version;
+}
+
+GVariant *
+bus_connection_serialize (BusConnection    *connection,
+                          IBusSerializable *object)
+{
+    GVariant *variant;
+    gint old_version;
+
+    g_assert (IBUS_IS_SERIALIZABLE (object));
+
+    if (connection == NULL || connection->wire_version ==
+        IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY) {
+        return ibus_serializable_serialize (object);
+    }
+
+    old_version = ibus_serializable_set_thread_wire_version (
+            connection->wire_version);
+    variant = ibus_serializable_serialize (object);
+    ibus_serializable_set_thread_wire_version (old_version);
+    return variant;
+}
@@ -126,6 +126,68 @@ void             bus_connection_set_filter          (BusConnection      *connect
                                                      gpointer            user_data,
                                                      GDestroyNotify      user_data_free_func);
 
+/**
+ * bus_connection_add_message_stats:
+ * @incoming: %TRUE if the message is received from the connection.
+ * @bytes: the size of the message body.
+ *
+ * Count a message which passes the filter function of the connection.
+ * This function is thread safe.
+ */
+void             bus_connection_add_message_stats   (BusConnection      *connection,
+                                                     gboolean            incoming,
+                                                     gsize               bytes);
+
+/**
+ * bus_connection_check_rate_limit:
+ * @max_per_second: the maximum number of messages in a second, or 0 for
+ *                  no limit.
+ * @returns: %FALSE if the connection already sent @max_per_second messages
+ *           in the current one second window.
+ *
+ * Count a method call forwarded from the connection against the rate limit.
+ * This function is thread safe.
+ */
+gboolean         bus_connection_check_rate_limit    (BusConnection      *connection,
+                                                     guint               max_per_second);
+
+/**
+ * bus_connection_serialize_message_stats:
+ * @returns: (transfer floating): "(stttt)" of the unique name and the
+ *           numbers and body bytes of incoming and outgoing messages.
+ *
+ * Get the message statistics of the connection.
+ */
+GVariant        *bus_connection_serialize_message_stats
+                                                    (BusConnection      *connection);
+
+/**
+ * bus_connection_get_wire_version:
+ * @returns: the #IBusSerializableWireVersion negotiated by the client with
+ *           the SetWireVersion method, or
+ *           %IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY.
+ */
+guint            bus_connection_get_wire_version    (BusConnection      *connection);
+
+/**
+ * bus_connection_set_wire_version:
+ *
+ * Set the #IBusSerializableWireVersion which the client can deserialize.
+ */
+void             bus_connection_set_wire_version    (BusConnection      *connection,
+                                                     guint               version);
+
+/**
+ * bus_connection_serialize:
+ * @connection: (nullable): the receiver of the @object.
+ * @returns: (transfer floating): the serialized @object in the wire version
+ *           of @connection.
+ *
+ * Serialize an #IBusSerializable to be sent to the connection.
+ */
+GVariant        *bus_connection_serialize           (BusConnection      *connection,
+                                                     IBusSerializable   *object);
+
 G_END_DECLS
 #endif
 
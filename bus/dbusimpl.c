@@ -29,6 +29,7 @@
 #include "ibusimpl.h"
 #include "marshalers.h"
 #include "matchrule.h"
+#include "stats.h"
 #include "types.h"
 
 enum {
@@ -66,7 +67,14 @@ struct _BusDBusImpl {
     GList *dispatch_queue;
 
     GMutex forward_lock;
-    GList *forward_queue;
+    /* a map from a sender BusConnection to its BusForwardQueue. The
+     * messages of one sender are forwarded in order. */
+    GHashTable *forward_queues;
+    /* BusForwardQueues which have pending messages. They are drained in
+     * round-robin so a noisy client can not delay the others. */
+    GQueue forward_ready_queues;
+    /* the number of all pending forwarded messages. */
+    guint forward_length;
 
     /* a list of BusMethodCall to be used to reply when services are
        really available */
@@ -626,6 +634,8 @@ bus_dbus_impl_init (BusDBusImpl *dbus)
 
     g_mutex_init (&dbus->dispatch_lock);
     g_mutex_init (&dbus->forward_lock);
+    g_queue_init (&dbus->forward_ready_queues);
+    dbus->forward_queues = g_hash_table_new (g_direct_hash, g_direct_equal);
 
     /* other members are automatically zero-initialized. */
 }
@@ -1564,6 +1574,11 @@ bus_dbus_impl_connection_filter_cb (GDBusConnection *dbus_connection,
     BusConnection *connection = bus_connection_lookup (dbus_connection);
     g_assert (connection != NULL);
 
+    GVariant *body = g_dbus_message_get_body (message);
+    bus_connection_add_message_stats (connection,
+                                      incoming,
+                                      body ? g_variant_get_size (body) : 0);
+
     if (incoming) {
         /* is incoming message */
 
@@ -1828,23 +1843,107 @@ struct _BusForwardData {
     BusConnection *sender_connection;
 };
 
+typedef struct _BusForwardQueue BusForwardQueue;
+struct _BusForwardQueue {
+    BusConnection *sender_connection;
+    /* a queue of BusForwardData. */
+    GQueue messages;
+};
+
+static void
+bus_forward_data_free (BusForwardData *data)
+{
+    g_object_unref (data->message);
+    g_object_unref (data->sender_connection);
+    g_slice_free (BusForwardData, data);
+}
+
+/**
+ * bus_dbus_impl_forward_is_limited:
+ *
+ * Return TRUE if the message could be rejected by the rate and queue
+ * limits. Only method calls which expect a reply are limited since their
+ * senders get an error. Signals, method replies and the calls without a
+ * reply could carry a state which would be lost silently.
+ */
+static gboolean
+bus_dbus_impl_forward_is_limited (GDBusMessage *message)
+{
+    return g_dbus_message_get_message_type (message)
+                    == G_DBUS_MESSAGE_TYPE_METHOD_CALL &&
+           (g_dbus_message_get_flags (message) &
+            G_DBUS_MESSAGE_FLAGS_NO_REPLY_EXPECTED) == 0;
+}
+
+/**
+ * bus_dbus_impl_forward_reject:
+ *
+ * Reply a LimitsExceeded error to the sender of a dropped method call.
+ * GDBusConnection is thread safe, so this could be called by the GDBus's
+ * worker thread.
+ */
+static void
+bus_dbus_impl_forward_reject (BusConnection *connection,
+                              GDBusMessage  *message)
+{
+    GDBusMessage *reply_message = g_dbus_message_new_method_error (
+            message,
+            "org.freedesktop.DBus.Error.LimitsExceeded",
+            "Too many messages from '%s'.",
+            bus_connection_get_unique_name (connection));
+    g_dbus_message_set_sender (reply_message, "org.freedesktop.DBus");
+    g_dbus_message_set_destination (reply_message,
+                                    bus_connection_get_unique_name (connection));
+    g_dbus_connection_send_message (
+            bus_connection_get_dbus_connection (connection),
+            reply_message,
+            G_DBUS_SEND_MESSAGE_FLAGS_NONE,
+            NULL, NULL);
+    g_object_unref (reply_message);
+}
+
+/**
+ * bus_dbus_impl_forward_pop:
+ *
+ * Take the next message to be forwarded, one message of each sender in
+ * turn. Should be called with dbus->forward_lock held.
+ */
+static BusForwardData *
+bus_dbus_impl_forward_pop (BusDBusImpl *dbus)
+{
+    BusForwardQueue *queue =
+            (BusForwardQueue *) g_queue_pop_head (&dbus->forward_ready_queues);
+    BusForwardData *data;
+
+    g_return_val_if_fail (queue != NULL, NULL);
+
+    data = (BusForwardData *) g_queue_pop_head (&queue->messages);
+    if (g_queue_is_empty (&queue->messages)) {
+        g_hash_table_remove (dbus->forward_queues, queue->sender_connection);
+        g_slice_free (BusForwardQueue, queue);
+    } else {
+        g_queue_push_tail (&dbus->forward_ready_queues, queue);
+    }
+    dbus->forward_length--;
+    return data;
+}
+
 /**
  * bus_dbus_impl_forward_message_ible_cb:
  *
- * Process the first element of the dbus->forward_queue. The first element is
- * forwarded by g_dbus_connection_send_message.
+ * Process the next element of the forward queues. The element is forwarded
+ * by g_dbus_connection_send_message.
  */
 static gboolean
 bus_dbus_impl_forward_message_idle_cb (BusDBusImpl   *dbus)
 {
-    g_return_val_if_fail (dbus->forward_queue != NULL, FALSE);
+    g_return_val_if_fail (dbus->forward_length > 0, FALSE);
 
     g_mutex_lock (&dbus->forward_lock);
-    BusForwardData *data = (BusForwardData *) dbus->forward_queue->data;
-    dbus->forward_queue = g_list_delete_link (dbus->forward_queue,
-                                              dbus->forward_queue);
-    gboolean has_message = (dbus->forward_queue != NULL);
+    BusForwardData *data = bus_dbus_impl_forward_pop (dbus);
+    gboolean has_message = (dbus->forward_length > 0);
     g_mutex_unlock (&dbus->forward_lock);
+    bus_stats_add (BUS_STATS_FORWARD_QUEUE_DEPTH, -1);
 
     do {
         const gchar *destination =
@@ -1894,9 +1993,7 @@ bus_dbus_impl_forward_message_idle_cb (BusDBusImpl   *dbus)
         g_object_unref (reply_message);
     } while (0);
 
-    g_object_unref (data->message);
-    g_object_unref (data->sender_connection);
-    g_slice_free (BusForwardData, data);
+    bus_forward_data_free (data);
     return has_message;
 }
 
@@ -1926,9 +2023,34 @@ bus_dbus_impl_forward_message (BusDBusImpl   *dbus,
     data->sender_connection = g_object_ref (connection);
 
     g_mutex_lock (&dbus->forward_lock);
-    gboolean is_running = (dbus->forward_queue != NULL);
-    dbus->forward_queue = g_list_append (dbus->forward_queue, data);
+    gboolean is_running = (dbus->forward_length > 0);
+    BusForwardQueue *queue = (BusForwardQueue *) g_hash_table_lookup (
+            dbus->forward_queues, connection);
+
+    if (bus_dbus_impl_forward_is_limited (message) &&
+        ((g_forward_queue_limit > 0 && queue != NULL &&
+          queue->messages.length >= (guint) g_forward_queue_limit) ||
+         !bus_connection_check_rate_limit (connection,
+                                           MAX (g_forward_rate_limit, 0)))) {
+        g_mutex_unlock (&dbus->forward_lock);
+        bus_dbus_impl_forward_reject (connection, message);
+        bus_forward_data_free (data);
+        bus_stats_add (BUS_STATS_MESSAGES_DROPPED, 1);
+        return;
+    }
+
+    if (queue == NULL) {
+        queue = g_slice_new0 (BusForwardQueue);
+        queue->sender_connection = connection;
+        g_queue_init (&queue->messages);
+        g_hash_table_insert (dbus->forward_queues, connection, queue);
+        g_queue_push_tail (&dbus->forward_ready_queues, queue);
+    }
+    g_queue_push_tail (&queue->messages, data);
+    dbus->forward_length++;
     g_mutex_unlock (&dbus->forward_lock);
+    bus_stats_add (BUS_STATS_MESSAGES_FORWARDED, 1);
+    bus_stats_add (BUS_STATS_FORWARD_QUEUE_DEPTH, 1);
 
     if (!is_running) {
         g_idle_add_full (G_PRIORITY_DEFAULT,
@@ -1977,6 +2099,8 @@ bus_dbus_impl_dispatch_message_by_rule_idle_cb (BusDBusImpl *dbus)
     if (G_UNLIKELY (IBUS_OBJECT_DESTROYED (dbus))) {
         /* dbus was destryed */
         g_mutex_lock (&dbus->dispatch_lock);
+        bus_stats_add (BUS_STATS_DISPATCH_QUEUE_DEPTH,
+                       - (gint64) g_list_length (dbus->dispatch_queue));
         g_list_free_full (dbus->dispatch_queue,
                           (GDestroyNotify) bus_dispatch_data_free);
         dbus->dispatch_queue = NULL;
@@ -1992,6 +2116,7 @@ bus_dbus_impl_dispatch_message_by_rule_idle_cb (BusDBusImpl *dbus)
                                                dbus->dispatch_queue);
     gboolean has_message = (dbus->dispatch_queue != NULL);
     g_mutex_unlock (&dbus->dispatch_lock);
+    bus_stats_add (BUS_STATS_DISPATCH_QUEUE_DEPTH, -1);
 
     GList *link = NULL;
     GList *recipients = NULL;
@@ -2059,6 +2184,8 @@ bus_dbus_impl_dispatch_message_by_rule (BusDBusImpl     *dbus,
     dbus->dispatch_queue = g_list_append (dbus->dispatch_queue,
                     bus_dispatch_data_new (message, skip_connection));
     g_mutex_unlock (&dbus->dispatch_lock);
+    bus_stats_add (BUS_STATS_MESSAGES_DISPATCHED, 1);
+    bus_stats_add (BUS_STATS_DISPATCH_QUEUE_DEPTH, 1);
     if (!is_running) {
         g_idle_add_full (
                 G_PRIORITY_DEFAULT,
@@ -2133,3 +2260,28 @@ bus_dbus_impl_unregister_object (BusDBusImpl *dbus,
     return TRUE;
 }
 
+guint
+bus_dbus_impl_get_n_rules (BusDBusImpl *dbus)
+{
+    g_assert (BUS_IS_DBUS_IMPL (dbus));
+
+    return g_list_length (dbus->rules);
+}
+
+GVariant *
+bus_dbus_impl_serialize_connection_stats (BusDBusImpl *dbus)
+{
+    GVariantBuilder builder;
+    GList *p;
+
+    g_assert (BUS_IS_DBUS_IMPL (dbus));
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(stttt)"));
+    for (p = dbus->connections; p != NULL; p = p->next) {
+        g_variant_builder_add_value (
+                &builder,
+                bus_connection_serialize_message_stats (
+                        (BusConnection *) p->data));
+    }
+    return g_variant_builder_end (&builder);
+}
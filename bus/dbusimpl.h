@@ -123,6 +123,21 @@ gboolean         bus_dbus_impl_register_object  (BusDBusImpl    *dbus,
  */
 gboolean         bus_dbus_impl_unregister_object(BusDBusImpl    *dbus,
                                                  IBusService    *object);
+
+/**
+ * bus_dbus_impl_get_n_rules:
+ * @returns: The number of match rules added by the connections.
+ */
+guint            bus_dbus_impl_get_n_rules      (BusDBusImpl    *dbus);
+
+/**
+ * bus_dbus_impl_serialize_connection_stats:
+ * @returns: (transfer floating): "a(stttt)" of the message statistics of
+ *           each active connection. See
+ *           bus_connection_serialize_message_stats().
+ */
+GVariant        *bus_dbus_impl_serialize_connection_stats
+                                                (BusDBusImpl    *dbus);
 G_END_DECLS
 #endif
 
@@ -26,6 +26,7 @@
 #include "global.h"
 #include "ibusimpl.h"
 #include "marshalers.h"
+#include "stats.h"
 #include "types.h"
 
 struct _BusEngineProxy {
@@ -485,6 +486,7 @@ bus_engine_proxy_init (BusEngineProxy *engine)
 {
     engine->surrounding_text = g_object_ref_sink (text_empty);
     engine->prop_list = g_object_ref_sink (prop_list_empty);
+    bus_stats_add (BUS_STATS_ENGINE_PROXIES, 1);
 }
 
 static void
@@ -544,6 +546,8 @@ bus_engine_proxy_real_destroy (IBusProxy *proxy)
 {
     BusEngineProxy *engine = (BusEngineProxy *)proxy;
 
+    bus_stats_add (BUS_STATS_ENGINE_PROXIES, -1);
+
     if (engine->desc) {
         g_object_unref (engine->desc);
         engine->desc = NULL;
@@ -564,6 +568,17 @@ bus_engine_proxy_real_destroy (IBusProxy *proxy)
         engine->prop_list = NULL;
     }
 
+    /* let the factory pool the engine instead of destroying it. */
+    GDBusConnection *connection =
+            g_dbus_proxy_get_connection ((GDBusProxy *) engine);
+    if (((IBusProxy *) engine)->own &&
+        !g_dbus_connection_is_closed (connection)) {
+        ((IBusProxy *) engine)->own = FALSE;
+        bus_factory_proxy_release_engine (
+                connection,
+                g_dbus_proxy_get_object_path ((GDBusProxy *) engine));
+    }
+
     IBUS_PROXY_CLASS (bus_engine_proxy_parent_class)->destroy (
             (IBusProxy *)engine);
 }
@@ -865,6 +880,7 @@ engine_proxy_new_data_free (EngineProxyNewData *data)
             g_signal_handler_disconnect (data->component, data->handler_id);
             data->handler_id = 0;
         }
+        bus_component_release (data->component);
         g_clear_object (&data->component);
     }
 
@@ -918,6 +934,14 @@ create_engine_ready_cb (BusFactoryProxy    *factory,
                                            g_dbus_proxy_get_connection ((GDBusProxy *)data->factory));
     g_free (path);
 
+    /* the component keeps its process while the engine lives. */
+    bus_component_hold (data->component);
+    g_signal_connect_object (engine,
+                             "destroy",
+                             G_CALLBACK (bus_component_release),
+                             data->component,
+                             G_CONNECT_SWAPPED);
+
     /* FIXME: set destroy callback ? */
     g_task_return_pointer (data->task, engine, NULL);
 
@@ -1056,6 +1080,9 @@ bus_engine_proxy_new (IBusEngineDesc      *desc,
     data->desc = g_object_ref (desc);
     data->component = bus_component_from_engine_desc (desc);
     g_object_ref (data->component);
+    /* the process of the component is not stopped while it is creating
+     * the engine. */
+    bus_component_hold (data->component);
     data->task = task;
     data->timeout = timeout;
 
@@ -1128,6 +1155,78 @@ bus_engine_proxy_new_finish (GAsyncResult   *res,
     return retval;
 }
 
+typedef struct {
+    const gchar        *method_name;
+    GAsyncReadyCallback callback;
+    gpointer            user_data;
+    gint64              start_time;
+} RoundTripData;
+
+static void
+_round_trip_cb (GObject       *object,
+                GAsyncResult  *res,
+                RoundTripData *data)
+{
+    bus_stats_add_engine_round_trip (data->method_name,
+                                     g_get_monotonic_time () -
+                                     data->start_time);
+    if (data->callback)
+        data->callback (object, res, data->user_data);
+    g_slice_free (RoundTripData, data);
+}
+
+/**
+ * bus_engine_proxy_call_with_callback:
+ * @method_name: A static string of a method name of
+ *     org.freedesktop.IBus.Engine.
+ *
+ * Call a method of the engine whose reply is needed and record its round
+ * trip time in the histogram of @method_name.
+ */
+static void
+bus_engine_proxy_call_with_callback (BusEngineProxy     *engine,
+                                     const gchar        *method_name,
+                                     GVariant           *parameters,
+                                     GAsyncReadyCallback callback,
+                                     gpointer            user_data)
+{
+    RoundTripData *data = g_slice_new (RoundTripData);
+    data->method_name = method_name;
+    data->callback = callback;
+    data->user_data = user_data;
+    data->start_time = g_get_monotonic_time ();
+
+    g_dbus_proxy_call ((GDBusProxy *)engine,
+                       method_name,
+                       parameters,
+                       G_DBUS_CALL_FLAGS_NONE,
+                       -1,
+                       NULL,
+                       (GAsyncReadyCallback) _round_trip_cb,
+                       data);
+}
+
+/**
+ * bus_engine_proxy_call:
+ *
+ * Call a method of the engine without waiting for the reply. The call has
+ * no round trip since the engine does not send the reply.
+ */
+static void
+bus_engine_proxy_call (BusEngineProxy *engine,
+                       const gchar    *method_name,
+                       GVariant       *parameters)
+{
+    g_dbus_proxy_call ((GDBusProxy *)engine,
+                       method_name,
+                       parameters,
+                       G_DBUS_CALL_FLAGS_NONE,
+                       -1,
+                       NULL,
+                       NULL,
+                       NULL);
+}
+
 void
 bus_engine_proxy_process_key_event (BusEngineProxy      *engine,
                                     guint                keyval,
@@ -1154,14 +1253,12 @@ bus_engine_proxy_process_key_event (BusEngineProxy      *engine,
         }
     }
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "ProcessKeyEvent",
-                       g_variant_new ("(uuu)", keyval, keycode, state),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       callback,
-                       user_data);
+    bus_engine_proxy_call_with_callback (
+            engine,
+            "ProcessKeyEvent",
+            g_variant_new ("(uuu)", keyval, keycode, state),
+            callback,
+            user_data);
 }
 
 void
@@ -1178,14 +1275,9 @@ bus_engine_proxy_set_cursor_location (BusEngineProxy *engine,
         engine->y = y;
         engine->w = w;
         engine->h = h;
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "SetCursorLocation",
-                           g_variant_new ("(iiii)", x, y, w, h),
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "SetCursorLocation",
+                               g_variant_new ("(iiii)", x, y, w, h));
     }
 }
 
@@ -1196,14 +1288,9 @@ bus_engine_proxy_process_hand_writing_event
 {
     g_assert (BUS_IS_ENGINE_PROXY (engine));
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "ProcessHandWritingEvent",
-                       coordinates,
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "ProcessHandWritingEvent",
+                           coordinates);
 }
 
 void
@@ -1213,14 +1300,9 @@ bus_engine_proxy_cancel_hand_writing
 {
     g_assert (BUS_IS_ENGINE_PROXY (engine));
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "CancelHandWriting",
-                       g_variant_new ("(u)", n_strokes),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "CancelHandWriting",
+                           g_variant_new ("(u)", n_strokes));
 }
 
 void
@@ -1231,14 +1313,9 @@ bus_engine_proxy_set_capabilities (BusEngineProxy *engine,
 
     if (engine->capabilities != caps) {
         engine->capabilities = caps;
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "SetCapabilities",
-                           g_variant_new ("(u)", caps),
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "SetCapabilities",
+                               g_variant_new ("(u)", caps));
     }
 }
 
@@ -1250,14 +1327,9 @@ bus_engine_proxy_property_activate (BusEngineProxy *engine,
     g_assert (BUS_IS_ENGINE_PROXY (engine));
     g_assert (prop_name != NULL);
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "PropertyActivate",
-                       g_variant_new ("(su)", prop_name, prop_state),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "PropertyActivate",
+                           g_variant_new ("(su)", prop_name, prop_state));
 }
 
 void
@@ -1267,14 +1339,9 @@ bus_engine_proxy_property_show (BusEngineProxy *engine,
     g_assert (BUS_IS_ENGINE_PROXY (engine));
     g_assert (prop_name != NULL);
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "PropertyShow",
-                       g_variant_new ("(s)", prop_name),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "PropertyShow",
+                           g_variant_new ("(s)", prop_name));
 }
 
 void bus_engine_proxy_property_hide (BusEngineProxy *engine,
@@ -1283,14 +1350,9 @@ void bus_engine_proxy_property_hide (BusEngineProxy *engine,
     g_assert (BUS_IS_ENGINE_PROXY (engine));
     g_assert (prop_name != NULL);
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "PropertyHide",
-                       g_variant_new ("(s)", prop_name),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "PropertyHide",
+                           g_variant_new ("(s)", prop_name));
 }
 
 void bus_engine_proxy_set_surrounding_text (BusEngineProxy *engine,
@@ -1305,25 +1367,23 @@ void bus_engine_proxy_set_surrounding_text (BusEngineProxy *engine,
         g_strcmp0 (text->text, engine->surrounding_text->text) != 0 ||
         cursor_pos != engine->surrounding_cursor_pos ||
         anchor_pos != engine->selection_anchor_pos) {
+        GDBusConnection *connection =
+                g_dbus_proxy_get_connection ((GDBusProxy *)engine);
         GVariant *variant =
-                ibus_serializable_serialize ((IBusSerializable *)text);
+                bus_connection_serialize (bus_connection_lookup (connection),
+                                          (IBusSerializable *)text);
         if (engine->surrounding_text)
             g_object_unref (engine->surrounding_text);
         engine->surrounding_text = (IBusText *) g_object_ref_sink (text);
         engine->surrounding_cursor_pos = cursor_pos;
         engine->selection_anchor_pos = anchor_pos;
 
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "SetSurroundingText",
-                           g_variant_new ("(vuu)",
-                                          variant,
-                                          cursor_pos,
-                                          anchor_pos),
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "SetSurroundingText",
+                               g_variant_new ("(vuu)",
+                                              variant,
+                                              cursor_pos,
+                                              anchor_pos));
     }
 }
 
@@ -1494,11 +1554,7 @@ bus_engine_proxy_get_active_surrounding_text (BusEngineProxy *engine)
     bus_engine_proxy_##name (BusEngineProxy *engine)        \
     {                                                       \
         g_assert (BUS_IS_ENGINE_PROXY (engine));            \
-        g_dbus_proxy_call ((GDBusProxy *)engine,            \
-                           #Name,                           \
-                           NULL,                            \
-                           G_DBUS_CALL_FLAGS_NONE,          \
-                           -1, NULL, NULL, NULL);           \
+        bus_engine_proxy_call (engine, #Name, NULL);        \
     }
 
 DEFINE_FUNCTION (Reset, reset)
@@ -1525,23 +1581,13 @@ bus_engine_proxy_focus_in (BusEngineProxy *engine,
     if (engine->has_active_surrounding_text)
         g_signal_emit (engine, engine_signals[REQUIRE_SURROUNDING_TEXT], 0);
     if (engine->has_focus_id) {
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "FocusInId",
-                           g_variant_new ("(ss)", object_path, client),
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "FocusInId",
+                               g_variant_new ("(ss)", object_path, client));
     } else {
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "FocusIn",
-                           NULL,
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "FocusIn",
+                               NULL);
     }
 }
 
@@ -1556,23 +1602,13 @@ bus_engine_proxy_focus_out (BusEngineProxy *engine,
     g_clear_pointer (&engine->object_path, g_free);
     g_clear_pointer (&engine->client, g_free);
     if (engine->has_focus_id) {
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "FocusOutId",
-                           g_variant_new ("(s)", object_path),
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "FocusOutId",
+                               g_variant_new ("(s)", object_path));
     } else {
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "FocusOut",
-                           NULL,
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "FocusOut",
+                               NULL);
     }
 }
 
@@ -1584,14 +1620,9 @@ bus_engine_proxy_enable (BusEngineProxy *engine)
         engine->enabled = TRUE;
         if (engine->has_active_surrounding_text)
             g_signal_emit (engine, engine_signals[REQUIRE_SURROUNDING_TEXT], 0);
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "Enable",
-                           NULL,
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "Enable",
+                               NULL);
     }
 }
 
@@ -1601,14 +1632,9 @@ bus_engine_proxy_disable (BusEngineProxy *engine)
     g_assert (BUS_IS_ENGINE_PROXY (engine));
     if (engine->enabled) {
         engine->enabled = FALSE;
-        g_dbus_proxy_call ((GDBusProxy *)engine,
-                           "Disable",
-                           NULL,
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1,
-                           NULL,
-                           NULL,
-                           NULL);
+        bus_engine_proxy_call (engine,
+                               "Disable",
+                               NULL);
     }
 }
 
@@ -1620,14 +1646,9 @@ bus_engine_proxy_candidate_clicked (BusEngineProxy *engine,
 {
     g_assert (BUS_IS_ENGINE_PROXY (engine));
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "CandidateClicked",
-                       g_variant_new ("(uuu)", index, button, state),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "CandidateClicked",
+                           g_variant_new ("(uuu)", index, button, state));
 }
 
 IBusEngineDesc *
@@ -1665,14 +1686,9 @@ bus_engine_proxy_panel_extension_received (BusEngineProxy     *engine,
     variant = ibus_serializable_serialize_object (
             IBUS_SERIALIZABLE (event));
     g_return_if_fail (variant != NULL);
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "PanelExtensionReceived",
-                       g_variant_new ("(v)", variant),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "PanelExtensionReceived",
+                           g_variant_new ("(v)", variant));
 }
 
 void
@@ -1682,14 +1698,9 @@ bus_engine_proxy_panel_extension_register_keys (BusEngineProxy *engine,
     g_assert (BUS_IS_ENGINE_PROXY (engine));
     g_assert (parameters);
 
-    g_dbus_proxy_call ((GDBusProxy *)engine,
-                       "PanelExtensionRegisterKeys",
-                       g_variant_new ("(v)", g_variant_ref (parameters)),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1,
-                       NULL,
-                       NULL,
-                       NULL);
+    bus_engine_proxy_call (engine,
+                           "PanelExtensionRegisterKeys",
+                           g_variant_new ("(v)", g_variant_ref (parameters)));
     if (!g_variant_is_floating (parameters)) {
         g_variant_unref (parameters);
     }
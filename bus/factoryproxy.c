@@ -120,4 +120,55 @@ bus_factory_proxy_create_engine_finish (BusFactoryProxy  *factory,
     return object_path;
 }
 
+static void
+release_engine_ready_cb (GDBusConnection *connection,
+                         GAsyncResult    *res,
+                         gchar           *object_path)
+{
+    GError *error = NULL;
+    GVariant *retval = g_dbus_connection_call_finish (connection, res, &error);
+
+    if (retval != NULL) {
+        g_variant_unref (retval);
+    }
+    else {
+        /* the factory does not know ReleaseEngine. */
+        if (g_error_matches (error,
+                             G_DBUS_ERROR,
+                             G_DBUS_ERROR_UNKNOWN_METHOD) &&
+            !g_dbus_connection_is_closed (connection)) {
+            g_dbus_connection_call (connection,
+                                    NULL,
+                                    object_path,
+                                    "org.freedesktop.IBus.Service",
+                                    "Destroy",
+                                    NULL,
+                                    NULL,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1, NULL, NULL, NULL);
+        }
+        g_error_free (error);
+    }
+    g_free (object_path);
+}
 
+void
+bus_factory_proxy_release_engine (GDBusConnection *connection,
+                                  const gchar     *object_path)
+{
+    g_assert (G_IS_DBUS_CONNECTION (connection));
+    g_assert (object_path != NULL);
+
+    g_dbus_connection_call (connection,
+                            NULL,
+                            IBUS_PATH_FACTORY,
+                            IBUS_INTERFACE_FACTORY,
+                            "ReleaseEngine",
+                            g_variant_new ("(o)", object_path),
+                            NULL,
+                            G_DBUS_CALL_FLAGS_NONE,
+                            g_gdbus_timeout,
+                            NULL,
+                            (GAsyncReadyCallback) release_engine_ready_cb,
+                            g_strdup (object_path));
+}
@@ -84,6 +84,20 @@ gchar           *bus_factory_proxy_create_engine_finish
                                                  GAsyncResult       *res,
                                                  GError            **error);
 
+/**
+ * bus_factory_proxy_release_engine:
+ * @connection: the connection between ibus-daemon and an engine process.
+ * @object_path: the D-Bus object path of an engine created by the factory.
+ *
+ * Invoke "ReleaseEngine" method of the "org.freedesktop.IBus.Factory"
+ * interface to let the factory destroy or pool the engine. If the factory
+ * does not implement the method, the engine is destroyed with the
+ * "Destroy" method of the engine.
+ */
+void             bus_factory_proxy_release_engine
+                                                (GDBusConnection    *connection,
+                                                 const gchar        *object_path);
+
 G_END_DECLS
 #endif
 
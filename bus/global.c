@@ -30,4 +30,12 @@ gchar *g_address = IBUS_SOCKET_DIR;
 gchar *g_cache = "auto";
 gboolean g_mempro = FALSE;
 gboolean g_verbose = FALSE;
+gboolean g_startup_profile = FALSE;
 gint   g_gdbus_timeout = 15000;
+gint   g_forward_rate_limit = 0;
+gint   g_forward_queue_limit = 1000;
+gint   g_preload_delay = 3000;
+gint   g_preload_concurrency = 1;
+gint   g_preload_min_memory = 256;
+gint   g_engine_idle_timeout = 0;
+gint   g_focus_debounce = 0;
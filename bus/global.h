@@ -33,7 +33,15 @@ extern gchar *g_address;
 extern gchar *g_cache;
 extern gboolean g_mempro;
 extern gboolean g_verbose;
+extern gboolean g_startup_profile;
 extern gint   g_gdbus_timeout;
+extern gint   g_forward_rate_limit;
+extern gint   g_forward_queue_limit;
+extern gint   g_preload_delay;
+extern gint   g_preload_concurrency;
+extern gint   g_preload_min_memory;
+extern gint   g_engine_idle_timeout;
+extern gint   g_focus_debounce;
 
 G_END_DECLS
 
@@ -25,6 +25,7 @@
 
 #include <locale.h>
 #include <signal.h>
+#include <string.h>
 #include <strings.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -36,7 +37,10 @@
 #include "global.h"
 #include "inputcontext.h"
 #include "panelproxy.h"
+#include "preload.h"
 #include "server.h"
+#include "startup.h"
+#include "stats.h"
 #include "types.h"
 
 struct _BusIBusImpl {
@@ -63,6 +67,9 @@ struct _BusIBusImpl {
     gboolean embed_preedit_text;
 
     IBusRegistry    *registry;
+    /* a thread which loads the registry while ibus-daemon starts. It is
+     * joined by bus_ibus_impl_wait_for_registry(). */
+    GThread         *registry_thread;
 
     /* a list of BusComponent objects that are created from component XML
      * files (or from the cache of them). */
@@ -72,6 +79,19 @@ struct _BusIBusImpl {
      * IBusEngineDesc object. */
     GHashTable *engine_table;
 
+    /* the generation of the engine lists for QueryEngines. It starts from
+     * the start time of the daemon and is increased when an engine is added
+     * or removed, so that a generation of another daemon instance is
+     * always older than the engines of this instance. */
+    guint64 engines_base_generation;
+    guint64 engines_generation;
+    /* a mapping from an IBusEngineDesc to the generation when it is
+     * added. */
+    GHashTable *engine_generation_table;
+    /* a mapping from a name of a removed active engine to the generation
+     * when it is removed. */
+    GHashTable *removed_engine_table;
+
     GHashTable *engine_focus_id_table;
     GHashTable *engine_active_surrounding_text_table;
 
@@ -215,6 +235,19 @@ static const gchar introspection_xml[] =
     "      <arg direction='in'  type='s' name='client_name' />\n"
     "      <arg direction='out' type='o' name='object_path' />\n"
     "    </method>\n"
+    "    <method name='CreateInputContextWithState'>\n"
+    "      <arg direction='in'  type='s' name='client_name' />\n"
+    "      <arg direction='in'  type='u' name='capabilities' />\n"
+    "      <arg direction='in'  type='u' name='purpose' />\n"
+    "      <arg direction='in'  type='u' name='hints' />\n"
+    "      <arg direction='in'  type='(iiii)' name='cursor_location' />\n"
+    "      <arg direction='in'  type='b' name='client_commit_preedit' />\n"
+    "      <arg direction='out' type='o' name='object_path' />\n"
+    "      <annotation name='org.gtk.GDBus.Since'\n"
+    "          value='1.5.35' />\n"
+    "      <annotation name='org.gtk.GDBus.DocString'\n"
+    "          value='Stability: Unstable' />\n"
+    "    </method>\n"
     "    <method name='RegisterComponent'>\n"
     "      <arg direction='in'  type='v' name='component' />\n"
     "    </method>\n"
@@ -222,6 +255,17 @@ static const gchar introspection_xml[] =
     "      <arg direction='in'  type='as' name='names' />\n"
     "      <arg direction='out' type='av' name='engines' />\n"
     "    </method>\n"
+    "    <method name='QueryEngines'>\n"
+    "      <arg direction='in'  type='a{sv}' name='query' />\n"
+    "      <arg direction='out' type='t' name='generation' />\n"
+    "      <arg direction='out' type='b' name='complete' />\n"
+    "      <arg direction='out' type='aa{sv}' name='engines' />\n"
+    "      <arg direction='out' type='as' name='removed' />\n"
+    "      <annotation name='org.gtk.GDBus.Since'\n"
+    "          value='1.5.35' />\n"
+    "      <annotation name='org.gtk.GDBus.DocString'\n"
+    "          value='Stability: Unstable' />\n"
+    "    </method>\n"
     "    <method name='Exit'>\n"
     "      <arg direction='in'  type='b' name='restart' />\n"
     "    </method>\n"
@@ -232,6 +276,14 @@ static const gchar introspection_xml[] =
     "    <method name='SetGlobalEngine'>\n"
     "      <arg direction='in'  type='s' name='engine_name' />\n"
     "    </method>\n"
+    "    <method name='SetWireVersion'>\n"
+    "      <arg direction='in'  type='u' name='version' />\n"
+    "      <arg direction='out' type='u' name='version' />\n"
+    "      <annotation name='org.gtk.GDBus.Since'\n"
+    "          value='1.5.35' />\n"
+    "      <annotation name='org.gtk.GDBus.DocString'\n"
+    "          value='Stability: Unstable' />\n"
+    "    </method>\n"
     "    <signal name='RegistryChanged'>\n"
     "    </signal>\n"
     "    <signal name='GlobalEngineChanged'>\n"
@@ -281,6 +333,18 @@ static const gchar introspection_xml[] =
     "      <annotation name='org.freedesktop.DBus.Deprecated' value='true'/>\n"
     "    </method>\n"
     "  </interface>\n"
+    "  <interface name='org.freedesktop.IBus.Stats'>\n"
+    "    <method name='GetStats'>\n"
+    "      <arg direction='out' type='a{sv}' name='stats' />\n"
+    "    </method>\n"
+    "    <method name='GetConnectionStats'>\n"
+    "      <arg direction='out' type='a(stttt)' name='connections' />\n"
+    "    </method>\n"
+    "    <method name='GetEngineRoundTrips'>\n"
+    "      <arg direction='out' type='at' name='bounds' />\n"
+    "      <arg direction='out' type='a(sat)' name='histograms' />\n"
+    "    </method>\n"
+    "  </interface>\n"
     "</node>\n";
 
 
@@ -628,6 +692,8 @@ _dbus_name_owner_changed_cb (BusDBusImpl   *dbus,
 static void
 bus_ibus_impl_init (BusIBusImpl *ibus)
 {
+    gint64 begin;
+
     ibus->factory_dict = g_hash_table_new_full (
                             g_str_hash,
                             g_str_equal,
@@ -654,7 +720,13 @@ bus_ibus_impl_init (BusIBusImpl *ibus)
     ibus->panel = NULL;
     ibus->emoji_extension = NULL;
 
+    /* start to load the registry first so that it runs in parallel with
+     * the rest of the initialization. */
+    bus_ibus_impl_registry_init (ibus);
+
+    begin = bus_startup_stage_begin ();
     ibus->keymap = ibus_keymap_get ("us");
+    bus_startup_stage_end ("keymap", begin);
 
     ibus->use_sys_layout = TRUE;
     ibus->embed_preedit_text = TRUE;
@@ -664,6 +736,16 @@ bus_ibus_impl_init (BusIBusImpl *ibus)
     ibus->engine_focus_id_table = g_hash_table_new (g_str_hash, g_str_equal);
     ibus->engine_active_surrounding_text_table = g_hash_table_new (g_str_hash,
                                                                    g_str_equal);
+    ibus->engines_base_generation = g_get_real_time ();
+    ibus->engines_generation = ibus->engines_base_generation;
+    ibus->engine_generation_table = g_hash_table_new_full (NULL,
+                                                           NULL,
+                                                           NULL,
+                                                           g_free);
+    ibus->removed_engine_table = g_hash_table_new_full (g_str_hash,
+                                                        g_str_equal,
+                                                        g_free,
+                                                        g_free);
 
     /* focus the fake_context, if use_global_engine is enabled. */
     if (ibus->use_global_engine)
@@ -673,8 +755,6 @@ bus_ibus_impl_init (BusIBusImpl *ibus)
                       "name-owner-changed",
                       G_CALLBACK (_dbus_name_owner_changed_cb),
                       ibus);
-
-    bus_ibus_impl_registry_init (ibus);
 }
 
 /**
@@ -690,6 +770,7 @@ bus_ibus_impl_destroy (BusIBusImpl *ibus)
     gint status;
     gboolean flag;
 
+    bus_preload_stop ();
     g_list_foreach (ibus->components, (GFunc) bus_component_stop, NULL);
 
     timeout = 0;
@@ -744,6 +825,13 @@ bus_ibus_impl_destroy (BusIBusImpl *ibus)
         g_clear_pointer (&ibus->engine_active_surrounding_text_table,
                          g_hash_table_destroy);
     }
+    if (ibus->engine_generation_table != NULL) {
+        g_clear_pointer (&ibus->engine_generation_table,
+                         g_hash_table_destroy);
+    }
+    if (ibus->removed_engine_table != NULL) {
+        g_clear_pointer (&ibus->removed_engine_table, g_hash_table_destroy);
+    }
 
     IBUS_OBJECT_CLASS (bus_ibus_impl_parent_class)->destroy (
             IBUS_OBJECT (ibus));
@@ -1272,6 +1360,58 @@ _ibus_create_input_context (BusIBusImpl           *ibus,
     }
 }
 
+/**
+ * _ibus_create_input_context_with_state:
+ *
+ * Implement the "CreateInputContextWithState" method call of the
+ * org.freedesktop.IBus interface. The initial state is applied before the
+ * reply, so that the client does not need the following SetCapabilities,
+ * ContentType, SetCursorLocation and ClientCommitPreedit calls.
+ */
+static void
+_ibus_create_input_context_with_state (BusIBusImpl           *ibus,
+                                       GVariant              *parameters,
+                                       GDBusMethodInvocation *invocation)
+{
+    const gchar *client_name = NULL;
+    guint capabilities = 0;
+    guint purpose = 0;
+    guint hints = 0;
+    gint x = 0, y = 0, w = 0, h = 0;
+    gboolean client_commit_preedit = FALSE;
+
+    g_variant_get (parameters, "(&suuu(iiii)b)",
+                   &client_name, &capabilities, &purpose, &hints,
+                   &x, &y, &w, &h, &client_commit_preedit);
+
+    BusConnection *connection =
+            bus_connection_lookup (g_dbus_method_invocation_get_connection (invocation));
+    BusInputContext *context =
+            bus_ibus_impl_create_input_context (ibus,
+                                                connection,
+                                                client_name);
+    if (context == NULL) {
+        g_dbus_method_invocation_return_error (invocation,
+                                               G_DBUS_ERROR,
+                                               G_DBUS_ERROR_FAILED,
+                                               "Create input context failed!");
+        return;
+    }
+
+    bus_input_context_set_client_commit_preedit (context,
+                                                 client_commit_preedit);
+    bus_input_context_set_capabilities (context, capabilities);
+    bus_input_context_set_content_type (context, purpose, hints);
+    bus_input_context_set_cursor_location (context, x, y, w, h);
+
+    g_dbus_method_invocation_return_value (
+            invocation,
+            g_variant_new ("(o)",
+                           ibus_service_get_object_path (
+                                   (IBusService *) context)));
+    g_object_unref (context);
+}
+
 /**
  * _ibus_get_current_input_context:
  *
@@ -1285,6 +1425,9 @@ _ibus_get_current_input_context (BusIBusImpl     *ibus,
 {
     GVariant *retval = NULL;
 
+    /* apply a delayed focus-out to return the latest focus. */
+    if (ibus->focused_context)
+        bus_input_context_flush_focus_out (ibus->focused_context);
     if (!ibus->focused_context)
     {
         g_set_error (error, G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
@@ -1332,6 +1475,47 @@ _ibus_current_input_context_depre (BusIBusImpl           *ibus,
     }
 }
 
+/**
+ * bus_ibus_impl_stamp_engine:
+ *
+ * Record @desc is added to the engine lists in a new generation.
+ */
+static void
+bus_ibus_impl_stamp_engine (BusIBusImpl    *ibus,
+                            IBusEngineDesc *desc)
+{
+    guint64 *generation;
+
+    if (ibus->engine_generation_table == NULL)
+        return;
+    generation = g_new (guint64, 1);
+    *generation = ++ibus->engines_generation;
+    g_hash_table_replace (ibus->engine_generation_table, desc, generation);
+    g_hash_table_remove (ibus->removed_engine_table,
+                         ibus_engine_desc_get_name (desc));
+}
+
+/**
+ * bus_ibus_impl_unstamp_engine:
+ *
+ * Record @desc is removed from the active engines in a new generation.
+ */
+static void
+bus_ibus_impl_unstamp_engine (BusIBusImpl    *ibus,
+                              IBusEngineDesc *desc)
+{
+    guint64 *generation;
+
+    if (ibus->engine_generation_table == NULL)
+        return;
+    generation = g_new (guint64, 1);
+    *generation = ++ibus->engines_generation;
+    g_hash_table_remove (ibus->engine_generation_table, desc);
+    g_hash_table_replace (ibus->removed_engine_table,
+                          g_strdup (ibus_engine_desc_get_name (desc)),
+                          generation);
+}
+
 static void
 _component_destroy_cb (BusComponent *component,
                        BusIBusImpl  *ibus)
@@ -1349,6 +1533,7 @@ _component_destroy_cb (BusComponent *component,
         if (g_list_find (ibus->register_engine_list, p->data)) {
             ibus->register_engine_list =
                     g_list_remove (ibus->register_engine_list, p->data);
+            bus_ibus_impl_unstamp_engine (ibus, (IBusEngineDesc *) p->data);
             g_object_unref (p->data);
         }
     }
@@ -1405,7 +1590,11 @@ _ibus_register_component (BusIBusImpl           *ibus,
     ibus->registered_components = g_list_append (ibus->registered_components,
                                                 g_object_ref_sink (buscomp));
     GList *engines = bus_component_get_engines (buscomp);
-    g_list_foreach (engines, (GFunc) g_object_ref, NULL);
+    GList *p;
+    for (p = engines; p != NULL; p = p->next) {
+        g_object_ref (p->data);
+        bus_ibus_impl_stamp_engine (ibus, (IBusEngineDesc *) p->data);
+    }
     ibus->register_engine_list = g_list_concat (ibus->register_engine_list,
                                                engines);
 
@@ -1508,6 +1697,197 @@ _ibus_get_engines_by_names (BusIBusImpl           *ibus,
     g_free (names);
 }
 
+static gboolean
+_engine_desc_match_query (IBusEngineDesc *desc,
+                          const gchar    *language,
+                          const gchar    *layout,
+                          GPatternSpec   *name_pattern)
+{
+    if (language != NULL) {
+        const gchar *lang = ibus_engine_desc_get_language (desc);
+        gsize len = strlen (language);
+        /* "ja" matches "ja" and "ja_JP". */
+        if (lang == NULL || strncmp (lang, language, len) != 0 ||
+            (lang[len] != '\0' && lang[len] != '_')) {
+            return FALSE;
+        }
+    }
+    if (layout != NULL &&
+        g_strcmp0 (ibus_engine_desc_get_layout (desc), layout) != 0) {
+        return FALSE;
+    }
+    if (name_pattern != NULL &&
+        !g_pattern_match_string (name_pattern,
+                                 ibus_engine_desc_get_name (desc))) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static GVariant *
+_engine_desc_serialize_fields (IBusEngineDesc *desc,
+                               GParamSpec    **pspecs,
+                               guint           n_pspecs)
+{
+    GVariantBuilder builder;
+    guint i;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+    for (i = 0; i < n_pspecs; i++) {
+        GValue value = G_VALUE_INIT;
+
+        g_value_init (&value, pspecs[i]->value_type);
+        g_object_get_property (G_OBJECT (desc), pspecs[i]->name, &value);
+        if (G_VALUE_HOLDS_STRING (&value)) {
+            const gchar *str = g_value_get_string (&value);
+            g_variant_builder_add (&builder, "{sv}",
+                                   pspecs[i]->name,
+                                   g_variant_new_string (str ? str : ""));
+        } else if (G_VALUE_HOLDS_UINT (&value)) {
+            g_variant_builder_add (&builder, "{sv}",
+                                   pspecs[i]->name,
+                                   g_variant_new_uint32 (
+                                           g_value_get_uint (&value)));
+        }
+        g_value_unset (&value);
+    }
+    return g_variant_builder_end (&builder);
+}
+
+/**
+ * _ibus_query_engines:
+ *
+ * Implement the "QueryEngines" method call of the org.freedesktop.IBus
+ * interface. The keys of the query are:
+ *   "active" (b): Query the engines registered by running components
+ *       instead of the engines in the component files.
+ *   "language" (s): The language of the engines, e.g. "ja" or "ja_JP".
+ *   "layout" (s): The keyboard layout of the engines.
+ *   "name-pattern" (s): A glob pattern of the engine names.
+ *   "fields" (as): The IBusEngineDesc property names to be returned. All
+ *       properties are returned by default.
+ *   "since" (t): Return only the engines added after the generation,
+ *       which was returned by the previous call, and the names of the
+ *       active engines removed after it.
+ * The "complete" return value is TRUE when the returned engines are all
+ * engines matched with the query, i.e. "since" is not given or it is older
+ * than this daemon. The engines of the component files are not removed
+ * while the daemon runs since a changed file needs a restart of the daemon,
+ * after which a query with "since" is complete.
+ */
+static void
+_ibus_query_engines (BusIBusImpl           *ibus,
+                     GVariant              *parameters,
+                     GDBusMethodInvocation *invocation)
+{
+    GVariant *query = NULL;
+    gboolean active = FALSE;
+    const gchar *language = NULL;
+    const gchar *layout = NULL;
+    const gchar *name_pattern = NULL;
+    const gchar **fields = NULL;
+    guint64 since = 0;
+    gboolean complete;
+    GPatternSpec *pattern = NULL;
+    GObjectClass *desc_class;
+    GParamSpec **pspecs;
+    guint n_pspecs = 0;
+    GList *engines, *p;
+    GVariantBuilder builder;
+    GVariantBuilder removed_builder;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_variant_get (parameters, "(@a{sv})", &query);
+    g_variant_lookup (query, "active", "b", &active);
+    g_variant_lookup (query, "language", "&s", &language);
+    g_variant_lookup (query, "layout", "&s", &layout);
+    g_variant_lookup (query, "name-pattern", "&s", &name_pattern);
+    g_variant_lookup (query, "fields", "^a&s", &fields);
+    g_variant_lookup (query, "since", "t", &since);
+
+    desc_class = g_type_class_ref (IBUS_TYPE_ENGINE_DESC);
+    if (fields != NULL) {
+        guint i;
+        pspecs = g_new0 (GParamSpec *, g_strv_length ((gchar **) fields) + 1);
+        for (i = 0; fields[i] != NULL; i++) {
+            GParamSpec *pspec = g_object_class_find_property (desc_class,
+                                                              fields[i]);
+            if (pspec == NULL) {
+                g_dbus_method_invocation_return_error (
+                        invocation,
+                        G_DBUS_ERROR,
+                        G_DBUS_ERROR_INVALID_ARGS,
+                        "Unknown engine field: %s", fields[i]);
+                g_free (pspecs);
+                g_free (fields);
+                g_type_class_unref (desc_class);
+                g_variant_unref (query);
+                return;
+            }
+            pspecs[n_pspecs++] = pspec;
+        }
+    } else {
+        pspecs = g_object_class_list_properties (desc_class, &n_pspecs);
+    }
+
+    if (name_pattern != NULL)
+        pattern = g_pattern_spec_new (name_pattern);
+    complete = since < ibus->engines_base_generation;
+
+    if (active)
+        engines = g_list_copy (ibus->register_engine_list);
+    else
+        engines = g_hash_table_get_values (ibus->engine_table);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+    for (p = engines; p != NULL; p = p->next) {
+        IBusEngineDesc *desc = (IBusEngineDesc *) p->data;
+        guint64 *generation;
+
+        if (!complete) {
+            generation = g_hash_table_lookup (ibus->engine_generation_table,
+                                              desc);
+            if ((generation ? *generation : ibus->engines_base_generation)
+                <= since) {
+                continue;
+            }
+        }
+        if (!_engine_desc_match_query (desc, language, layout, pattern))
+            continue;
+        g_variant_builder_add_value (
+                &builder,
+                _engine_desc_serialize_fields (desc, pspecs, n_pspecs));
+    }
+    g_list_free (engines);
+
+    g_variant_builder_init (&removed_builder, G_VARIANT_TYPE_STRING_ARRAY);
+    if (active && !complete) {
+        g_hash_table_iter_init (&iter, ibus->removed_engine_table);
+        while (g_hash_table_iter_next (&iter, &key, &value)) {
+            if (*(guint64 *) value > since) {
+                g_variant_builder_add (&removed_builder, "s",
+                                       (const gchar *) key);
+            }
+        }
+    }
+
+    g_dbus_method_invocation_return_value (
+            invocation,
+            g_variant_new ("(tbaa{sv}as)",
+                           ibus->engines_generation,
+                           complete,
+                           &builder,
+                           &removed_builder));
+
+    if (pattern != NULL)
+        g_pattern_spec_free (pattern);
+    g_free (pspecs);
+    g_free (fields);
+    g_type_class_unref (desc_class);
+    g_variant_unref (query);
+}
+
 /**
  * _ibus_get_active_engines:
  *
@@ -1593,6 +1973,30 @@ _ibus_ping (BusIBusImpl           *ibus,
     g_dbus_method_invocation_return_value (invocation, parameters);
 }
 
+/**
+ * _ibus_set_wire_version:
+ *
+ * Implement the "SetWireVersion" method call of the org.freedesktop.IBus
+ * interface. The client tells the newest IBusSerializableWireVersion which
+ * it supports and the daemon replies the version used for the connection.
+ */
+static void
+_ibus_set_wire_version (BusIBusImpl           *ibus,
+                        GVariant              *parameters,
+                        GDBusMethodInvocation *invocation)
+{
+    BusConnection *connection = bus_connection_lookup (
+            g_dbus_method_invocation_get_connection (invocation));
+    guint version = IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY;
+
+    g_variant_get (parameters, "(u)", &version);
+    version = MIN (version, IBUS_SERIALIZABLE_WIRE_VERSION_CURRENT);
+    if (connection != NULL)
+        bus_connection_set_wire_version (connection, version);
+    g_dbus_method_invocation_return_value (invocation,
+                                           g_variant_new ("(u)", version));
+}
+
 /**
  * _ibus_get_use_sys_layout:
  *
@@ -1953,10 +2357,9 @@ _ibus_set_preload_engines (BusIBusImpl     *ibus,
     }
     g_free (names);
 
-    for (j = 0; j < array->len; j++) {
-        bus_component_start ((BusComponent *) g_ptr_array_index (array, j),
-                             g_verbose);
-    }
+    /* start the engines in the background not to delay the session
+     * startup. */
+    bus_preload_start (array);
 
     g_ptr_array_free (array, TRUE);
 
@@ -2053,6 +2456,113 @@ _ibus_set_global_shortcut_keys (BusIBusImpl     *ibus,
     return TRUE;
 }
 
+/**
+ * _stats_get_stats:
+ *
+ * Implement the "GetStats" method call of the org.freedesktop.IBus.Stats
+ * interface.
+ */
+static void
+_stats_get_stats (BusIBusImpl           *ibus,
+                  GVariant              *parameters,
+                  GDBusMethodInvocation *invocation)
+{
+    GVariantBuilder builder;
+    BusStatsCounter counter;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    for (counter = 0; counter < BUS_STATS_LAST; counter++) {
+        g_variant_builder_add (&builder, "{sv}",
+                               bus_stats_get_counter_name (counter),
+                               g_variant_new_int64 (bus_stats_get (counter)));
+    }
+    g_variant_builder_add (&builder, "{sv}", "match-rules",
+                           g_variant_new_uint32 (
+                                   bus_dbus_impl_get_n_rules (
+                                           BUS_DEFAULT_DBUS)));
+    g_variant_builder_add (&builder, "{sv}", "components",
+                           g_variant_new_uint32 (
+                                   g_list_length (ibus->components)));
+    g_variant_builder_add (&builder, "{sv}", "engines",
+                           g_variant_new_uint32 (
+                                   g_hash_table_size (ibus->engine_table)));
+    g_dbus_method_invocation_return_value (invocation,
+                                           g_variant_new ("(a{sv})",
+                                                          &builder));
+}
+
+/**
+ * _stats_get_connection_stats:
+ *
+ * Implement the "GetConnectionStats" method call of the
+ * org.freedesktop.IBus.Stats interface.
+ */
+static void
+_stats_get_connection_stats (BusIBusImpl           *ibus,
+                             GVariant              *parameters,
+                             GDBusMethodInvocation *invocation)
+{
+    GVariant *connections =
+            bus_dbus_impl_serialize_connection_stats (BUS_DEFAULT_DBUS);
+    g_dbus_method_invocation_return_value (invocation,
+                                           g_variant_new ("(@a(stttt))",
+                                                          connections));
+}
+
+/**
+ * _stats_get_engine_round_trips:
+ *
+ * Implement the "GetEngineRoundTrips" method call of the
+ * org.freedesktop.IBus.Stats interface.
+ */
+static void
+_stats_get_engine_round_trips (BusIBusImpl           *ibus,
+                               GVariant              *parameters,
+                               GDBusMethodInvocation *invocation)
+{
+    g_dbus_method_invocation_return_value (
+            invocation,
+            g_variant_new ("(@at@a(sat))",
+                           bus_stats_serialize_round_trip_bounds (),
+                           bus_stats_serialize_engine_round_trips ()));
+}
+
+/**
+ * bus_ibus_impl_stats_method_call:
+ *
+ * Handle a D-Bus method call whose interface name is
+ * "org.freedesktop.IBus.Stats"
+ */
+static void
+bus_ibus_impl_stats_method_call (BusIBusImpl           *ibus,
+                                 const gchar           *method_name,
+                                 GVariant              *parameters,
+                                 GDBusMethodInvocation *invocation)
+{
+    static const struct {
+        const gchar *method_name;
+        void (* method_callback) (BusIBusImpl *,
+                                  GVariant *,
+                                  GDBusMethodInvocation *);
+    } methods [] =  {
+        { "GetStats",            _stats_get_stats },
+        { "GetConnectionStats",  _stats_get_connection_stats },
+        { "GetEngineRoundTrips", _stats_get_engine_round_trips },
+    };
+
+    gint i;
+    for (i = 0; i < G_N_ELEMENTS (methods); i++) {
+        if (g_strcmp0 (methods[i].method_name, method_name) == 0) {
+            methods[i].method_callback (ibus, parameters, invocation);
+            return;
+        }
+    }
+
+    g_dbus_method_invocation_return_error (
+            invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+            "%s does not support %s", BUS_INTERFACE_STATS, method_name);
+}
+
 /**
  * bus_ibus_impl_service_method_call:
  *
@@ -2069,6 +2579,13 @@ bus_ibus_impl_service_method_call (IBusService           *service,
                                    GVariant              *parameters,
                                    GDBusMethodInvocation *invocation)
 {
+    if (g_strcmp0 (interface_name, BUS_INTERFACE_STATS) == 0) {
+        bus_ibus_impl_stats_method_call ((BusIBusImpl *) service,
+                                         method_name,
+                                         parameters,
+                                         invocation);
+        return;
+    }
     if (g_strcmp0 (interface_name, IBUS_INTERFACE_IBUS) != 0) {
         IBUS_SERVICE_CLASS (bus_ibus_impl_parent_class)->service_method_call (
                         service, connection, sender, object_path,
@@ -2086,11 +2603,15 @@ bus_ibus_impl_service_method_call (IBusService           *service,
     } methods [] =  {
         /* IBus interface */
         { "CreateInputContext",    _ibus_create_input_context },
+        { "CreateInputContextWithState",
+                                   _ibus_create_input_context_with_state },
         { "RegisterComponent",     _ibus_register_component },
         { "GetEnginesByNames",     _ibus_get_engines_by_names },
+        { "QueryEngines",          _ibus_query_engines },
         { "Exit",                  _ibus_exit },
         { "Ping",                  _ibus_ping },
         { "SetGlobalEngine",       _ibus_set_global_engine },
+        { "SetWireVersion",        _ibus_set_wire_version },
         /* Start of deprecated methods */
         { "GetAddress",            _ibus_get_address_depre },
         { "CurrentInputContext",   _ibus_current_input_context_depre },
@@ -2263,20 +2784,18 @@ bus_ibus_impl_get_keymap (BusIBusImpl *ibus)
 }
 
 /**
- * bus_ibus_impl_registry_init:
+ * _registry_load_thread:
  *
- * Initialize IBusRegistry.
+ * The thread function of registry_thread, which loads the component XML
+ * files or the cache of them.
+ *
+ * Returns: A new #IBusRegistry.
  */
-static void
-bus_ibus_impl_registry_init (BusIBusImpl *ibus)
+static gpointer
+_registry_load_thread (gpointer user_data)
 {
-    GList *p;
-    GList *components;
     IBusRegistry *registry = ibus_registry_new ();
-
-    g_assert (!ibus->registry);
-    ibus->components = NULL;
-    ibus->engine_table = g_hash_table_new (g_str_hash, g_str_equal);
+    gint64 begin = bus_startup_stage_begin ();
 
     if (g_strcmp0 (g_cache, "none") == 0) {
         /* Only load registry, but not read and write cache. */
@@ -2310,8 +2829,47 @@ bus_ibus_impl_registry_init (BusIBusImpl *ibus)
         }
     }
 
-    ibus->registry = registry;
-    components = ibus_registry_get_components (registry);
+    bus_startup_stage_end ("registry-load", begin);
+    return registry;
+}
+
+/**
+ * bus_ibus_impl_registry_init:
+ *
+ * Start to load IBusRegistry in registry_thread.
+ */
+static void
+bus_ibus_impl_registry_init (BusIBusImpl *ibus)
+{
+    g_assert (!ibus->registry);
+    g_assert (!ibus->registry_thread);
+    ibus->components = NULL;
+    ibus->engine_table = g_hash_table_new (g_str_hash, g_str_equal);
+
+    ibus->registry_thread = g_thread_new ("ibus-registry",
+                                          _registry_load_thread,
+                                          NULL);
+}
+
+void
+bus_ibus_impl_wait_for_registry (BusIBusImpl *ibus)
+{
+    GList *p;
+    GList *components;
+    gint64 begin;
+
+    g_assert (BUS_IS_IBUS_IMPL (ibus));
+
+    if (ibus->registry_thread == NULL)
+        return;
+
+    begin = bus_startup_stage_begin ();
+    ibus->registry = (IBusRegistry *) g_thread_join (ibus->registry_thread);
+    ibus->registry_thread = NULL;
+    bus_startup_stage_end ("registry-wait", begin);
+
+    begin = bus_startup_stage_begin ();
+    components = ibus_registry_get_components (ibus->registry);
 
     for (p = components; p != NULL; p = p->next) {
         IBusComponent *component = (IBusComponent *) p->data;
@@ -2331,6 +2889,7 @@ bus_ibus_impl_registry_init (BusIBusImpl *ibus)
                 g_hash_table_insert (ibus->engine_table,
                                      (gpointer) name,
                                      desc);
+                bus_ibus_impl_stamp_engine (ibus, desc);
             } else {
                 g_message ("Engine %s is already registered by other component",
                            name);
@@ -2346,11 +2905,14 @@ bus_ibus_impl_registry_init (BusIBusImpl *ibus)
                       G_CALLBACK (_registry_changed_cb),
                       ibus);
     ibus_registry_start_monitor_changes (ibus->registry);
+    bus_startup_stage_end ("registry-setup", begin);
 }
 
 static void
 bus_ibus_impl_registry_destroy (BusIBusImpl *ibus)
 {
+    bus_ibus_impl_wait_for_registry (ibus);
+
     g_list_free_full (ibus->components, g_object_unref);
     ibus->components = NULL;
 
@@ -2428,6 +2990,8 @@ bus_ibus_impl_lookup_component_by_name (BusIBusImpl *ibus,
     g_assert (BUS_IS_IBUS_IMPL (ibus));
     g_assert (name);
 
+    bus_ibus_impl_wait_for_registry (ibus);
+
     p = g_list_find_custom (ibus->components,
                             name,
                             (GCompareFunc) _component_is_name_cb);
@@ -91,6 +91,15 @@ IBusKeymap      *bus_ibus_impl_get_keymap           (BusIBusImpl        *ibus);
 BusComponent    *bus_ibus_impl_lookup_component_by_name
                                                     (BusIBusImpl        *ibus,
                                                      const gchar        *name);
+/**
+ * bus_ibus_impl_wait_for_registry:
+ * @ibus: A #BusIBusImpl.
+ *
+ * Wait for the registry which is loaded in a thread while ibus-daemon
+ * starts, and register the components in it. This function does nothing
+ * once the registry is loaded.
+ */
+void             bus_ibus_impl_wait_for_registry    (BusIBusImpl        *ibus);
 gboolean         bus_ibus_impl_is_use_sys_layout    (BusIBusImpl        *ibus);
 gboolean         bus_ibus_impl_is_embed_preedit_text
                                                     (BusIBusImpl        *ibus);
@@ -29,6 +29,7 @@
 #include "global.h"
 #include "ibusimpl.h"
 #include "marshalers.h"
+#include "stats.h"
 #include "types.h"
 
 #define MAX_SYNC_DATA 30
@@ -131,6 +132,10 @@ struct _BusInputContext {
      * and try to hide the CandidatePanel.
      */
     gboolean ignore_focus_out;
+
+    /* a timeout to apply the FocusOut of the client, which is cancelled by
+     * its FocusIn within g_focus_debounce msec. */
+    guint focus_out_id;
 };
 
 struct _BusInputContextClass {
@@ -810,11 +815,19 @@ bus_input_context_init (BusInputContext *context)
     g_object_ref_sink (lookup_table_empty);
     context->lookup_table = lookup_table_empty;
     /* other member variables will automatically be zero-cleared. */
+    bus_stats_add (BUS_STATS_INPUT_CONTEXTS, 1);
 }
 
 static void
 bus_input_context_destroy (BusInputContext *context)
 {
+    bus_stats_add (BUS_STATS_INPUT_CONTEXTS, -1);
+
+    if (context->focus_out_id != 0) {
+        g_source_remove (context->focus_out_id);
+        context->focus_out_id = 0;
+    }
+
     if (context->has_focus) {
         bus_input_context_focus_out (context);
         context->has_focus = FALSE;
@@ -855,6 +868,7 @@ bus_input_context_destroy (BusInputContext *context)
 
     g_queue_free_full (context->queue_during_process_key_event,
                        queue_process_key_event_free);
+
     IBUS_OBJECT_CLASS (bus_input_context_parent_class)->
             destroy (IBUS_OBJECT (context));
 }
@@ -1085,6 +1099,8 @@ _ic_process_key_event (BusInputContext       *context,
     if (context->use_post_process_key_event)
         context->processing_key_event = TRUE;
     g_variant_get (parameters, "(uuu)", &keyval, &keycode, &modifiers);
+    /* the key event should be processed with the latest focus. */
+    bus_input_context_flush_focus_out (context);
     if (bus_ibus_impl_process_key_event (BUS_DEFAULT_IBUS,
                                          keyval,
                                          keycode,
@@ -1173,10 +1189,27 @@ _ic_set_cursor_location (BusInputContext       *context,
                          GVariant              *parameters,
                          GDBusMethodInvocation *invocation)
 {
+    gint x, y, w, h;
+
     g_dbus_method_invocation_return_value (invocation, NULL);
 
-    g_variant_get (parameters, "(iiii)",
-                   &context->x, &context->y, &context->w, &context->h);
+    g_variant_get (parameters, "(iiii)", &x, &y, &w, &h);
+    bus_input_context_set_cursor_location (context, x, y, w, h);
+}
+
+void
+bus_input_context_set_cursor_location (BusInputContext *context,
+                                       gint             x,
+                                       gint             y,
+                                       gint             w,
+                                       gint             h)
+{
+    g_assert (BUS_IS_INPUT_CONTEXT (context));
+
+    context->x = x;
+    context->y = y;
+    context->w = w;
+    context->h = h;
 
     if (context->has_focus && context->engine) {
         bus_engine_proxy_set_cursor_location (context->engine,
@@ -1293,6 +1326,14 @@ _ic_focus_in (BusInputContext       *context,
     }
 }
 
+static gboolean
+_focus_out_timeout_cb (BusInputContext *context)
+{
+    context->focus_out_id = 0;
+    bus_input_context_focus_out (context);
+    return G_SOURCE_REMOVE;
+}
+
 /**
  * _ic_focus_out:
  *
@@ -1309,7 +1350,22 @@ _ic_focus_out (BusInputContext       *context,
             g_dbus_method_invocation_return_value (invocation, NULL);
             return;
         }
-        bus_input_context_focus_out (context);
+        /* Some clients send FocusOut and FocusIn in bursts, e.g.
+         * google-chrome with its popup windows. Wait for the next FocusIn
+         * shortly not to send the pair to the engine and the panel. A
+         * preedit text is committed or cleared at once. */
+        if (g_focus_debounce > 0 &&
+            context->has_focus &&
+            ibus_text_get_length (context->preedit_text) == 0) {
+            if (context->focus_out_id == 0) {
+                context->focus_out_id =
+                        g_timeout_add (g_focus_debounce,
+                                       (GSourceFunc) _focus_out_timeout_cb,
+                                       context);
+            }
+        } else {
+            bus_input_context_focus_out (context);
+        }
         g_dbus_method_invocation_return_value (invocation, NULL);
     }
     else {
@@ -1492,7 +1548,8 @@ _ic_get_engine (BusInputContext       *context,
 
     g_dbus_method_invocation_return_value (invocation,
             g_variant_new ("(v)",
-                           ibus_serializable_serialize (
+                           bus_connection_serialize (
+                                   context->connection,
                                    (IBusSerializable *)desc)));
 }
 
@@ -1641,7 +1698,8 @@ _ic_get_post_process_key_event (BusInputContext *context,
         g_variant_builder_init (&array, G_VARIANT_TYPE ("a(yv)"));
         while ((data =
                 g_queue_pop_head (context->queue_during_process_key_event))) {
-            GVariant *variant = ibus_serializable_serialize_object (
+            GVariant *variant = bus_connection_serialize (
+                    context->connection,
                     IBUS_SERIALIZABLE (data->text));
             g_variant_builder_add (&array, "(yv)", data->key, variant);
             g_object_unref (data->text);
@@ -1758,6 +1816,15 @@ _ic_set_client_commit_preedit (BusInputContext *context,
     return TRUE;
 }
 
+void
+bus_input_context_set_client_commit_preedit (BusInputContext *context,
+                                             gboolean         client_commit)
+{
+    g_assert (BUS_IS_INPUT_CONTEXT (context));
+
+    context->client_commit_preedit = client_commit;
+}
+
 static gboolean
 _ic_set_use_post_process_key_event (BusInputContext *context,
                                     GVariant        *value,
@@ -1909,11 +1976,26 @@ bus_input_context_has_focus (BusInputContext *context)
     return context->has_focus;
 }
 
+void
+bus_input_context_flush_focus_out (BusInputContext *context)
+{
+    g_assert (BUS_IS_INPUT_CONTEXT (context));
+
+    if (context->focus_out_id != 0)
+        bus_input_context_focus_out (context);
+}
+
 void
 bus_input_context_focus_in (BusInputContext *context)
 {
     g_assert (BUS_IS_INPUT_CONTEXT (context));
 
+    /* the context still has the focus for the engine and the panel. */
+    if (context->focus_out_id != 0) {
+        g_source_remove (context->focus_out_id);
+        context->focus_out_id = 0;
+    }
+
     if (context->has_focus)
         return;
 
@@ -2022,6 +2104,11 @@ bus_input_context_focus_out (BusInputContext *context)
 {
     g_assert (BUS_IS_INPUT_CONTEXT (context));
 
+    if (context->focus_out_id != 0) {
+        g_source_remove (context->focus_out_id);
+        context->focus_out_id = 0;
+    }
+
     if (!context->has_focus)
         return;
 
@@ -2221,7 +2308,8 @@ bus_input_context_update_auxiliary_text (BusInputContext *context,
 
     if (context->capabilities & IBUS_CAP_AUXILIARY_TEXT) {
         GVariant *variant =
-                ibus_serializable_serialize ((IBusSerializable *)text);
+                bus_connection_serialize (context->connection,
+                                          (IBusSerializable *)text);
         bus_input_context_emit_signal (context,
                                        "UpdateAuxiliaryText",
                                        g_variant_new ("(vb)", variant, visible),
@@ -2333,7 +2421,8 @@ bus_input_context_update_lookup_table (BusInputContext *context,
 
     if (context->capabilities & IBUS_CAP_LOOKUP_TABLE) {
         GVariant *variant =
-                ibus_serializable_serialize ((IBusSerializable *)table);
+                bus_connection_serialize (context->connection,
+                                          (IBusSerializable *)table);
         bus_input_context_emit_signal (context,
                                        "UpdateLookupTable",
                                        g_variant_new ("(vb)", variant, visible),
@@ -2543,7 +2632,8 @@ bus_input_context_register_properties (BusInputContext *context,
 
     if (context->capabilities & IBUS_CAP_PROPERTY) {
         GVariant *variant =
-                ibus_serializable_serialize ((IBusSerializable *)props);
+                bus_connection_serialize (context->connection,
+                                          (IBusSerializable *)props);
         bus_input_context_emit_signal (context,
                                        "RegisterProperties",
                                        g_variant_new ("(v)", variant),
@@ -2572,7 +2662,8 @@ bus_input_context_update_property (BusInputContext *context,
 
     if (context->capabilities & IBUS_CAP_PROPERTY) {
         GVariant *variant =
-                ibus_serializable_serialize ((IBusSerializable *)prop);
+                bus_connection_serialize (context->connection,
+                                          (IBusSerializable *)prop);
         bus_input_context_emit_signal (context,
                                        "UpdateProperty",
                                        g_variant_new ("(v)", variant),
@@ -3439,7 +3530,8 @@ bus_input_context_commit_text_use_extension (BusInputContext *context,
                                                               &pre_data)) {
         return;
     } else {
-        GVariant *variant = ibus_serializable_serialize (
+        GVariant *variant = bus_connection_serialize (
+                context->connection,
                 (IBusSerializable *)text);
         bus_input_context_emit_signal (context,
                                        "CommitText",
@@ -3504,7 +3596,8 @@ bus_input_context_update_preedit_text (BusInputContext *context,
             real_preedit_text  = g_object_ref (context->preedit_text);
         }
         pre_data.text = real_preedit_text;
-        variant = ibus_serializable_serialize (
+        variant = bus_connection_serialize (
+                    context->connection,
                     (IBusSerializable *)real_preedit_text);
         pre_data.u.uints[0] = context->preedit_cursor_pos;
         pre_data.u.uints[1] = extension_visible ? 1 : 0;
@@ -88,6 +88,16 @@ void                 bus_input_context_focus_in (BusInputContext    *context);
 void                 bus_input_context_focus_out
                                                 (BusInputContext    *context);
 
+/**
+ * bus_input_context_flush_focus_out:
+ * @context: A #BusInputContext.
+ *
+ * Apply the FocusOut method call of the client which is delayed for
+ * g_focus_debounce msec, if any.
+ */
+void                 bus_input_context_flush_focus_out
+                                                (BusInputContext    *context);
+
 /**
  * bus_input_context_has_focus:
  * @context: A #BusInputContext.
@@ -297,6 +307,34 @@ void                 bus_input_context_set_content_type
                                                  guint            purpose,
                                                  guint            hints);
 
+/**
+ * bus_input_context_set_cursor_location:
+ * @context: A #BusInputContext.
+ * @x: X coordinate of the cursor.
+ * @y: Y coordinate of the cursor.
+ * @w: Width of the cursor.
+ * @h: Height of the cursor.
+ *
+ * Set the cursor location as the "SetCursorLocation" method call does.
+ */
+void                 bus_input_context_set_cursor_location
+                                                (BusInputContext *context,
+                                                 gint             x,
+                                                 gint             y,
+                                                 gint             w,
+                                                 gint             h);
+
+/**
+ * bus_input_context_set_client_commit_preedit:
+ * @context: A #BusInputContext.
+ * @client_commit: %TRUE if the client commits the preedit text on reset.
+ *
+ * Set the "ClientCommitPreedit" property.
+ */
+void                 bus_input_context_set_client_commit_preedit
+                                                (BusInputContext *context,
+                                                 gboolean         client_commit);
+
 /**
  * bus_input_context_commit_text:
  * @context: A #BusInputContext.
@@ -44,6 +44,7 @@
 #include "global.h"
 #include "ibusimpl.h"
 #include "server.h"
+#include "startup.h"
 
 static gboolean daemonize = FALSE;
 static gboolean single = FALSE;
@@ -84,8 +85,16 @@ static const GOptionEntry entries[] =
     { "replace",   'r', 0, G_OPTION_ARG_NONE,   &replace,   "if there is an old ibus-daemon is running, it will be replaced.", NULL },
     { "cache",     't', 0, G_OPTION_ARG_STRING, &g_cache,   "specify the cache mode. [auto/refresh/none]", NULL },
     { "timeout",   'o', 0, G_OPTION_ARG_INT,    &g_gdbus_timeout, "gdbus reply timeout in milliseconds. pass -1 to use the default timeout of gdbus.", "timeout [default is 15000]" },
+    { "forward-rate-limit", 0, 0, G_OPTION_ARG_INT, &g_forward_rate_limit, "maximum number of method calls per second forwarded from a connection. pass 0 not to limit the rate.", "limit [default is 0]" },
+    { "forward-queue-limit", 0, 0, G_OPTION_ARG_INT, &g_forward_queue_limit, "maximum number of pending messages forwarded from a connection before its method calls are rejected. pass 0 not to limit the queue.", "limit [default is 1000]" },
+    { "preload-delay", 0, 0, G_OPTION_ARG_INT, &g_preload_delay, "milliseconds to wait before starting the preload engines in the background.", "delay [default is 3000]" },
+    { "preload-concurrency", 0, 0, G_OPTION_ARG_INT, &g_preload_concurrency, "maximum number of preload engines starting at a time. pass 0 not to limit them.", "limit [default is 1]" },
+    { "preload-min-memory", 0, 0, G_OPTION_ARG_INT, &g_preload_min_memory, "minimum available memory in MiB to start preload engines. pass 0 not to check the memory.", "size [default is 256]" },
+    { "engine-idle-timeout", 0, 0, G_OPTION_ARG_INT, &g_engine_idle_timeout, "seconds to keep an engine process which has no engines. pass 0 not to stop engine processes.", "seconds [default is 0]" },
+    { "focus-debounce", 0, 0, G_OPTION_ARG_INT, &g_focus_debounce, "milliseconds to wait for a focus-in after an input context loses focus before the engine and the panel get the focus-out. pass 0 to apply the focus-out immediately.", "msec [default is 0]" },
     { "mem-profile", 'm', 0, G_OPTION_ARG_NONE,   &g_mempro,   "enable memory profile, send SIGUSR2 to print out the memory profile.", NULL },
     { "restart",     'R', 0, G_OPTION_ARG_NONE,   &restart,    "restart panel and config processes when they die.", NULL },
+    { "startup-profile", 0, 0, G_OPTION_ARG_NONE, &g_startup_profile, "print the time of each startup stage to stderr.", NULL },
     { "verbose",   'v', 0, G_OPTION_ARG_NONE,   &g_verbose,   "verbose.", NULL },
     { NULL },
 };
@@ -193,6 +202,7 @@ gint
 main (gint argc, gchar **argv)
 {
     int i;
+    gint64 begin;
     const gchar *username = ibus_get_user_name ();
     const gchar *groupname = ibus_get_group_name ();
 
@@ -213,6 +223,33 @@ main (gint argc, gchar **argv)
         exit_and_free_context (EXIT_FAILURE, context);
     }
 
+    if (g_preload_delay < 0) {
+        g_printerr ("Bad preload-delay (must be >= 0): %d\n", g_preload_delay);
+        exit_and_free_context (EXIT_FAILURE, context);
+    }
+    if (g_preload_concurrency < 0) {
+        g_printerr ("Bad preload-concurrency (must be >= 0): %d\n",
+                    g_preload_concurrency);
+        exit_and_free_context (EXIT_FAILURE, context);
+    }
+    if (g_preload_min_memory < 0) {
+        g_printerr ("Bad preload-min-memory (must be >= 0): %d\n",
+                    g_preload_min_memory);
+        exit_and_free_context (EXIT_FAILURE, context);
+    }
+    if (g_engine_idle_timeout < 0) {
+        g_printerr ("Bad engine-idle-timeout (must be >= 0): %d\n",
+                    g_engine_idle_timeout);
+        exit_and_free_context (EXIT_FAILURE, context);
+    }
+    if (g_focus_debounce < 0) {
+        g_printerr ("Bad focus-debounce (must be >= 0): %d\n",
+                    g_focus_debounce);
+        exit_and_free_context (EXIT_FAILURE, context);
+    }
+
+    bus_startup_init ();
+
     if (g_mempro) {
         g_warning ("--mem-profile no longer works with the GLib 2.46 or later");
     }
@@ -266,7 +303,9 @@ main (gint argc, gchar **argv)
         g_object_unref (bus);
     }
 
+    begin = bus_startup_stage_begin ();
     bus_server_init ();
+    bus_startup_stage_end ("server-init", begin);
     for (i = 0; i < G_N_ELEMENTS (panel_extension_disable_users); i++) {
         if (!g_strcmp0 (username, panel_extension_disable_users[i]) != 0) {
             emoji_extension = "disable";
@@ -279,6 +318,47 @@ main (gint argc, gchar **argv)
             break;
         }
     }
+    /* execute the components which are given by the command lines first
+     * since they do not need the registry which is still being loaded. */
+    begin = bus_startup_stage_begin ();
+    if (!single) {
+        /* execute config program */
+        if (g_strcmp0 (config, "default") != 0 &&
+            g_strcmp0 (config, "disable") != 0 &&
+            g_strcmp0 (config, "") != 0) {
+            if (!execute_cmdline (config))
+                exit_and_free_context (EXIT_FAILURE, context);
+        }
+
+        /* execute panel program */
+        if (g_strcmp0 (panel, "default") != 0 &&
+            g_strcmp0 (panel, "disable") != 0 &&
+            g_strcmp0 (panel, "") != 0) {
+            if (!execute_cmdline (panel))
+                exit_and_free_context (EXIT_FAILURE, context);
+        }
+    }
+
+#ifdef EMOJI_DICT
+    if (g_strcmp0 (emoji_extension, "default") != 0 &&
+        g_strcmp0 (emoji_extension, "disable") != 0 &&
+        g_strcmp0 (emoji_extension, "") != 0) {
+        if (!execute_cmdline (emoji_extension))
+            exit_and_free_context (EXIT_FAILURE, context);
+    }
+#endif
+
+    /* execute ibus xim server */
+    if (xim) {
+        if (!execute_cmdline (LIBEXECDIR "/ibus-x11 --kill-daemon"))
+            exit_and_free_context (EXIT_FAILURE, context);
+    }
+    bus_startup_stage_end ("launch-cmdlines", begin);
+
+    bus_ibus_impl_wait_for_registry (BUS_DEFAULT_IBUS);
+
+    /* execute the default components in the registry */
+    begin = bus_startup_stage_begin ();
     if (!single) {
         /* execute config component */
         if (g_strcmp0 (config, "default") == 0) {
@@ -293,10 +373,6 @@ main (gint argc, gchar **argv)
                 g_printerr ("Can not execute default config program\n");
                 exit_and_free_context (EXIT_FAILURE, context);
             }
-        } else if (g_strcmp0 (config, "disable") != 0 &&
-                   g_strcmp0 (config, "") != 0) {
-            if (!execute_cmdline (config))
-                exit_and_free_context (EXIT_FAILURE, context);
         }
 
         /* execute panel component */
@@ -312,10 +388,6 @@ main (gint argc, gchar **argv)
                 g_printerr ("Can not execute default panel program\n");
                 exit_and_free_context (EXIT_FAILURE, context);
             }
-        } else if (g_strcmp0 (panel, "disable") != 0 &&
-                   g_strcmp0 (panel, "") != 0) {
-            if (!execute_cmdline (panel))
-                exit_and_free_context (EXIT_FAILURE, context);
         }
     }
 
@@ -332,18 +404,9 @@ main (gint argc, gchar **argv)
             g_printerr ("Can not execute default panel program\n");
             exit_and_free_context (EXIT_FAILURE, context);
         }
-    } else if (g_strcmp0 (emoji_extension, "disable") != 0 &&
-               g_strcmp0 (emoji_extension, "") != 0) {
-        if (!execute_cmdline (emoji_extension))
-            exit_and_free_context (EXIT_FAILURE, context);
     }
 #endif
-
-    /* execute ibus xim server */
-    if (xim) {
-        if (!execute_cmdline (LIBEXECDIR "/ibus-x11 --kill-daemon"))
-            exit_and_free_context (EXIT_FAILURE, context);
-    }
+    bus_startup_stage_end ("launch-components", begin);
 
     if (!daemonize) {
         if (getppid () == 1) {
@@ -388,6 +451,7 @@ main (gint argc, gchar **argv)
 #endif
 #endif
     }
+    bus_startup_report ();
     bus_server_run ();
     g_option_context_free (context);
     return 0;
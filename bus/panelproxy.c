@@ -24,6 +24,7 @@
 
 #include "global.h"
 #include "marshalers.h"
+#include "stats.h"
 #include "types.h"
 
 /* panelproxy.c is a very simple proxy class for the panel component that does only the following:
@@ -39,8 +40,33 @@
  *    fall into this category.
  * 4. Handle glib signals for a BusInputContext object. The list of such glib signals is in the input_context_signals[] array. The signal handler
  *    function, e.g. _context_set_cursor_location_cb, simply invokes a D-Bus method by calling a function like bus_panel_proxy_set_cursor_location.
+ *
+ * The Update* methods are not called when the parameters are same as the last ones sent for the focused context, and the RegisterProperties
+ * and UpdateProperty methods are coalesced for PROPERTY_COALESCE_TIMEOUT milli seconds except for the first RegisterProperties after a focus-in
+ * or an engine change, which is sent immediately.
  */
 
+/* the window to coalesce RegisterProperties and UpdateProperty in milli
+ * seconds. */
+#define PROPERTY_COALESCE_TIMEOUT 20
+
+typedef enum {
+    PANEL_UPDATE_PREEDIT_TEXT = 0,
+    PANEL_UPDATE_AUXILIARY_TEXT,
+    PANEL_UPDATE_LOOKUP_TABLE,
+    PANEL_UPDATE_PROPERTIES,
+    PANEL_UPDATE_LAST,
+    /* for the methods which do not change the state of the updates. */
+    PANEL_UPDATE_NONE = PANEL_UPDATE_LAST,
+} PanelUpdate;
+
+typedef struct _PanelUpdateState PanelUpdateState;
+struct _PanelUpdateState {
+    /* the fingerprint of params to compare them quickly. */
+    guint     fingerprint;
+    GVariant *params;
+};
+
 enum {
     PAGE_UP,
     PAGE_DOWN,
@@ -67,6 +93,19 @@ struct _BusPanelProxy {
     /* instance members */
     BusInputContext *focused_context;
     PanelType panel_type;
+
+    /* the last parameters of the Update* methods sent to the panel. */
+    PanelUpdateState updates[PANEL_UPDATE_LAST];
+    /* a map from a property key to the last parameters of UpdateProperty. */
+    GHashTable *sent_props;
+
+    /* RegisterProperties and UpdateProperty waiting for props_timeout_id. */
+    GVariant *pending_prop_list;
+    GHashTable *pending_props;
+    guint props_timeout_id;
+    /* TRUE if the next RegisterProperties is sent without the delay, i.e.
+     * after a focus-in or an engine change. */
+    gboolean props_immediate;
 };
 
 struct _BusPanelProxyClass {
@@ -393,6 +432,163 @@ static void
 bus_panel_proxy_init (BusPanelProxy *panel)
 {
     /* member variables will automatically be zero-cleared. */
+    panel->sent_props = g_hash_table_new_full (
+            g_str_hash, g_str_equal,
+            g_free, (GDestroyNotify) g_variant_unref);
+    panel->pending_props = g_hash_table_new_full (
+            g_str_hash, g_str_equal,
+            g_free, (GDestroyNotify) g_variant_unref);
+}
+
+static guint
+_variant_fingerprint (GVariant *variant)
+{
+    const guchar *data = g_variant_get_data (variant);
+    gsize size = g_variant_get_size (variant);
+    guint32 hash = 2166136261U;
+    gsize i;
+
+    /* FNV-1a */
+    for (i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static void
+bus_panel_proxy_reset_update (BusPanelProxy *panel,
+                              PanelUpdate    update)
+{
+    if (update == PANEL_UPDATE_NONE)
+        return;
+    g_clear_pointer (&panel->updates[update].params, g_variant_unref);
+    if (update == PANEL_UPDATE_PROPERTIES && panel->sent_props != NULL)
+        g_hash_table_remove_all (panel->sent_props);
+}
+
+static void
+bus_panel_proxy_reset_updates (BusPanelProxy *panel)
+{
+    gint i;
+
+    for (i = 0; i < PANEL_UPDATE_LAST; i++)
+        bus_panel_proxy_reset_update (panel, i);
+}
+
+/**
+ * bus_panel_proxy_serialize:
+ *
+ * Serialize @object in the wire version negotiated by the panel.
+ */
+static GVariant *
+bus_panel_proxy_serialize (BusPanelProxy    *panel,
+                           IBusSerializable *object)
+{
+    GDBusConnection *connection =
+            g_dbus_proxy_get_connection ((GDBusProxy *)panel);
+
+    return bus_connection_serialize (bus_connection_lookup (connection),
+                                     object);
+}
+
+/**
+ * bus_panel_proxy_call_update:
+ * @params: (transfer floating): The parameters of @method_name.
+ *
+ * Call @method_name unless @params is same as the last one of @update.
+ */
+static void
+bus_panel_proxy_call_update (BusPanelProxy *panel,
+                             PanelUpdate    update,
+                             const gchar   *method_name,
+                             GVariant      *params)
+{
+    PanelUpdateState *state = &panel->updates[update];
+    guint fingerprint;
+
+    g_variant_ref_sink (params);
+    fingerprint = _variant_fingerprint (params);
+    if (state->params != NULL &&
+        state->fingerprint == fingerprint &&
+        g_variant_equal (state->params, params)) {
+        bus_stats_add (BUS_STATS_PANEL_UPDATES_SKIPPED, 1);
+        g_variant_unref (params);
+        return;
+    }
+    if (state->params != NULL)
+        g_variant_unref (state->params);
+    state->params = g_variant_ref (params);
+    state->fingerprint = fingerprint;
+
+    g_dbus_proxy_call ((GDBusProxy *)panel,
+                       method_name,
+                       params,
+                       G_DBUS_CALL_FLAGS_NONE,
+                       -1, NULL, NULL, NULL);
+    g_variant_unref (params);
+}
+
+static void
+bus_panel_proxy_flush_properties (BusPanelProxy *panel)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+
+    if (panel->props_timeout_id != 0) {
+        g_source_remove (panel->props_timeout_id);
+        panel->props_timeout_id = 0;
+    }
+
+    if (panel->pending_prop_list != NULL) {
+        GVariant *params = panel->pending_prop_list;
+        panel->pending_prop_list = NULL;
+        /* The property list overrides the sent properties. */
+        g_hash_table_remove_all (panel->sent_props);
+        bus_panel_proxy_call_update (panel,
+                                     PANEL_UPDATE_PROPERTIES,
+                                     "RegisterProperties",
+                                     params);
+        g_variant_unref (params);
+    }
+
+    g_hash_table_iter_init (&iter, panel->pending_props);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        GVariant *params = (GVariant *)value;
+        GVariant *sent = g_hash_table_lookup (panel->sent_props, key);
+        if (sent != NULL && g_variant_equal (sent, params)) {
+            bus_stats_add (BUS_STATS_PANEL_UPDATES_SKIPPED, 1);
+        } else {
+            g_hash_table_replace (panel->sent_props,
+                                  g_strdup (key),
+                                  g_variant_ref (params));
+            g_dbus_proxy_call ((GDBusProxy *)panel,
+                               "UpdateProperty",
+                               params,
+                               G_DBUS_CALL_FLAGS_NONE,
+                               -1, NULL, NULL, NULL);
+        }
+        g_hash_table_iter_remove (&iter);
+    }
+}
+
+static gboolean
+_props_timeout_cb (BusPanelProxy *panel)
+{
+    panel->props_timeout_id = 0;
+    bus_panel_proxy_flush_properties (panel);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+bus_panel_proxy_schedule_properties (BusPanelProxy *panel)
+{
+    if (panel->props_timeout_id != 0)
+        return;
+    panel->props_timeout_id =
+            g_timeout_add (PROPERTY_COALESCE_TIMEOUT,
+                           (GSourceFunc) _props_timeout_cb,
+                           panel);
 }
 
 static void
@@ -405,6 +601,15 @@ bus_panel_proxy_real_destroy (IBusProxy *proxy)
         panel->focused_context = NULL;
     }
 
+    if (panel->props_timeout_id != 0) {
+        g_source_remove (panel->props_timeout_id);
+        panel->props_timeout_id = 0;
+    }
+    bus_panel_proxy_reset_updates (panel);
+    g_clear_pointer (&panel->pending_prop_list, g_variant_unref);
+    g_clear_pointer (&panel->pending_props, g_hash_table_destroy);
+    g_clear_pointer (&panel->sent_props, g_hash_table_destroy);
+
     IBUS_PROXY_CLASS(bus_panel_proxy_parent_class)->
             destroy ((IBusProxy *)panel);
 }
@@ -614,12 +819,13 @@ bus_panel_proxy_update_preedit_text (BusPanelProxy  *panel,
     g_assert (BUS_IS_PANEL_PROXY (panel));
     g_assert (IBUS_IS_TEXT (text));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable* )text);
-    g_dbus_proxy_call ((GDBusProxy *)panel,
-                       "UpdatePreeditText",
-                       g_variant_new ("(vub)", variant, cursor_pos, visible),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1, NULL, NULL, NULL);
+    GVariant *variant = bus_panel_proxy_serialize (
+            panel, (IBusSerializable *)text);
+    bus_panel_proxy_call_update (panel,
+                                 PANEL_UPDATE_PREEDIT_TEXT,
+                                 "UpdatePreeditText",
+                                 g_variant_new ("(vub)",
+                                                variant, cursor_pos, visible));
 }
 
 void
@@ -630,12 +836,12 @@ bus_panel_proxy_update_auxiliary_text (BusPanelProxy *panel,
     g_assert (BUS_IS_PANEL_PROXY (panel));
     g_assert (IBUS_IS_TEXT (text));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable* )text);
-    g_dbus_proxy_call ((GDBusProxy *)panel,
-                       "UpdateAuxiliaryText",
-                       g_variant_new ("(vb)", variant, visible),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1, NULL, NULL, NULL);
+    GVariant *variant = bus_panel_proxy_serialize (
+            panel, (IBusSerializable *)text);
+    bus_panel_proxy_call_update (panel,
+                                 PANEL_UPDATE_AUXILIARY_TEXT,
+                                 "UpdateAuxiliaryText",
+                                 g_variant_new ("(vb)", variant, visible));
 }
 
 void
@@ -646,12 +852,12 @@ bus_panel_proxy_update_lookup_table (BusPanelProxy   *panel,
     g_assert (BUS_IS_PANEL_PROXY (panel));
     g_assert (IBUS_IS_LOOKUP_TABLE (table));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable* )table);
-    g_dbus_proxy_call ((GDBusProxy *)panel,
-                       "UpdateLookupTable",
-                       g_variant_new ("(vb)", variant, visible),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1, NULL, NULL, NULL);
+    GVariant *variant = bus_panel_proxy_serialize (
+            panel, (IBusSerializable *)table);
+    bus_panel_proxy_call_update (panel,
+                                 PANEL_UPDATE_LOOKUP_TABLE,
+                                 "UpdateLookupTable",
+                                 g_variant_new ("(vb)", variant, visible));
 }
 
 void
@@ -661,12 +867,30 @@ bus_panel_proxy_register_properties (BusPanelProxy  *panel,
     g_assert (BUS_IS_PANEL_PROXY (panel));
     g_assert (IBUS_IS_PROP_LIST (prop_list));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable *)prop_list);
-    g_dbus_proxy_call ((GDBusProxy *)panel,
-                       "RegisterProperties",
-                       g_variant_new ("(v)", variant),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1, NULL, NULL, NULL);
+    /* destroyed */
+    if (panel->pending_props == NULL)
+        return;
+
+    GVariant *variant = bus_panel_proxy_serialize (
+            panel, (IBusSerializable *)prop_list);
+    /* The property list replaces the pending updates of the properties. */
+    if (panel->pending_prop_list != NULL) {
+        g_variant_unref (panel->pending_prop_list);
+        bus_stats_add (BUS_STATS_PANEL_UPDATES_SKIPPED, 1);
+    }
+    bus_stats_add (BUS_STATS_PANEL_UPDATES_SKIPPED,
+                   g_hash_table_size (panel->pending_props));
+    g_hash_table_remove_all (panel->pending_props);
+    panel->pending_prop_list =
+            g_variant_ref_sink (g_variant_new ("(v)", variant));
+    if (panel->props_immediate) {
+        /* the panel should not show the properties of the previous
+         * context or engine. */
+        panel->props_immediate = FALSE;
+        bus_panel_proxy_flush_properties (panel);
+    } else {
+        bus_panel_proxy_schedule_properties (panel);
+    }
 }
 
 void
@@ -676,12 +900,19 @@ bus_panel_proxy_update_property (BusPanelProxy  *panel,
     g_assert (BUS_IS_PANEL_PROXY (panel));
     g_assert (IBUS_IS_PROPERTY (prop));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable *)prop);
-    g_dbus_proxy_call ((GDBusProxy *)panel,
-                       "UpdateProperty",
-                       g_variant_new ("(v)", variant),
-                       G_DBUS_CALL_FLAGS_NONE,
-                       -1, NULL, NULL, NULL);
+    /* destroyed */
+    if (panel->pending_props == NULL)
+        return;
+
+    GVariant *variant = bus_panel_proxy_serialize (
+            panel, (IBusSerializable *)prop);
+    const gchar *key = ibus_property_get_key (prop);
+    if (g_hash_table_contains (panel->pending_props, key))
+        bus_stats_add (BUS_STATS_PANEL_UPDATES_SKIPPED, 1);
+    g_hash_table_replace (panel->pending_props,
+                          g_strdup (key),
+                          g_variant_ref_sink (g_variant_new ("(v)", variant)));
+    bus_panel_proxy_schedule_properties (panel);
 }
 
 void
@@ -760,10 +991,13 @@ bus_panel_proxy_commit_text (BusPanelProxy *panel,
                                                  use_extension);
 }
 
-#define DEFINE_FUNCTION(Name, name)                     \
+/* The methods change the state in the panel so the next update of
+ * the state is always sent. */
+#define DEFINE_FUNCTION(Name, name, update)             \
     void bus_panel_proxy_##name (BusPanelProxy *panel)  \
     {                                                   \
         g_assert (BUS_IS_PANEL_PROXY (panel));          \
+        bus_panel_proxy_reset_update (panel, update);   \
         g_dbus_proxy_call ((GDBusProxy *) panel,        \
                            #Name,                       \
                            NULL,                        \
@@ -771,17 +1005,27 @@ bus_panel_proxy_commit_text (BusPanelProxy *panel,
                            -1, NULL, NULL, NULL);       \
     }
 
-DEFINE_FUNCTION (ShowPreeditText, show_preedit_text)
-DEFINE_FUNCTION (HidePreeditText, hide_preedit_text)
-DEFINE_FUNCTION (ShowAuxiliaryText, show_auxiliary_text)
-DEFINE_FUNCTION (HideAuxiliaryText, hide_auxiliary_text)
-DEFINE_FUNCTION (ShowLookupTable, show_lookup_table)
-DEFINE_FUNCTION (HideLookupTable, hide_lookup_table)
-DEFINE_FUNCTION (PageUpLookupTable, page_up_lookup_table)
-DEFINE_FUNCTION (PageDownLookupTable, page_down_lookup_table)
-DEFINE_FUNCTION (CursorUpLookupTable, cursor_up_lookup_table)
-DEFINE_FUNCTION (CursorDownLookupTable, cursor_down_lookup_table)
-DEFINE_FUNCTION (StateChanged, state_changed)
+DEFINE_FUNCTION (ShowPreeditText, show_preedit_text,
+                 PANEL_UPDATE_PREEDIT_TEXT)
+DEFINE_FUNCTION (HidePreeditText, hide_preedit_text,
+                 PANEL_UPDATE_PREEDIT_TEXT)
+DEFINE_FUNCTION (ShowAuxiliaryText, show_auxiliary_text,
+                 PANEL_UPDATE_AUXILIARY_TEXT)
+DEFINE_FUNCTION (HideAuxiliaryText, hide_auxiliary_text,
+                 PANEL_UPDATE_AUXILIARY_TEXT)
+DEFINE_FUNCTION (ShowLookupTable, show_lookup_table,
+                 PANEL_UPDATE_LOOKUP_TABLE)
+DEFINE_FUNCTION (HideLookupTable, hide_lookup_table,
+                 PANEL_UPDATE_LOOKUP_TABLE)
+DEFINE_FUNCTION (PageUpLookupTable, page_up_lookup_table,
+                 PANEL_UPDATE_LOOKUP_TABLE)
+DEFINE_FUNCTION (PageDownLookupTable, page_down_lookup_table,
+                 PANEL_UPDATE_LOOKUP_TABLE)
+DEFINE_FUNCTION (CursorUpLookupTable, cursor_up_lookup_table,
+                 PANEL_UPDATE_LOOKUP_TABLE)
+DEFINE_FUNCTION (CursorDownLookupTable, cursor_down_lookup_table,
+                 PANEL_UPDATE_LOOKUP_TABLE)
+DEFINE_FUNCTION (StateChanged, state_changed, PANEL_UPDATE_NONE)
 
 #undef DEFINE_FUNCTION
 
@@ -886,6 +1130,20 @@ _context_update_lookup_table_cb (BusInputContext *context,
                                          visible);
 }
 
+static void
+_context_engine_changed_cb (BusInputContext *context,
+                            BusPanelProxy   *panel)
+{
+    g_assert (BUS_IS_INPUT_CONTEXT (context));
+    g_assert (BUS_IS_PANEL_PROXY (panel));
+
+    g_return_if_fail (panel->focused_context == context);
+
+    /* The pending properties could belong to the previous engine. */
+    bus_panel_proxy_flush_properties (panel);
+    panel->props_immediate = TRUE;
+}
+
 static void
 _context_register_properties_cb (BusInputContext *context,
                                  IBusPropList    *prop_list,
@@ -1017,6 +1275,7 @@ static const struct {
     { "update-property",            G_CALLBACK (_context_update_property_cb) },
 
     { "engine-changed",             G_CALLBACK (_context_state_changed_cb) },
+    { "engine-changed",             G_CALLBACK (_context_engine_changed_cb) },
 
     { "destroy",                    G_CALLBACK (_context_destroy_cb) },
 
@@ -1042,6 +1301,8 @@ bus_panel_proxy_focus_in (BusPanelProxy     *panel,
 
     g_object_ref_sink (context);
     panel->focused_context = context;
+    bus_panel_proxy_reset_updates (panel);
+    panel->props_immediate = TRUE;
 
     path = ibus_service_get_object_path ((IBusService *)context);
 
@@ -1080,6 +1341,10 @@ bus_panel_proxy_focus_out (BusPanelProxy    *panel,
                                               panel);
     }
 
+    /* The pending properties belong to the context. */
+    bus_panel_proxy_flush_properties (panel);
+    bus_panel_proxy_reset_updates (panel);
+
     const gchar *path = ibus_service_get_object_path ((IBusService *)context);
 
     g_dbus_proxy_call ((GDBusProxy *)panel,
@@ -1129,7 +1394,7 @@ bus_panel_proxy_panel_extension_received (BusPanelProxy      *panel,
     g_assert (BUS_IS_PANEL_PROXY (panel));
     g_assert (event);
 
-    data = ibus_serializable_serialize (IBUS_SERIALIZABLE (event));
+    data = bus_panel_proxy_serialize (panel, IBUS_SERIALIZABLE (event));
     g_return_if_fail (data);
     g_dbus_proxy_call ((GDBusProxy *)panel,
                        "PanelExtensionReceived",
@@ -1167,7 +1432,7 @@ bus_panel_proxy_commit_text_received (BusPanelProxy *panel,
     g_assert (BUS_IS_PANEL_PROXY (panel));
     g_assert (IBUS_IS_TEXT (text));
 
-    variant = ibus_serializable_serialize (IBUS_SERIALIZABLE (text));
+    variant = bus_panel_proxy_serialize (panel, IBUS_SERIALIZABLE (text));
     g_dbus_proxy_call ((GDBusProxy *)panel,
                        "CommitTextReceived",
                        g_variant_new ("(v)", variant),
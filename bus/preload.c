@@ -0,0 +1,227 @@
+/* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/* vim:set et sts=4: */
+/* ibus - The Input Bus
+ * Copyright (C) 2026 IBus contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include "preload.h"
+
+#include <stdio.h>
+
+#include "global.h"
+
+typedef struct _BusPreloadStarting BusPreloadStarting;
+struct _BusPreloadStarting {
+    BusComponent *component;
+    gulong notify_id;
+    guint timeout_id;
+};
+
+/* a queue of BusComponent waiting for the warm-up. */
+static GQueue pending = G_QUEUE_INIT;
+/* an array of BusPreloadStarting whose factories are not registered yet. */
+static GPtrArray *starting = NULL;
+static guint delay_id = 0;
+static guint idle_id = 0;
+
+static void      bus_preload_schedule           (void);
+
+/**
+ * bus_preload_get_available_memory:
+ *
+ * Returns: The available memory of the system in KiB, or -1 if unknown.
+ */
+static gint64
+bus_preload_get_available_memory (void)
+{
+    FILE *fp;
+    gchar line[128];
+    gint64 value = -1;
+
+    fp = fopen ("/proc/meminfo", "r");
+    if (fp == NULL)
+        return -1;
+    while (fgets (line, sizeof (line), fp) != NULL) {
+        if (g_str_has_prefix (line, "MemAvailable:")) {
+            value = g_ascii_strtoll (line + sizeof ("MemAvailable:") - 1,
+                                     NULL, 10);
+            break;
+        }
+    }
+    fclose (fp);
+    return value;
+}
+
+static void
+bus_preload_clear_pending (void)
+{
+    g_queue_foreach (&pending, (GFunc) g_object_unref, NULL);
+    g_queue_clear (&pending);
+}
+
+static void
+bus_preload_starting_free (BusPreloadStarting *entry)
+{
+    g_signal_handler_disconnect (entry->component, entry->notify_id);
+    if (entry->timeout_id != 0)
+        g_source_remove (entry->timeout_id);
+    g_object_unref (entry->component);
+    g_slice_free (BusPreloadStarting, entry);
+}
+
+static void
+bus_preload_starting_done (BusPreloadStarting *entry)
+{
+    g_ptr_array_remove_fast (starting, entry);
+    bus_preload_starting_free (entry);
+    bus_preload_schedule ();
+}
+
+static void
+bus_preload_factory_cb (BusComponent       *component,
+                        GParamSpec         *pspec,
+                        BusPreloadStarting *entry)
+{
+    if (bus_component_get_factory (component) != NULL)
+        bus_preload_starting_done (entry);
+}
+
+static gboolean
+bus_preload_timeout_cb (BusPreloadStarting *entry)
+{
+    /* the component is too slow or failed to register the factory. */
+    entry->timeout_id = 0;
+    bus_preload_starting_done (entry);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+bus_preload_idle_cb (gpointer user_data)
+{
+    BusComponent *component;
+
+    idle_id = 0;
+
+    while (!g_queue_is_empty (&pending) &&
+           (g_preload_concurrency == 0 ||
+            starting->len < (guint) g_preload_concurrency)) {
+        if (g_preload_min_memory > 0) {
+            gint64 available = bus_preload_get_available_memory ();
+            if (available >= 0 && available < g_preload_min_memory * 1024) {
+                if (g_verbose) {
+                    g_message ("Stop preloading engines: only %"
+                               G_GINT64_FORMAT " KiB memory is available",
+                               available);
+                }
+                bus_preload_clear_pending ();
+                break;
+            }
+        }
+
+        component = (BusComponent *) g_queue_pop_head (&pending);
+        if (bus_component_get_factory (component) != NULL ||
+            bus_component_is_running (component) ||
+            !bus_component_start (component, g_verbose)) {
+            g_object_unref (component);
+            continue;
+        }
+
+        BusPreloadStarting *entry = g_slice_new (BusPreloadStarting);
+        entry->component = component;
+        entry->notify_id =
+                g_signal_connect (component, "notify::factory",
+                                  G_CALLBACK (bus_preload_factory_cb),
+                                  entry);
+        entry->timeout_id =
+                g_timeout_add (g_gdbus_timeout > 0 ? g_gdbus_timeout : 15000,
+                               (GSourceFunc) bus_preload_timeout_cb,
+                               entry);
+        g_ptr_array_add (starting, entry);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Start the next components when the main loop has nothing else to do. */
+static void
+bus_preload_schedule (void)
+{
+    if (idle_id != 0 || delay_id != 0 || g_queue_is_empty (&pending))
+        return;
+    idle_id = g_idle_add_full (G_PRIORITY_LOW, bus_preload_idle_cb,
+                               NULL, NULL);
+}
+
+static gboolean
+bus_preload_delay_cb (gpointer user_data)
+{
+    delay_id = 0;
+    bus_preload_schedule ();
+    return G_SOURCE_REMOVE;
+}
+
+void
+bus_preload_start (GPtrArray *components)
+{
+    guint i;
+
+    if (starting == NULL)
+        starting = g_ptr_array_new ();
+
+    bus_preload_clear_pending ();
+    for (i = 0; i < components->len; i++) {
+        BusComponent *component = g_ptr_array_index (components, i);
+        if (bus_component_get_factory (component) != NULL ||
+            bus_component_is_running (component)) {
+            continue;
+        }
+        g_queue_push_tail (&pending, g_object_ref (component));
+    }
+
+    if (g_queue_is_empty (&pending))
+        return;
+
+    /* restart the delay, so the warm-up does not compete with the
+     * activity which changed the preload engines. */
+    if (delay_id != 0)
+        g_source_remove (delay_id);
+    delay_id = g_timeout_add_full (G_PRIORITY_LOW,
+                                   MAX (g_preload_delay, 0),
+                                   bus_preload_delay_cb,
+                                   NULL, NULL);
+}
+
+void
+bus_preload_stop (void)
+{
+    if (delay_id != 0) {
+        g_source_remove (delay_id);
+        delay_id = 0;
+    }
+    if (idle_id != 0) {
+        g_source_remove (idle_id);
+        idle_id = 0;
+    }
+    bus_preload_clear_pending ();
+    if (starting != NULL) {
+        g_ptr_array_foreach (starting,
+                             (GFunc) bus_preload_starting_free,
+                             NULL);
+        g_ptr_array_set_size (starting, 0);
+    }
+}
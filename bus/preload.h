@@ -0,0 +1,50 @@
+/* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/* vim:set et sts=4: */
+/* ibus - The Input Bus
+ * Copyright (C) 2026 IBus contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+#ifndef __BUS_PRELOAD_H_
+#define __BUS_PRELOAD_H_
+
+#include <glib.h>
+#include "component.h"
+
+G_BEGIN_DECLS
+
+/**
+ * bus_preload_start:
+ * @components: An array of #BusComponent.
+ *
+ * Replace the warm-up queue with the components in @components which are
+ * not running yet. The components are started g_preload_delay milliseconds
+ * later in the lowest priority idle callbacks of the main loop. At most
+ * g_preload_concurrency components are starting at a time, and the
+ * warm-up stops when the available memory of the system is less than
+ * g_preload_min_memory MiB.
+ */
+void             bus_preload_start              (GPtrArray          *components);
+
+/**
+ * bus_preload_stop:
+ *
+ * Cancel the warm-up. The components already started are not stopped.
+ */
+void             bus_preload_stop               (void);
+
+G_END_DECLS
+#endif
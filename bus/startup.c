@@ -0,0 +1,104 @@
+/* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/* vim:set et sts=4: */
+/* ibus - The Input Bus
+ * Copyright (C) 2026 IBus contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include "startup.h"
+
+#include "global.h"
+
+typedef struct _BusStartupStage BusStartupStage;
+struct _BusStartupStage {
+    const gchar *name;
+    gint64 begin;
+    gint64 end;
+    gboolean main_thread;
+};
+
+static GMutex startup_lock;
+static gint64 startup_time = 0;
+/* an array of BusStartupStage in the order of their ends. */
+static GArray *stages = NULL;
+static GThread *main_thread = NULL;
+
+void
+bus_startup_init (void)
+{
+    startup_time = g_get_monotonic_time ();
+    main_thread = g_thread_self ();
+    if (g_startup_profile)
+        stages = g_array_new (FALSE, FALSE, sizeof (BusStartupStage));
+}
+
+gint64
+bus_startup_stage_begin (void)
+{
+    return g_get_monotonic_time ();
+}
+
+void
+bus_startup_stage_end (const gchar *name,
+                       gint64       begin)
+{
+    BusStartupStage stage;
+
+    g_assert (name != NULL);
+
+    stage.name = name;
+    stage.begin = begin;
+    stage.end = g_get_monotonic_time ();
+    stage.main_thread = (g_thread_self () == main_thread);
+
+    g_mutex_lock (&startup_lock);
+    if (stages != NULL)
+        g_array_append_val (stages, stage);
+    g_mutex_unlock (&startup_lock);
+}
+
+void
+bus_startup_report (void)
+{
+    GArray *array;
+    guint i;
+
+    g_mutex_lock (&startup_lock);
+    array = stages;
+    stages = NULL;
+    g_mutex_unlock (&startup_lock);
+
+    if (array == NULL)
+        return;
+
+    g_printerr ("ibus-daemon startup profile (msec):\n");
+    g_printerr ("  %-24s %10s %10s %10s\n",
+                "stage", "start", "end", "duration");
+    for (i = 0; i < array->len; i++) {
+        BusStartupStage *stage = &g_array_index (array, BusStartupStage, i);
+        g_printerr ("  %-24s %10.3f %10.3f %10.3f%s\n",
+                    stage->name,
+                    (stage->begin - startup_time) / 1000.0,
+                    (stage->end - startup_time) / 1000.0,
+                    (stage->end - stage->begin) / 1000.0,
+                    stage->main_thread ? "" : " (thread)");
+    }
+    g_printerr ("  %-24s %10s %10.3f\n",
+                "total", "",
+                (g_get_monotonic_time () - startup_time) / 1000.0);
+    g_array_free (array, TRUE);
+}
@@ -0,0 +1,63 @@
+/* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/* vim:set et sts=4: */
+/* ibus - The Input Bus
+ * Copyright (C) 2026 IBus contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+#ifndef __BUS_STARTUP_H_
+#define __BUS_STARTUP_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * bus_startup_init:
+ *
+ * Record the start time of ibus-daemon. The times of the stages are
+ * relative to it.
+ */
+void             bus_startup_init               (void);
+
+/**
+ * bus_startup_stage_begin:
+ *
+ * Returns: The monotonic time to be passed to bus_startup_stage_end().
+ */
+gint64           bus_startup_stage_begin        (void);
+
+/**
+ * bus_startup_stage_end:
+ * @name: The name of the stage, which should be a static string.
+ * @begin: The time returned by bus_startup_stage_begin().
+ *
+ * Record a startup stage. This function is thread safe and could be called
+ * by the thread which loads the registry.
+ */
+void             bus_startup_stage_end          (const gchar        *name,
+                                                 gint64              begin);
+
+/**
+ * bus_startup_report:
+ *
+ * Print the recorded stages to stderr if g_startup_profile is %TRUE, and
+ * stop recording.
+ */
+void             bus_startup_report             (void);
+
+G_END_DECLS
+#endif
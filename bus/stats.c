@@ -0,0 +1,149 @@
+/* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/* vim:set et sts=4: */
+/* ibus - The Input Bus
+ * Copyright (C) 2026 IBus contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+
+#include "stats.h"
+
+/* upper bounds of the round trip histogram buckets in micro seconds. */
+static const gint64 round_trip_bounds[] = {
+    250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000,
+};
+
+#define N_ROUND_TRIP_BUCKETS (G_N_ELEMENTS (round_trip_bounds) + 1)
+
+typedef struct _BusStatsHistogram BusStatsHistogram;
+struct _BusStatsHistogram {
+    guint64 buckets[N_ROUND_TRIP_BUCKETS];
+};
+
+static const gchar *counter_names[BUS_STATS_LAST] = {
+    "messages-forwarded",
+    "messages-dispatched",
+    "forward-queue-depth",
+    "dispatch-queue-depth",
+    "input-contexts",
+    "engine-proxies",
+    "messages-dropped",
+    "panel-updates-skipped",
+};
+
+/* The counters are updated by the GDBus's worker thread too. */
+static GMutex stats_lock;
+static gint64 counters[BUS_STATS_LAST];
+/* a map from an engine method name to a BusStatsHistogram. */
+static GHashTable *round_trips = NULL;
+
+void
+bus_stats_add (BusStatsCounter counter,
+               gint64          delta)
+{
+    g_return_if_fail (counter < BUS_STATS_LAST);
+
+    g_mutex_lock (&stats_lock);
+    counters[counter] += delta;
+    g_mutex_unlock (&stats_lock);
+}
+
+gint64
+bus_stats_get (BusStatsCounter counter)
+{
+    gint64 value;
+
+    g_return_val_if_fail (counter < BUS_STATS_LAST, 0);
+
+    g_mutex_lock (&stats_lock);
+    value = counters[counter];
+    g_mutex_unlock (&stats_lock);
+    return value;
+}
+
+const gchar *
+bus_stats_get_counter_name (BusStatsCounter counter)
+{
+    g_return_val_if_fail (counter < BUS_STATS_LAST, NULL);
+    return counter_names[counter];
+}
+
+void
+bus_stats_add_engine_round_trip (const gchar *method_name,
+                                 gint64       usec)
+{
+    BusStatsHistogram *histogram;
+    guint i;
+
+    g_assert (method_name != NULL);
+
+    for (i = 0; i < G_N_ELEMENTS (round_trip_bounds); i++) {
+        if (usec < round_trip_bounds[i])
+            break;
+    }
+
+    g_mutex_lock (&stats_lock);
+    if (round_trips == NULL) {
+        round_trips = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free, g_free);
+    }
+    histogram = g_hash_table_lookup (round_trips, method_name);
+    if (histogram == NULL) {
+        histogram = g_new0 (BusStatsHistogram, 1);
+        g_hash_table_insert (round_trips, g_strdup (method_name), histogram);
+    }
+    histogram->buckets[i]++;
+    g_mutex_unlock (&stats_lock);
+}
+
+GVariant *
+bus_stats_serialize_engine_round_trips (void)
+{
+    GVariantBuilder builder;
+    GList *keys, *p;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sat)"));
+    g_mutex_lock (&stats_lock);
+    if (round_trips != NULL) {
+        /* sort the methods so that "ibus stats" prints them stably. */
+        keys = g_list_sort (g_hash_table_get_keys (round_trips),
+                            (GCompareFunc) g_strcmp0);
+        for (p = keys; p != NULL; p = p->next) {
+            const gchar *key = (const gchar *) p->data;
+            BusStatsHistogram *histogram = g_hash_table_lookup (round_trips,
+                                                                key);
+            GVariant *buckets = g_variant_new_fixed_array (
+                    G_VARIANT_TYPE_UINT64,
+                    histogram->buckets,
+                    N_ROUND_TRIP_BUCKETS,
+                    sizeof (guint64));
+            g_variant_builder_add (&builder, "(s@at)", key, buckets);
+        }
+        g_list_free (keys);
+    }
+    g_mutex_unlock (&stats_lock);
+    return g_variant_builder_end (&builder);
+}
+
+GVariant *
+bus_stats_serialize_round_trip_bounds (void)
+{
+    return g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64,
+                                      round_trip_bounds,
+                                      G_N_ELEMENTS (round_trip_bounds),
+                                      sizeof (gint64));
+}
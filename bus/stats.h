@@ -0,0 +1,120 @@
+/* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
+/* vim:set et sts=4: */
+/* ibus - The Input Bus
+ * Copyright (C) 2026 IBus contributors
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ */
+#ifndef __BUS_STATS_H_
+#define __BUS_STATS_H_
+
+#include <glib.h>
+
+/* The D-Bus interface of the daemon statistics, which is implemented on
+ * IBUS_PATH_IBUS by BusIBusImpl. */
+#define BUS_INTERFACE_STATS "org.freedesktop.IBus.Stats"
+
+G_BEGIN_DECLS
+
+/**
+ * BusStatsCounter:
+ * @BUS_STATS_MESSAGES_FORWARDED: The number of messages forwarded by
+ *     bus_dbus_impl_forward_message().
+ * @BUS_STATS_MESSAGES_DISPATCHED: The number of messages dispatched by
+ *     bus_dbus_impl_dispatch_message_by_rule().
+ * @BUS_STATS_FORWARD_QUEUE_DEPTH: The current length of the forward queue.
+ * @BUS_STATS_DISPATCH_QUEUE_DEPTH: The current length of the dispatch queue.
+ * @BUS_STATS_INPUT_CONTEXTS: The number of live BusInputContext objects.
+ * @BUS_STATS_ENGINE_PROXIES: The number of live BusEngineProxy objects.
+ * @BUS_STATS_MESSAGES_DROPPED: The number of method calls rejected by the
+ *     per-connection rate or queue limits.
+ * @BUS_STATS_PANEL_UPDATES_SKIPPED: The number of panel updates not sent
+ *     because they were same as the last ones or replaced by newer ones.
+ *
+ * Counters and gauges of ibus-daemon.
+ */
+typedef enum {
+    BUS_STATS_MESSAGES_FORWARDED = 0,
+    BUS_STATS_MESSAGES_DISPATCHED,
+    BUS_STATS_FORWARD_QUEUE_DEPTH,
+    BUS_STATS_DISPATCH_QUEUE_DEPTH,
+    BUS_STATS_INPUT_CONTEXTS,
+    BUS_STATS_ENGINE_PROXIES,
+    BUS_STATS_MESSAGES_DROPPED,
+    BUS_STATS_PANEL_UPDATES_SKIPPED,
+    BUS_STATS_LAST
+} BusStatsCounter;
+
+/**
+ * bus_stats_add:
+ * @counter: A #BusStatsCounter.
+ * @delta: The value to be added to @counter.
+ *
+ * Update a counter. This function is thread safe and could be called by
+ * the GDBus's worker thread.
+ */
+void             bus_stats_add                  (BusStatsCounter     counter,
+                                                 gint64              delta);
+
+/**
+ * bus_stats_get:
+ * @counter: A #BusStatsCounter.
+ *
+ * Returns: The current value of @counter.
+ */
+gint64           bus_stats_get                  (BusStatsCounter     counter);
+
+/**
+ * bus_stats_get_counter_name:
+ * @counter: A #BusStatsCounter.
+ *
+ * Returns: The D-Bus dictionary key of @counter, e.g. "messages-forwarded".
+ */
+const gchar     *bus_stats_get_counter_name     (BusStatsCounter     counter);
+
+/**
+ * bus_stats_add_engine_round_trip:
+ * @method_name: A D-Bus method name of org.freedesktop.IBus.Engine.
+ * @usec: The round trip time in micro seconds.
+ *
+ * Record the round trip time of an engine method call in the histogram of
+ * @method_name.
+ */
+void             bus_stats_add_engine_round_trip
+                                                (const gchar        *method_name,
+                                                 gint64              usec);
+
+/**
+ * bus_stats_serialize_engine_round_trips:
+ *
+ * Returns: (transfer floating): The engine round trip histograms as
+ *     "a(sat)", the method name and the count of each bucket whose upper
+ *     bounds are returned by bus_stats_serialize_round_trip_bounds().
+ */
+GVariant        *bus_stats_serialize_engine_round_trips
+                                                (void);
+
+/**
+ * bus_stats_serialize_round_trip_bounds:
+ *
+ * Returns: (transfer floating): The upper bounds of the histogram buckets
+ *     in micro seconds as "at". The last bucket has no upper bound.
+ */
+GVariant        *bus_stats_serialize_round_trip_bounds
+                                                (void);
+
+G_END_DECLS
+#endif
@@ -19,7 +19,11 @@
  * USA
  */
 #include <stdlib.h>
+#include <signal.h>
+#include <string.h>
 #include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 #include <ibus.h>
 #include <locale.h>
@@ -29,6 +33,91 @@
 #define MAX_SEND_KEY_NUM 100
 #define MAX_RANDOM_SPACE 5
 
+#define STRESS_ENGINE_NAME "stress:echo"
+#define STRESS_COMPONENT_NAME "org.freedesktop.IBus.StressEcho"
+
+typedef enum {
+    STRESS_OP_KEY_PRESS = 0,
+    STRESS_OP_KEY_RELEASE,
+    STRESS_OP_FOCUS_IN,
+    STRESS_OP_SURROUNDING_TEXT,
+    STRESS_OP_CURSOR_LOCATION,
+    STRESS_OP_LAST
+} StressOp;
+
+static const gchar *stress_op_names[STRESS_OP_LAST] = {
+    "ProcessKeyEvent(press)",
+    "ProcessKeyEvent(release)",
+    "FocusIn",
+    "SetSurroundingText",
+    "SetCursorLocation",
+};
+
+typedef struct _StressStats StressStats;
+typedef struct _StressClient StressClient;
+typedef struct _StressCall StressCall;
+
+struct _StressStats {
+    /* round trip times in micro seconds for each StressOp */
+    GArray   *rtt[STRESS_OP_LAST];
+    guint     errors[STRESS_OP_LAST];
+    guint     commits;
+    guint     n_running;
+    GMainLoop *loop;
+};
+
+struct _StressClient {
+    guint             id;
+    GDBusConnection  *connection;
+    IBusInputContext *context;
+    GRand            *rnd;
+    GString          *surrounding;
+    guint             timeout_id;
+    guint             n_sent;
+    guint             n_pending;
+    gint              space_count;
+    StressStats      *stats;
+};
+
+struct _StressCall {
+    StressClient *client;
+    StressOp      op;
+    gint64        start;
+};
+
+/* load generator options */
+static gint opt_clients = 4;
+static gint opt_ops = 50;
+static gint opt_rate = 800;
+static gint opt_focus_ratio = 5;
+static gint opt_surrounding_ratio = 10;
+static gint opt_cursor_ratio = 10;
+static gint opt_seed = 0;
+static gboolean opt_echo_engine = FALSE;
+static gchar *prgname = NULL;
+
+static GOptionEntry stress_entries[] = {
+    { "clients", 'n', 0, G_OPTION_ARG_INT, &opt_clients,
+      "Number of concurrent simulated clients", "N" },
+    { "ops", 'o', 0, G_OPTION_ARG_INT, &opt_ops,
+      "Number of operations sent by each client", "N" },
+    { "rate", 'r', 0, G_OPTION_ARG_INT, &opt_rate,
+      "Operations per minute sent by each client", "N" },
+    { "focus-ratio", 0, 0, G_OPTION_ARG_INT, &opt_focus_ratio,
+      "Percentage of operations which switch the focus", "PERCENT" },
+    { "surrounding-ratio", 0, 0, G_OPTION_ARG_INT, &opt_surrounding_ratio,
+      "Percentage of operations which update the surrounding text",
+      "PERCENT" },
+    { "cursor-ratio", 0, 0, G_OPTION_ARG_INT, &opt_cursor_ratio,
+      "Percentage of operations which update the cursor location",
+      "PERCENT" },
+    { "seed", 's', 0, G_OPTION_ARG_INT, &opt_seed,
+      "Random seed, the current time if 0", "SEED" },
+    { "echo-engine", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE,
+      &opt_echo_engine, "Run the stand-in echo engine", NULL },
+    { NULL },
+};
+
 static gboolean
 _sleep_cb (gpointer user_data)
 {
@@ -111,12 +200,510 @@ test (void)
     g_rand_free (rnd);
 }
 
+/* The stand-in engine runs in a child process which re-executes this
+ * program with --echo-engine so that the engine does not share the main
+ * loop and the IBusBus instance with the simulated clients.
+ */
+static gboolean
+_echo_engine_process_key_event_cb (IBusEngine *engine,
+                                   guint       keyval,
+                                   guint       keycode,
+                                   guint       state,
+                                   gpointer    user_data)
+{
+    gunichar ch;
+
+    if (state & IBUS_RELEASE_MASK)
+        return FALSE;
+    if (state & (IBUS_CONTROL_MASK | IBUS_MOD1_MASK))
+        return FALSE;
+    ch = ibus_keyval_to_unicode (keyval);
+    if (ch == 0 || !g_unichar_isprint (ch))
+        return FALSE;
+    ibus_engine_commit_text (engine, ibus_text_new_from_unichar (ch));
+    return TRUE;
+}
+
+static IBusEngine *
+_echo_factory_create_engine_cb (IBusFactory *factory,
+                                const gchar *name,
+                                IBusBus     *bus)
+{
+    static guint id = 0;
+    IBusEngine *engine;
+    gchar *path = g_strdup_printf ("/org/freedesktop/IBus/engine/stress/%u",
+                                   ++id);
+
+    engine = ibus_engine_new (name, path, ibus_bus_get_connection (bus));
+    g_signal_connect (engine, "process-key-event",
+                      G_CALLBACK (_echo_engine_process_key_event_cb), NULL);
+    g_free (path);
+    return engine;
+}
+
+static int
+_echo_engine_main (void)
+{
+    IBusBus *bus;
+    IBusFactory *factory;
+    IBusComponent *component;
+
+    bus = ibus_bus_new ();
+    if (!ibus_bus_is_connected (bus)) {
+        g_printerr ("ibus-daemon is not running.\n");
+        return EXIT_FAILURE;
+    }
+    g_signal_connect (bus, "disconnected", G_CALLBACK (ibus_quit), NULL);
+    factory = ibus_factory_new (ibus_bus_get_connection (bus));
+    g_signal_connect (factory, "create-engine",
+                      G_CALLBACK (_echo_factory_create_engine_cb), bus);
+    component = ibus_component_new (STRESS_COMPONENT_NAME,
+                                    "Stress echo engine",
+                                    "0.0.1",
+                                    "LGPL",
+                                    "",
+                                    "",
+                                    "",
+                                    "ibus");
+    ibus_component_add_engine (component,
+                               ibus_engine_desc_new (STRESS_ENGINE_NAME,
+                                                     "Stress Echo",
+                                                     "Stress Echo",
+                                                     "en",
+                                                     "LGPL",
+                                                     "",
+                                                     "",
+                                                     "us"));
+    ibus_bus_register_component (bus, component);
+    ibus_main ();
+    g_object_unref (component);
+    g_object_unref (factory);
+    g_object_unref (bus);
+    return EXIT_SUCCESS;
+}
+
+static gboolean
+_wait_for_echo_engine (IBusBus *bus)
+{
+    static const gchar *names[] = { STRESS_ENGINE_NAME, NULL };
+    gint i;
+
+    for (i = 0; i < 100; i++) {
+        IBusEngineDesc **descs = ibus_bus_get_engines_by_names (bus, names);
+        gboolean found = (descs != NULL && descs[0] != NULL);
+        IBusEngineDesc **d;
+
+        for (d = descs; d && *d; d++)
+            g_object_unref (*d);
+        g_free (descs);
+        if (found)
+            return TRUE;
+        _sleep (100);
+    }
+    return FALSE;
+}
+
+static void _stress_client_schedule (StressClient *client);
+
+static void
+_stress_call_done_cb (GDBusProxy   *proxy,
+                      GAsyncResult *res,
+                      StressCall   *call)
+{
+    StressClient *client = call->client;
+    StressStats *stats = client->stats;
+    GError *error = NULL;
+    GVariant *result;
+    gint64 rtt = g_get_monotonic_time () - call->start;
+
+    result = g_dbus_proxy_call_finish (proxy, res, &error);
+    if (result == NULL) {
+        g_printerr ("client %u: %s failed: %s\n", client->id,
+                    stress_op_names[call->op], error->message);
+        stats->errors[call->op]++;
+        g_error_free (error);
+    } else {
+        g_array_append_val (stats->rtt[call->op], rtt);
+        g_variant_unref (result);
+    }
+    g_slice_free (StressCall, call);
+
+    client->n_pending--;
+    if (client->n_pending == 0 && client->n_sent >= (guint) opt_ops) {
+        if (--stats->n_running == 0)
+            g_main_loop_quit (stats->loop);
+    }
+}
+
+static void
+_stress_client_call (StressClient *client,
+                     StressOp      op,
+                     const gchar  *method,
+                     GVariant     *parameters)
+{
+    StressCall *call = g_slice_new (StressCall);
+
+    call->client = client;
+    call->op = op;
+    call->start = g_get_monotonic_time ();
+    client->n_pending++;
+    g_dbus_proxy_call ((GDBusProxy *) client->context,
+                       method,
+                       parameters,
+                       G_DBUS_CALL_FLAGS_NONE,
+                       -1,
+                       NULL,
+                       (GAsyncReadyCallback) _stress_call_done_cb,
+                       call);
+}
+
+static guint
+_stress_client_next_keyval (StressClient *client)
+{
+    if (client->space_count > 0 || g_rand_int_range (client->rnd, 0, 5) == 0) {
+        /* send space key 20% */
+        if (client->space_count == 0) {
+            client->space_count =
+                    g_rand_int_range (client->rnd, 0, MAX_RANDOM_SPACE) + 1;
+        }
+        if (client->space_count-- == 1)
+            return IBUS_KEY_Return;
+        return IBUS_KEY_space;
+    }
+    /* send random a-z key */
+    return g_rand_int_range (client->rnd, 0, 'z' - 'a' + 1) + 'a';
+}
+
+static gboolean
+_stress_client_tick_cb (StressClient *client)
+{
+    gint r = g_rand_int_range (client->rnd, 0, 100);
+
+    client->timeout_id = 0;
+    client->n_sent++;
+
+    if (r < opt_focus_ratio) {
+        _stress_client_call (client, STRESS_OP_FOCUS_IN, "FocusIn", NULL);
+    } else if ((r -= opt_focus_ratio) < opt_surrounding_ratio) {
+        IBusText *text;
+        guint len;
+
+        if (client->surrounding->len > 256)
+            g_string_truncate (client->surrounding, 0);
+        g_string_append_c (client->surrounding,
+                           'a' + g_rand_int_range (client->rnd, 0, 26));
+        text = ibus_text_new_from_string (client->surrounding->str);
+        len = client->surrounding->len;
+        _stress_client_call (client,
+                             STRESS_OP_SURROUNDING_TEXT,
+                             "SetSurroundingText",
+                             g_variant_new ("(vuu)",
+                                            ibus_serializable_serialize (
+                                                    (IBusSerializable *)text),
+                                            len, len));
+        g_object_unref (text);
+    } else if ((r -= opt_surrounding_ratio) < opt_cursor_ratio) {
+        _stress_client_call (client,
+                             STRESS_OP_CURSOR_LOCATION,
+                             "SetCursorLocation",
+                             g_variant_new ("(iiii)",
+                                            g_rand_int_range (client->rnd,
+                                                              0, 1920),
+                                            g_rand_int_range (client->rnd,
+                                                              0, 1080),
+                                            0, 16));
+    } else {
+        guint keyval = _stress_client_next_keyval (client);
+        _stress_client_call (client,
+                             STRESS_OP_KEY_PRESS,
+                             "ProcessKeyEvent",
+                             g_variant_new ("(uuu)", keyval, 0, 0));
+        _stress_client_call (client,
+                             STRESS_OP_KEY_RELEASE,
+                             "ProcessKeyEvent",
+                             g_variant_new ("(uuu)", keyval, 0,
+                                            IBUS_RELEASE_MASK));
+    }
+
+    if (client->n_sent < (guint) opt_ops)
+        _stress_client_schedule (client);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_stress_client_schedule (StressClient *client)
+{
+    /* Add a +-25% jitter so that the clients do not run in lockstep. */
+    guint interval = 60 * 1000 / MAX (opt_rate, 1);
+    guint jitter = interval / 4;
+
+    if (jitter > 0)
+        interval += g_rand_int_range (client->rnd, 0, 2 * jitter) - jitter;
+    client->timeout_id = g_timeout_add (interval,
+                                        (GSourceFunc) _stress_client_tick_cb,
+                                        client);
+}
+
+static void
+_stress_client_commit_text_cb (IBusInputContext *context,
+                               IBusText         *text,
+                               StressClient     *client)
+{
+    client->stats->commits++;
+}
+
+static StressClient *
+_stress_client_new (guint        id,
+                    guint32      seed,
+                    StressStats *stats)
+{
+    StressClient *client;
+    GError *error = NULL;
+    GVariant *result;
+    gchar *name;
+    const gchar *path = NULL;
+
+    client = g_slice_new0 (StressClient);
+    client->id = id;
+    client->stats = stats;
+    client->rnd = g_rand_new_with_seed (seed + id);
+    client->surrounding = g_string_new (NULL);
+
+    /* Each simulated client owns a private connection like a separate
+     * application does.
+     */
+    client->connection = g_dbus_connection_new_for_address_sync (
+            ibus_get_address (),
+            G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+            G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+            NULL, NULL, &error);
+    if (client->connection == NULL) {
+        g_printerr ("client %u: %s\n", id, error->message);
+        g_error_free (error);
+        return client;
+    }
+
+    name = g_strdup_printf ("test-stress-%u", id);
+    result = g_dbus_connection_call_sync (client->connection,
+                                          IBUS_SERVICE_IBUS,
+                                          IBUS_PATH_IBUS,
+                                          IBUS_INTERFACE_IBUS,
+                                          "CreateInputContext",
+                                          g_variant_new ("(s)", name),
+                                          G_VARIANT_TYPE ("(o)"),
+                                          G_DBUS_CALL_FLAGS_NONE,
+                                          -1, NULL, &error);
+    g_free (name);
+    if (result == NULL) {
+        g_printerr ("client %u: %s\n", id, error->message);
+        g_error_free (error);
+        return client;
+    }
+    g_variant_get (result, "(&o)", &path);
+    client->context = ibus_input_context_new (path,
+                                              client->connection,
+                                              NULL,
+                                              &error);
+    g_variant_unref (result);
+    if (client->context == NULL) {
+        g_printerr ("client %u: %s\n", id, error->message);
+        g_error_free (error);
+        return client;
+    }
+    g_signal_connect (client->context, "commit-text",
+                      G_CALLBACK (_stress_client_commit_text_cb), client);
+    ibus_input_context_set_capabilities (client->context,
+                                         IBUS_CAP_FOCUS |
+                                         IBUS_CAP_PREEDIT_TEXT |
+                                         IBUS_CAP_SURROUNDING_TEXT);
+    return client;
+}
+
+static void
+_stress_client_free (StressClient *client)
+{
+    if (client->timeout_id)
+        g_source_remove (client->timeout_id);
+    if (client->context) {
+        ibus_proxy_destroy ((IBusProxy *) client->context);
+        g_object_unref (client->context);
+    }
+    if (client->connection) {
+        g_dbus_connection_close_sync (client->connection, NULL, NULL);
+        g_object_unref (client->connection);
+    }
+    g_string_free (client->surrounding, TRUE);
+    g_rand_free (client->rnd);
+    g_slice_free (StressClient, client);
+}
+
+static gint
+_compare_gint64 (gconstpointer a,
+                 gconstpointer b)
+{
+    gint64 x = *(const gint64 *) a;
+    gint64 y = *(const gint64 *) b;
+    return (x > y) - (x < y);
+}
+
+static gdouble
+_percentile (GArray *sorted,
+             guint   percent)
+{
+    guint index;
+
+    if (sorted->len == 0)
+        return 0.0;
+    index = (sorted->len * percent + 99) / 100;
+    if (index > 0)
+        index--;
+    return g_array_index (sorted, gint64, index) / 1000.0;
+}
+
+static void
+_stress_stats_report (StressStats *stats,
+                      gdouble      elapsed)
+{
+    guint total = 0;
+    gint i;
+
+    g_print ("%-26s %8s %6s %10s %9s %9s %9s\n",
+             "operation", "count", "errors", "ops/sec",
+             "p50(ms)", "p95(ms)", "p99(ms)");
+    for (i = 0; i < STRESS_OP_LAST; i++) {
+        GArray *rtt = stats->rtt[i];
+
+        g_array_sort (rtt, _compare_gint64);
+        total += rtt->len;
+        g_print ("%-26s %8u %6u %10.1f %9.3f %9.3f %9.3f\n",
+                 stress_op_names[i],
+                 rtt->len,
+                 stats->errors[i],
+                 rtt->len / elapsed,
+                 _percentile (rtt, 50),
+                 _percentile (rtt, 95),
+                 _percentile (rtt, 99));
+    }
+    g_print ("%u round trips in %.3f sec: %.1f ops/sec, %u commits\n",
+             total, elapsed, total / elapsed, stats->commits);
+}
+
+static gboolean
+_stress_timeout_cb (StressStats *stats)
+{
+    g_printerr ("load generator timed out with %u running clients\n",
+                stats->n_running);
+    g_main_loop_quit (stats->loop);
+    return G_SOURCE_REMOVE;
+}
+
+/* ibus load generator
+   Drive many concurrent clients, each on its own D-Bus connection,
+   against a stand-in echo engine and report the throughput and the
+   round trip latency percentiles of each operation.
+*/
+static void
+test_load (void)
+{
+    IBusBus *bus;
+    StressStats stats = { { 0, }, };
+    StressClient **clients;
+    GTimer *timer;
+    guint32 seed = opt_seed ? (guint32) opt_seed : (guint32) time (NULL);
+    gchar *engine_argv[] = { prgname, "--echo-engine", NULL };
+    GPid pid;
+    guint timeout_id;
+    gint i;
+    gboolean retval;
+
+    /* do not put the calls in g_assert() which could be compiled out. */
+    retval = g_spawn_async (NULL, engine_argv, NULL,
+                            G_SPAWN_DO_NOT_REAP_CHILD,
+                            NULL, NULL, &pid, NULL);
+    g_assert (retval);
+
+    bus = ibus_bus_new ();
+    g_assert (ibus_bus_is_connected (bus));
+    retval = _wait_for_echo_engine (bus);
+    g_assert (retval);
+    retval = ibus_bus_set_global_engine (bus, STRESS_ENGINE_NAME);
+    g_assert (retval);
+
+    for (i = 0; i < STRESS_OP_LAST; i++)
+        stats.rtt[i] = g_array_new (FALSE, FALSE, sizeof (gint64));
+    stats.loop = g_main_loop_new (NULL, FALSE);
+
+    g_print ("random seed:%u clients:%d ops:%d rate:%d/min\n",
+             seed, opt_clients, opt_ops, opt_rate);
+    clients = g_new0 (StressClient *, opt_clients);
+    for (i = 0; i < opt_clients; i++) {
+        clients[i] = _stress_client_new (i, seed, &stats);
+        g_assert (clients[i]->context != NULL);
+        ibus_input_context_focus_in (clients[i]->context);
+    }
+
+    timer = g_timer_new ();
+    for (i = 0; i < opt_clients; i++) {
+        _stress_client_schedule (clients[i]);
+        stats.n_running++;
+    }
+    /* Allow twice the nominal duration plus some slack. */
+    timeout_id = g_timeout_add_seconds (
+            2 * opt_ops * 60 / MAX (opt_rate, 1) + 30,
+            (GSourceFunc) _stress_timeout_cb, &stats);
+    if (stats.n_running > 0)
+        g_main_loop_run (stats.loop);
+    g_timer_stop (timer);
+
+    if (stats.n_running == 0)
+        g_source_remove (timeout_id);
+    _stress_stats_report (&stats, g_timer_elapsed (timer, NULL));
+
+    g_assert_cmpuint (stats.n_running, ==, 0);
+    g_assert (ibus_bus_is_connected (bus));
+    for (i = 0; i < STRESS_OP_LAST; i++) {
+        g_assert_cmpuint (stats.errors[i], ==, 0);
+        g_array_free (stats.rtt[i], TRUE);
+    }
+
+    for (i = 0; i < opt_clients; i++)
+        _stress_client_free (clients[i]);
+    g_free (clients);
+    g_timer_destroy (timer);
+    g_main_loop_unref (stats.loop);
+
+    kill (pid, SIGTERM);
+    waitpid (pid, NULL, 0);
+    g_spawn_close_pid (pid);
+    g_object_unref (bus);
+}
+
 int
 main (int argc, char *argv[])
 {
+    GOptionContext *option_context;
+    GError *error = NULL;
+
+    prgname = argv[0];
     g_test_init (&argc, &argv, NULL);
     setlocale (LC_ALL, "");
+
+    option_context = g_option_context_new ("- ibus load generator");
+    g_option_context_add_main_entries (option_context, stress_entries, NULL);
+    /* runtest passes the source directory as an argument. */
+    g_option_context_set_ignore_unknown_options (option_context, TRUE);
+    if (!g_option_context_parse (option_context, &argc, &argv, &error)) {
+        g_printerr ("%s\n", error->message);
+        g_error_free (error);
+        return EXIT_FAILURE;
+    }
+    g_option_context_free (option_context);
+    opt_clients = MAX (opt_clients, 1);
+
     ibus_init ();
+    if (opt_echo_engine)
+        return _echo_engine_main ();
     g_test_add_func ("/test-stress", test);
+    g_test_add_func ("/test-stress/load", test_load);
     return g_test_run ();
 }
@@ -89,6 +89,8 @@ struct _IBusIMContext {
 
     guint32          time;
     gint             caps;
+    /* caps sent by CreateInputContextWithState */
+    gint             created_caps;
 
     /* cancellable */
     GCancellable    *cancellable;
@@ -2391,8 +2393,9 @@ _create_input_context_done (IBusBus       *bus,
                             IBusIMContext *ibusimcontext)
 {
     GError *error = NULL;
-    IBusInputContext *context = ibus_bus_create_input_context_async_finish (
-            _bus, res, &error);
+    IBusInputContext *context =
+            ibus_bus_create_input_context_with_state_async_finish (
+                    _bus, res, &error);
 
     if (ibusimcontext->cancellable != NULL) {
         g_object_unref (ibusimcontext->cancellable);
@@ -2404,7 +2407,6 @@ _create_input_context_done (IBusBus       *bus,
         g_error_free (error);
     } else {
         gboolean requested_surrounding_text = FALSE;
-        ibus_input_context_set_client_commit_preedit (context, TRUE);
         if (_use_sync_mode == 1)
             ibus_input_context_set_post_process_key_event (context, TRUE);
         ibusimcontext->ibuscontext = context;
@@ -2437,8 +2439,11 @@ _create_input_context_done (IBusBus       *bus,
                           G_CALLBACK (_ibus_context_destroy_cb),
                           ibusimcontext);
 
-        ibus_input_context_set_capabilities (ibusimcontext->ibuscontext,
-                                             ibusimcontext->caps);
+        /* the caps could be changed while the context is created. */
+        if (ibusimcontext->caps != ibusimcontext->created_caps) {
+            ibus_input_context_set_capabilities (ibusimcontext->ibuscontext,
+                                                 ibusimcontext->caps);
+        }
 
         if (ibusimcontext->rgba && ibusimcontext->rgba->selected_fg &&
             ibusimcontext->rgba->selected_bg) {
@@ -2518,8 +2523,16 @@ _create_input_context (IBusIMContext *ibusimcontext)
 #endif
                                    prgname);
     g_free (prgname);
-    ibus_bus_create_input_context_async (_bus,
-            client_name, -1,
+    /* The content type and the cursor location are sent on focus-in. */
+    ibusimcontext->created_caps = ibusimcontext->caps;
+    ibus_bus_create_input_context_with_state_async (_bus,
+            client_name,
+            ibusimcontext->caps,
+            IBUS_INPUT_PURPOSE_FREE_FORM,
+            IBUS_INPUT_HINT_NONE,
+            NULL,
+            TRUE,
+            -1,
             ibusimcontext->cancellable,
             (GAsyncReadyCallback)_create_input_context_done,
             g_object_ref (ibusimcontext));
@@ -2616,8 +2629,9 @@ _create_fake_input_context_done (IBusBus       *bus,
                                  IBusIMContext *ibusimcontext)
 {
     GError *error = NULL;
-    IBusInputContext *context = ibus_bus_create_input_context_async_finish (
-            _bus, res, &error);
+    IBusInputContext *context =
+            ibus_bus_create_input_context_with_state_async_finish (
+                    _bus, res, &error);
 
     if (_fake_cancellable != NULL) {
         g_object_unref (_fake_cancellable);
@@ -2639,10 +2653,6 @@ _create_fake_input_context_done (IBusBus       *bus,
                       G_CALLBACK (_ibus_fake_context_destroy_cb),
                       NULL);
 
-    guint32 caps = IBUS_CAP_PREEDIT_TEXT | IBUS_CAP_FOCUS
-                   | IBUS_CAP_SURROUNDING_TEXT;
-    ibus_input_context_set_capabilities (_fake_context, caps);
-
     /* focus in/out the fake context */
     if (_focus_im_context == NULL)
         ibus_input_context_focus_in (_fake_context);
@@ -2667,8 +2677,14 @@ _create_fake_input_context (void)
 
     _fake_cancellable = g_cancellable_new ();
 
-    ibus_bus_create_input_context_async (_bus,
-            "fake-gtk-im", -1,
+    ibus_bus_create_input_context_with_state_async (_bus,
+            "fake-gtk-im",
+            IBUS_CAP_PREEDIT_TEXT | IBUS_CAP_FOCUS | IBUS_CAP_SURROUNDING_TEXT,
+            IBUS_INPUT_PURPOSE_FREE_FORM,
+            IBUS_INPUT_HINT_NONE,
+            NULL,
+            FALSE,
+            -1,
             _fake_cancellable,
             (GAsyncReadyCallback)_create_fake_input_context_done,
             NULL);
@@ -173,6 +173,10 @@ struct _IBusWaylandIMPrivate
 #endif
 
     struct xkb_context *xkb_context;
+    /* a map from a digest of the keymap text or the RMLVO names to an
+     * IBusXkbKeymap without the state, and its recently used order. */
+    GHashTable *keymap_cache;
+    GQueue keymap_cache_lru;
 
     IBusXkbKeymap key_user;
     IBusXkbKeymap key_sys;
@@ -1419,14 +1423,105 @@ static const struct zwp_input_method_context_v1_listener context_listener_v1 = {
 };
 
 
-static struct xkb_keymap *
-create_user_xkb_keymap (struct xkb_context *xkb_context,
-                        IBusEngineDesc     *desc)
+/* The compositor sends the keymap again on every layout toggle and the
+ * engine switch selects one of a few layouts, so a few entries are enough.
+ */
+#define KEYMAP_CACHE_SIZE 8
+
+static void
+ibus_xkb_keymap_cache_entry_free (IBusXkbKeymap *entry)
+{
+    xkb_keymap_unref (entry->keymap);
+    g_slice_free (IBusXkbKeymap, entry);
+}
+
+
+static const IBusXkbKeymap *
+ibus_wayland_im_lookup_keymap_cache (IBusWaylandIMPrivate *priv,
+                                     const gchar          *digest)
+{
+    IBusXkbKeymap *entry;
+    GList *link;
+
+    if (!priv->keymap_cache)
+        return NULL;
+    entry = g_hash_table_lookup (priv->keymap_cache, digest);
+    if (!entry)
+        return NULL;
+    link = g_queue_find_custom (&priv->keymap_cache_lru,
+                                digest,
+                                (GCompareFunc) g_strcmp0);
+    g_assert (link);
+    g_queue_unlink (&priv->keymap_cache_lru, link);
+    g_queue_push_head_link (&priv->keymap_cache_lru, link);
+    return entry;
+}
+
+
+static const IBusXkbKeymap *
+ibus_wayland_im_add_keymap_cache (IBusWaylandIMPrivate *priv,
+                                  const gchar          *digest,
+                                  struct xkb_keymap    *keymap)
+{
+    IBusXkbKeymap *entry;
+    gchar *key;
+
+    if (!priv->keymap_cache) {
+        priv->keymap_cache = g_hash_table_new_full (
+                g_str_hash,
+                g_str_equal,
+                g_free,
+                (GDestroyNotify) ibus_xkb_keymap_cache_entry_free);
+    }
+    entry = g_slice_new0 (IBusXkbKeymap);
+    /* The cache takes the ownership of keymap. */
+    entry->keymap = keymap;
+
+    /* xkb_map_mod_get_index() can return any xkb_mod_index_t value, including
+     * values wider than xkb_mod_mask_t can represent.  Shifting by those values
+     * is undefined behavior in C.
+     */
+#define _WL_MOD_MASK(keymap, name) \
+    ({ xkb_mod_index_t idx = xkb_map_mod_get_index (keymap, name); \
+       (idx < sizeof (xkb_mod_mask_t) * CHAR_BIT) \
+               ? ((xkb_mod_mask_t) 1 << idx) : 0; })
+    entry->shift_mask   = _WL_MOD_MASK (keymap, "Shift");
+    entry->lock_mask    = _WL_MOD_MASK (keymap, "Lock");
+    entry->control_mask = _WL_MOD_MASK (keymap, "Control");
+    entry->mod1_mask    = _WL_MOD_MASK (keymap, "Mod1");
+    entry->mod2_mask    = _WL_MOD_MASK (keymap, "Mod2");
+    entry->mod3_mask    = _WL_MOD_MASK (keymap, "Mod3");
+    entry->mod4_mask    = _WL_MOD_MASK (keymap, "Mod4");
+    entry->mod5_mask    = _WL_MOD_MASK (keymap, "Mod5");
+    entry->super_mask   = _WL_MOD_MASK (keymap, "Super");
+    entry->hyper_mask   = _WL_MOD_MASK (keymap, "Hyper");
+    entry->meta_mask    = _WL_MOD_MASK (keymap, "Meta");
+#undef _WL_MOD_MASK
+
+    key = g_strdup (digest);
+    g_hash_table_insert (priv->keymap_cache, key, entry);
+    g_queue_push_head (&priv->keymap_cache_lru, key);
+    while (g_queue_get_length (&priv->keymap_cache_lru) > KEYMAP_CACHE_SIZE) {
+        /* The hash table frees the key. */
+        gchar *old_key = g_queue_pop_tail (&priv->keymap_cache_lru);
+        g_hash_table_remove (priv->keymap_cache, old_key);
+    }
+    return entry;
+}
+
+
+static const IBusXkbKeymap *
+create_user_xkb_keymap (IBusWaylandIMPrivate *priv,
+                        IBusEngineDesc       *desc)
 {
     struct xkb_rule_names names;
+    struct xkb_keymap *keymap;
+    const IBusXkbKeymap *entry;
     const gchar *layout;
+    gchar *rmlvo;
+    gchar *digest;
 
-    g_assert (xkb_context);
+    g_assert (priv->xkb_context);
     g_assert (desc);
     names.rules = "evdev";
     names.model = "pc105";
@@ -1436,21 +1531,38 @@ create_user_xkb_keymap (struct xkb_context *xkb_context,
     names.layout = layout;
     names.variant = ibus_engine_desc_get_layout_variant (desc);
     names.options = g_getenv ("XKB_DEFAULT_OPTIONS");
-    return xkb_keymap_new_from_names (xkb_context, &names, 0);
+
+    rmlvo = g_strdup_printf ("names:%s\n%s\n%s\n%s\n%s",
+                             names.rules, names.model, names.layout,
+                             names.variant ? names.variant : "",
+                             names.options ? names.options : "");
+    digest = g_compute_checksum_for_string (G_CHECKSUM_SHA256, rmlvo, -1);
+    g_free (rmlvo);
+    entry = ibus_wayland_im_lookup_keymap_cache (priv, digest);
+    if (!entry) {
+        keymap = xkb_keymap_new_from_names (priv->xkb_context, &names, 0);
+        if (keymap)
+            entry = ibus_wayland_im_add_keymap_cache (priv, digest, keymap);
+    }
+    g_free (digest);
+    return entry;
 }
 
 
-static struct xkb_keymap *
-create_system_xkb_keymap (struct xkb_context *xkb_context,
-                          uint32_t            format,
-                          int32_t             fd,
-                          uint32_t            size)
+static const IBusXkbKeymap *
+create_system_xkb_keymap (IBusWaylandIMPrivate *priv,
+                          uint32_t              format,
+                          int32_t               fd,
+                          uint32_t              size)
 {
     GMappedFile *map;
     GError *error = NULL;
-    struct xkb_keymap *xkb_keymap;
+    struct xkb_keymap *keymap;
+    const IBusXkbKeymap *entry;
+    const gchar *contents;
+    gchar *digest;
 
-    g_assert (xkb_context);
+    g_assert (priv->xkb_context);
     if (format != WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1) {
         close(fd);
         return NULL;
@@ -1466,53 +1578,55 @@ create_system_xkb_keymap (struct xkb_context *xkb_context,
         return NULL;
     }
 
-    xkb_keymap = xkb_map_new_from_string (xkb_context,
-                                          g_mapped_file_get_contents (map),
+    /* Hashing the keymap text is much cheaper than compiling it. */
+    contents = g_mapped_file_get_contents (map);
+    digest = g_compute_checksum_for_data (G_CHECKSUM_SHA256,
+                                          (const guchar *) contents,
+                                          g_mapped_file_get_length (map));
+    entry = ibus_wayland_im_lookup_keymap_cache (priv, digest);
+    if (!entry) {
+        keymap = xkb_map_new_from_string (priv->xkb_context,
+                                          contents,
                                           XKB_KEYMAP_FORMAT_TEXT_V1,
                                           0);
+        if (keymap)
+            entry = ibus_wayland_im_add_keymap_cache (priv, digest, keymap);
+    }
+    g_free (digest);
     g_mapped_file_unref (map);
     close(fd);
-    return xkb_keymap;
+    return entry;
 }
 
 
 static gboolean
-ibus_xkb_keymap_update_with_keymap (IBusXkbKeymap     *ibus_keymap,
-                                    struct xkb_keymap *keymap)
+ibus_xkb_keymap_update_with_keymap (IBusXkbKeymap       *ibus_keymap,
+                                    const IBusXkbKeymap *entry)
 {
     struct xkb_state *state;
 
     g_return_val_if_fail (ibus_keymap, FALSE);
-    g_return_val_if_fail (keymap, FALSE);
-    g_return_val_if_fail ((state = xkb_state_new (keymap)), FALSE);
+    g_return_val_if_fail (entry, FALSE);
+    g_return_val_if_fail ((state = xkb_state_new (entry->keymap)), FALSE);
 
     if (ibus_keymap->state)
         xkb_state_unref (ibus_keymap->state);
     if (ibus_keymap->keymap)
         xkb_keymap_unref (ibus_keymap->keymap);
-    ibus_keymap->keymap = xkb_keymap_ref (keymap);
+    ibus_keymap->keymap = xkb_keymap_ref (entry->keymap);
     ibus_keymap->state = state;
 
-    /* xkb_map_mod_get_index() can return any xkb_mod_index_t value, including
-     * values wider than xkb_mod_mask_t can represent.  Shifting by those values
-     * is undefined behavior in C.
-     */
-#define _WL_MOD_MASK(keymap, name) \
-    ({ xkb_mod_index_t idx = xkb_map_mod_get_index (keymap, name); \
-       (idx < sizeof (xkb_mod_mask_t) * CHAR_BIT) \
-               ? ((xkb_mod_mask_t) 1 << idx) : 0; })
-    ibus_keymap->shift_mask   = _WL_MOD_MASK (keymap, "Shift");
-    ibus_keymap->lock_mask    = _WL_MOD_MASK (keymap, "Lock");
-    ibus_keymap->control_mask = _WL_MOD_MASK (keymap, "Control");
-    ibus_keymap->mod1_mask    = _WL_MOD_MASK (keymap, "Mod1");
-    ibus_keymap->mod2_mask    = _WL_MOD_MASK (keymap, "Mod2");
-    ibus_keymap->mod3_mask    = _WL_MOD_MASK (keymap, "Mod3");
-    ibus_keymap->mod4_mask    = _WL_MOD_MASK (keymap, "Mod4");
-    ibus_keymap->mod5_mask    = _WL_MOD_MASK (keymap, "Mod5");
-    ibus_keymap->super_mask   = _WL_MOD_MASK (keymap, "Super");
-    ibus_keymap->hyper_mask   = _WL_MOD_MASK (keymap, "Hyper");
-    ibus_keymap->meta_mask    = _WL_MOD_MASK (keymap, "Meta");
-#undef _WL_MOD_MASK
+    ibus_keymap->shift_mask   = entry->shift_mask;
+    ibus_keymap->lock_mask    = entry->lock_mask;
+    ibus_keymap->control_mask = entry->control_mask;
+    ibus_keymap->mod1_mask    = entry->mod1_mask;
+    ibus_keymap->mod2_mask    = entry->mod2_mask;
+    ibus_keymap->mod3_mask    = entry->mod3_mask;
+    ibus_keymap->mod4_mask    = entry->mod4_mask;
+    ibus_keymap->mod5_mask    = entry->mod5_mask;
+    ibus_keymap->super_mask   = entry->super_mask;
+    ibus_keymap->hyper_mask   = entry->hyper_mask;
+    ibus_keymap->meta_mask    = entry->meta_mask;
 
     return TRUE;
 }
@@ -1525,7 +1639,7 @@ _bus_global_engine_changed_cb (IBusBus       *bus,
 {
     IBusWaylandIMPrivate *priv;
     IBusEngineDesc *desc;
-    struct xkb_keymap *keymap;
+    const IBusXkbKeymap *keymap;
     gboolean has_keymap = FALSE;
 
     g_return_if_fail (IBUS_IS_BUS (bus));
@@ -1539,11 +1653,10 @@ _bus_global_engine_changed_cb (IBusBus       *bus,
      * so that ibus_wayland_im_set_property() switches %PROP_USE_SYS_KEYMAP
      * immediately without checking the Gsettings.
      */
-    keymap = create_user_xkb_keymap (priv->xkb_context, desc);
+    keymap = create_user_xkb_keymap (priv, desc);
     if (keymap) {
         has_keymap = ibus_xkb_keymap_update_with_keymap (&priv->key_user,
                                                          keymap);
-        xkb_keymap_unref (keymap);
     }
     if (priv->verbose) {
         fprintf (priv->log, "New engine:%s keymap:%s state:%s\n",
@@ -1565,7 +1678,7 @@ input_method_keyboard_keymap (void                      *data,
 {
     IBusWaylandIM *wlim = data;
     IBusWaylandIMPrivate *priv;
-    struct xkb_keymap *keymap;
+    const IBusXkbKeymap *keymap;
     gboolean has_keymap = FALSE;
 
     if (!IBUS_IS_WAYLAND_IM (wlim)) {
@@ -1615,21 +1728,15 @@ input_method_keyboard_keymap (void                      *data,
         close (fd);
         return;
     }
-    keymap = create_system_xkb_keymap (priv->xkb_context, format, fd, size);
+    keymap = create_system_xkb_keymap (priv, format, fd, size);
     if (keymap) {
         has_keymap = ibus_xkb_keymap_update_with_keymap (&priv->key_sys,
                                                          keymap);
-        if (!has_keymap)
-            g_clear_pointer (&keymap, xkb_keymap_unref);
     }
     if (has_keymap && !priv->key_user.state) {
         has_keymap = ibus_xkb_keymap_update_with_keymap (&priv->key_user,
                                                          keymap);
-        if (!has_keymap)
-            g_clear_pointer (&keymap, xkb_keymap_unref);
     }
-    if (has_keymap)
-        xkb_keymap_unref (keymap);
     if (priv->verbose) {
         fprintf (priv->log, "System keymap format:%u fd:%d size:%u "
                             "keymap:%s state:%s\n",
@@ -2606,7 +2713,7 @@ _create_input_context_done (GObject      *object,
 
     g_return_if_fail (IBUS_IS_WAYLAND_IM (wlim));
     priv = ibus_wayland_im_get_instance_private (wlim);
-    context = ibus_bus_create_input_context_async_finish (
+    context = ibus_bus_create_input_context_with_state_async_finish (
             priv->ibusbus, res, &error);
     if (priv->cancellable != NULL)
         g_clear_object (&priv->cancellable);
@@ -2616,7 +2723,6 @@ _create_input_context_done (GObject      *object,
         g_error_free (error);
     }
     else {
-        guint32 capabilities = IBUS_CAP_FOCUS | IBUS_CAP_PREEDIT_TEXT;
         priv->ibuscontext = context;
 
         g_signal_connect (priv->ibuscontext, "commit-text",
@@ -2640,14 +2746,7 @@ _create_input_context_done (GObject      *object,
         g_signal_connect (priv->ibuscontext, "delete-surrounding-text",
                           G_CALLBACK (_context_delete_surrounding_text_cb),
                           wlim);
-
-        capabilities |= IBUS_CAP_SURROUNDING_TEXT;
 #endif
-        if (_use_sync_mode == 1)
-            capabilities |= IBUS_CAP_SYNC_PROCESS_KEY_V2;
-        ibus_input_context_set_capabilities (priv->ibuscontext,
-                                             capabilities);
-        ibus_input_context_set_client_commit_preedit (priv->ibuscontext, TRUE);
         ibus_input_context_set_preedit_format (priv->ibuscontext,
                                                IBUS_PREEDIT_FORMAT_HINT);
         if (_use_sync_mode == 1) {
@@ -2675,6 +2774,7 @@ input_method_activate (void                               *data,
 {
     IBusWaylandIM *wlim = data;
     IBusWaylandIMPrivate *priv;
+    guint32 capabilities = IBUS_CAP_FOCUS | IBUS_CAP_PREEDIT_TEXT;
 
     g_return_if_fail (IBUS_IS_WAYLAND_IM (wlim));
     priv = ibus_wayland_im_get_instance_private (wlim);
@@ -2719,13 +2819,26 @@ input_method_activate (void                               *data,
 
     g_assert (!priv->ibuscontext);
 
+#ifdef ENABLE_SURROUNDING
+    capabilities |= IBUS_CAP_SURROUNDING_TEXT;
+#endif
+    if (_use_sync_mode == 1)
+        capabilities |= IBUS_CAP_SYNC_PROCESS_KEY_V2;
+
+    /* The content type is sent again after the focus-in in
+     * _create_input_context_done() only if it is changed. */
     priv->cancellable = g_cancellable_new ();
-    ibus_bus_create_input_context_async (priv->ibusbus,
-                                         "wayland",
-                                         -1,
-                                         priv->cancellable,
-                                         _create_input_context_done,
-                                         wlim);
+    ibus_bus_create_input_context_with_state_async (priv->ibusbus,
+                                                    "wayland",
+                                                    capabilities,
+                                                    priv->ibus_purpose,
+                                                    priv->ibus_hints,
+                                                    NULL,
+                                                    TRUE,
+                                                    -1,
+                                                    priv->cancellable,
+                                                    _create_input_context_done,
+                                                    wlim);
 }
 
 
@@ -3374,7 +3487,7 @@ ibus_wayland_im_constructor (GType                  type,
     IBusWaylandIMPrivate *priv;
     IBusWaylandSeat *seat = NULL;
     IBusEngineDesc *desc;
-    struct xkb_keymap *keymap = NULL;
+    const IBusXkbKeymap *keymap = NULL;
     gboolean has_keymap = FALSE;
 
     object = G_OBJECT_CLASS (ibus_wayland_im_parent_class)->constructor (
@@ -3423,11 +3536,10 @@ ibus_wayland_im_constructor (GType                  type,
     }
     desc = ibus_bus_get_global_engine (priv->ibusbus);
     if (desc)
-        keymap = create_user_xkb_keymap (priv->xkb_context, desc);
+        keymap = create_user_xkb_keymap (priv, desc);
     if (keymap) {
         has_keymap = ibus_xkb_keymap_update_with_keymap (&priv->key_user,
                                                          keymap);
-        xkb_keymap_unref (keymap);
     }
     if (priv->verbose) {
         if (!desc) {
@@ -3519,6 +3631,8 @@ ibus_wayland_im_destroy (IBusObject *object)
     g_clear_pointer (&priv->key_sys.state, xkb_state_unref);
     g_clear_pointer (&priv->key_user.keymap, xkb_keymap_unref);
     g_clear_pointer (&priv->key_sys.keymap, xkb_keymap_unref);
+    g_queue_clear (&priv->keymap_cache_lru);
+    g_clear_pointer (&priv->keymap_cache, g_hash_table_destroy);
     g_clear_pointer (&priv->xkb_context, xkb_context_unref);
     if (priv->log) {
         fclose (priv->log);
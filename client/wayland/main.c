@@ -55,6 +55,8 @@ main (gint    argc,
         g_printerr ("Cannot connect to ibus-daemon\n");
         return EXIT_FAILURE;
     }
+    /* An input context is created on each activation of the input method. */
+    ibus_bus_set_input_context_pool (bus, "wayland", 1);
 
     if (!(display = wl_display_connect (NULL))) {
         g_printerr ("Cannot open Wayland display\n");
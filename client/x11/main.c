@@ -51,6 +51,9 @@
 #define ESC_SEQUENCE_ISO10646_1 "\033%G"
 /* Wait for about 120 secs to return a key from async process-key-event. */
 #define MAX_WAIT_KEY_TIME       120000
+/* The input contexts created in advance so that XIM_CREATE_IC does not
+ * wait for ibus-daemon. */
+#define INPUT_CONTEXT_POOL_SIZE 2
 
 #define LOG(level, fmt_args...) \
     if (g_debug_level >= (level)) { \
@@ -128,6 +131,22 @@ static IBusBus *_bus = NULL;
 
 static char _use_sync_mode = 1;
 
+/* TRUE if the locale of ibus-x11 is UTF-8 and COMPOUND_TEXT is encoded
+ * without the Xlib locale converters. */
+static gboolean _utf8_locale = FALSE;
+/* The buffer of the converted COMPOUND_TEXT, which is reused by every
+ * commit and preedit. */
+static GString *_compound_text = NULL;
+
+enum {
+    CT_CLASS_OTHER = 0,
+    /* HT, NL and the printable ASCII in GL of COMPOUND_TEXT. */
+    CT_CLASS_ASCII,
+    /* The UTF-8 lead bytes of U+0080..U+00FF in GR of COMPOUND_TEXT. */
+    CT_CLASS_LATIN1,
+};
+static guint8 _compound_text_class[256];
+
 static void
 _xim_preedit_start (XIMS xims, const X11IC *x11ic)
 {
@@ -179,12 +198,98 @@ _xim_preedit_callback_done (XIMS xims, const X11IC *x11ic)
 }
 
 
+static void
+_init_compound_text (void)
+{
+    gint c;
+
+    _utf8_locale = g_get_charset (NULL);
+    _compound_text = g_string_sized_new (256);
+
+    memset (_compound_text_class, CT_CLASS_OTHER,
+            sizeof (_compound_text_class));
+    _compound_text_class['\t'] = CT_CLASS_ASCII;
+    _compound_text_class['\n'] = CT_CLASS_ASCII;
+    for (c = 0x20; c < 0x7f; c++)
+        _compound_text_class[c] = CT_CLASS_ASCII;
+    _compound_text_class[0xc2] = CT_CLASS_LATIN1;
+    _compound_text_class[0xc3] = CT_CLASS_LATIN1;
+}
+
+/* Encode the UTF-8 string with the default GL (ASCII) and GR (the right
+ * half of ISO8859-1) of COMPOUND_TEXT. Returns FALSE if another character
+ * is found since libX11 encodes it with a charset segment of the locale,
+ * e.g. JIS X 0208, which legacy XIM clients expect. */
+static gboolean
+_utf8_to_compound_text_fast (const gchar *utf8)
+{
+    const guchar *p = (const guchar *)utf8;
+    guint c;
+
+    g_string_truncate (_compound_text, 0);
+    for (; *p != '\0'; p++) {
+        switch (_compound_text_class[*p]) {
+        case CT_CLASS_ASCII:
+            g_string_append_c (_compound_text, *p);
+            continue;
+        case CT_CLASS_LATIN1:
+            c = ((p[0] & 0x1f) << 6) | (p[1] & 0x3f);
+            /* C1 control characters are not allowed. */
+            if ((p[1] & 0xc0) == 0x80 && c >= 0xa0) {
+                g_string_append_c (_compound_text, c);
+                p++;
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/* Returns COMPOUND_TEXT of @utf8 in the shared buffer, which is valid
+ * until the next call. */
+static const gchar *
+_utf8_to_compound_text (const gchar *utf8,
+                        gsize       *length)
+{
+    XTextProperty tp = { NULL, };
+    int ret;
+
+    if (!_utf8_locale || !_utf8_to_compound_text_fast (utf8)) {
+        ret = Xutf8TextListToTextProperty (
+                GDK_DISPLAY_XDISPLAY (gdk_display_get_default ()),
+                (gchar **)&utf8, 1, XCompoundTextStyle, &tp);
+        /* XCompoundTextStyle uses the encoding escaped sequence + encoded
+         * chars matched to the specified multibyte characters: utf8, and
+         * libX11.so sorts the encoding sets by locale.
+         * If an encoded string fails to be matched, ibus-x11 specifies the
+         * ISO10641-1 encoding and that escaped sequence is "\033%G":
+         * https://gitlab.freedesktop.org/xorg/lib/libx11/-/blob/master/src/xlibi18n/lcCT.c
+         * , and the encoding is UTF-8 with utf8_wctomb():
+         * https://gitlab.freedesktop.org/xorg/lib/libx11/-/blob/master/src/xlibi18n/lcUniConv/utf8.h
+         */
+        if (ret == EXIT_FAILURE || tp.value == NULL) {
+            g_string_assign (_compound_text, ESC_SEQUENCE_ISO10646_1);
+            g_string_append (_compound_text, utf8);
+        } else {
+            g_string_assign (_compound_text, (const gchar *)tp.value);
+        }
+        if (tp.value != NULL)
+            XFree (tp.value);
+    }
+    if (length)
+        *length = _compound_text->len;
+    return _compound_text->str;
+}
+
 static void
 _xim_preedit_callback_draw (XIMS xims, X11IC *x11ic, const gchar *preedit_string, IBusAttrList *attr_list)
 {
     IMPreeditCBStruct pcb;
     XIMText text;
-    XTextProperty tp;
 
     static XIMFeedback *feedback;
     static gint feedback_len = 0;
@@ -258,22 +363,12 @@ _xim_preedit_callback_draw (XIMS xims, X11IC *x11ic, const gchar *preedit_string
     text.feedback = feedback;
 
     if (len > 0) {
-        int ret = Xutf8TextListToTextProperty (
-                GDK_DISPLAY_XDISPLAY (gdk_display_get_default ()),
-                (char **)&preedit_string,
-                1, XCompoundTextStyle, &tp);
-        if (ret == EXIT_FAILURE) {
-            XFree (tp.value);
-            tp.value = (unsigned char *)g_strdup_printf (
-                    "%s%s",
-                    ESC_SEQUENCE_ISO10646_1,
-                    preedit_string);
-        }
+        gsize length;
         text.encoding_is_wchar = 0;
-        text.length = strlen ((char*)tp.value);
-        text.string.multi_byte = (char*)tp.value;
+        text.string.multi_byte =
+                (char *)_utf8_to_compound_text (preedit_string, &length);
+        text.length = length;
         IMCallCallback (xims, (XPointer) & pcb);
-        XFree (tp.value);
     } else {
         text.encoding_is_wchar = 0;
         text.length = 0;
@@ -1049,37 +1144,14 @@ _context_commit_text_cb (IBusInputContext *context,
     g_assert (IBUS_IS_TEXT (text));
     g_assert (x11ic != NULL);
 
-    XTextProperty tp;
     IMCommitStruct cms = {0};
-    int ret;
-
-    ret = Xutf8TextListToTextProperty (
-            GDK_DISPLAY_XDISPLAY (gdk_display_get_default ()),
-            (gchar **)&(text->text), 1, XCompoundTextStyle, &tp);
-    /* XCompoundTextStyle uses the encoding escaped sequence + encoded chars
-     * matched to the specified multibyte characters: text->text, and
-     * libX11.so sorts the encoding sets by locale.
-     * If an encoded string fails to be matched, ibus-x11 specifies the
-     * ISO10641-1 encoding and that escaped sequence is "\033%G":
-     * https://gitlab.freedesktop.org/xorg/lib/libx11/-/blob/master/src/xlibi18n/lcCT.c
-     * , and the encoding is UTF-8 with utf8_wctomb():
-     * https://gitlab.freedesktop.org/xorg/lib/libx11/-/blob/master/src/xlibi18n/lcUniConv/utf8.h
-     */
-    if (ret == EXIT_FAILURE) {
-        XFree (tp.value);
-        tp.value = (unsigned char *)g_strdup_printf ("%s%s",
-                                                     ESC_SEQUENCE_ISO10646_1,
-                                                     text->text);
-    }
 
     cms.major_code = XIM_COMMIT;
     cms.icid = x11ic->icid;
     cms.connect_id = x11ic->connect_id;
     cms.flag = XimLookupChars;
-    cms.commit_string = (gchar *)tp.value;
+    cms.commit_string = (gchar *)_utf8_to_compound_text (text->text, NULL);
     IMCommitString (_xims, (XPointer) & cms);
-
-    XFree (tp.value);
 }
 
 static void
@@ -1218,6 +1290,7 @@ _init_ibus (void)
 
     g_signal_connect (_bus, "disconnected",
                         G_CALLBACK (_bus_disconnected_cb), NULL);
+    ibus_bus_set_input_context_pool (_bus, "xim", INPUT_CONTEXT_POOL_SIZE);
 
     /* https://github.com/ibus/ibus/issues/1713 */
     _use_sync_mode = _get_char_env ("IBUS_ENABLE_SYNC_MODE", 1);
@@ -1374,6 +1447,7 @@ main (int argc, char **argv)
                    "Some multi-byte characters won't be committed correctly.");
     }
     gdk_init (&argc, &argv);
+    _init_compound_text ();
     XSetErrorHandler (_xerror_handler);
     XSetIOErrorHandler (_xerror_io_handler);
 
@@ -703,6 +703,11 @@ main (gint argc, gchar **argv)
     if (!g_setenv ("GIO_USE_VFS", "local", TRUE))
         g_warning ("Failed setenv %s", strerror (errno));
 
+    /* The signals of ibus-daemon are relayed to the clients as they are
+     * and the clients could use an older libibus. */
+    if (!g_setenv ("IBUS_WIRE_VERSION", "0", TRUE))
+        g_warning ("Failed setenv %s", strerror (errno));
+
     ibus_init ();
 
     ibus_set_log_handler (opt_verbose);
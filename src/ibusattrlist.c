@@ -22,6 +22,7 @@
 #include "ibusattrlist.h"
 #include "ibusattrlistprivate.h"
 #include "ibuserror.h"
+#include "ibusinternal.h"
 
 /* functions prototype */
 static void         ibus_attr_list_destroy      (IBusAttrList           *attr_list);
@@ -58,15 +59,11 @@ ibus_attr_list_destroy (IBusAttrList *attr_list)
 {
     g_assert (IBUS_IS_ATTR_LIST (attr_list));
 
-    gint i;
-    for (i = 0;; i++) {
-        IBusAttribute *attr;
-
-        attr = ibus_attr_list_get (attr_list, i);
-        if (attr == NULL)
-            break;
+    guint i;
 
-        g_object_unref (attr);
+    for (i = 0; i < attr_list->attributes->len; i++) {
+        g_object_unref (g_array_index (attr_list->attributes,
+                                       IBusAttribute *, i));
     }
 
     g_array_free (attr_list->attributes, TRUE);
@@ -74,12 +71,31 @@ ibus_attr_list_destroy (IBusAttrList *attr_list)
     IBUS_OBJECT_CLASS (ibus_attr_list_parent_class)->destroy ((IBusObject *)attr_list);
 }
 
+/* Returns TRUE if all the attributes can be serialized as "a(uuuu)"
+ * without losing the attachments or the subclass type. */
+static gboolean
+ibus_attr_list_is_packable (IBusAttrList *attr_list)
+{
+    guint i;
+
+    for (i = 0; i < attr_list->attributes->len; i++) {
+        IBusAttribute *attr = g_array_index (attr_list->attributes,
+                                             IBusAttribute *, i);
+        if (G_OBJECT_TYPE (attr) != IBUS_TYPE_ATTRIBUTE ||
+            _ibus_serializable_has_attachments ((IBusSerializable *)attr)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
 static gboolean
 ibus_attr_list_serialize (IBusAttrList    *attr_list,
                           GVariantBuilder *builder)
 {
     gboolean retval;
-    guint i;
+    guint i, n;
+    guint type, value, start_index, end_index;
 
     retval = IBUS_SERIALIZABLE_CLASS (ibus_attr_list_parent_class)->serialize ((IBusSerializable *)attr_list, builder);
     g_return_val_if_fail (retval, FALSE);
@@ -87,13 +103,26 @@ ibus_attr_list_serialize (IBusAttrList    *attr_list,
     g_return_val_if_fail (IBUS_IS_ATTR_LIST (attr_list), FALSE);
 
     GVariantBuilder array;
-    g_variant_builder_init (&array, G_VARIANT_TYPE ("av"));
+    n = ibus_attr_list_get_n_attributes (attr_list);
+
+    if (ibus_serializable_get_wire_version () >=
+        IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_ATTRS &&
+        ibus_attr_list_is_packable (attr_list)) {
+        g_variant_builder_init (&array, G_VARIANT_TYPE ("a(uuuu)"));
+        for (i = 0; i < n; i++) {
+            ibus_attr_list_get_values (attr_list, i, &type, &value,
+                                       &start_index, &end_index);
+            g_variant_builder_add (&array, "(uuuu)",
+                                   type, value, start_index, end_index);
+        }
+        g_variant_builder_add (builder, "a(uuuu)", &array);
+        return TRUE;
+    }
 
-    for (i = 0;; i++) {
-        IBusAttribute *attr;
-        attr = ibus_attr_list_get (attr_list, i);
-        if (attr == NULL)
-            break;
+    g_variant_builder_init (&array, G_VARIANT_TYPE ("av"));
+    for (i = 0; i < attr_list->attributes->len; i++) {
+        IBusAttribute *attr = g_array_index (attr_list->attributes,
+                                             IBusAttribute *, i);
         g_variant_builder_open (&array, G_VARIANT_TYPE_VARIANT);
         g_variant_builder_add_value (
                 &array,
@@ -112,14 +141,44 @@ ibus_attr_list_deserialize (IBusAttrList    *attr_list,
     gint retval = IBUS_SERIALIZABLE_CLASS (ibus_attr_list_parent_class)->deserialize ((IBusSerializable *)attr_list, variant);
     g_return_val_if_fail (retval, 0);
 
-    GVariantIter *iter = NULL;
-    g_variant_get_child (variant, retval++, "av", &iter);
+    GVariant *child = g_variant_get_child_value (variant, retval++);
+    GVariantIter iter;
+    guint type, value, start_index, end_index;
+
+    g_variant_iter_init (&iter, child);
+    if (g_variant_is_of_type (child, G_VARIANT_TYPE ("a(uuuu)"))) {
+        while (g_variant_iter_next (&iter, "(uuuu)", &type, &value,
+                                    &start_index, &end_index)) {
+            ibus_attr_list_append_values (attr_list, type, value,
+                                          start_index, end_index);
+        }
+        g_variant_unref (child);
+        return retval;
+    }
+
     GVariant *var;
-    while (g_variant_iter_loop (iter, "v", &var)) {
-        IBusAttribute *attr = IBUS_ATTRIBUTE (ibus_serializable_deserialize (var));
-        ibus_attr_list_append (attr_list, attr);
+    while (g_variant_iter_loop (&iter, "v", &var)) {
+        const gchar *type_name = NULL;
+        GVariant *attachments = NULL;
+
+        /* Create a plain IBusAttribute without looking up the GType. */
+        if (g_variant_is_of_type (var, G_VARIANT_TYPE ("(sa{sv}uuuu)"))) {
+            g_variant_get (var, "(&s@a{sv}uuuu)", &type_name, &attachments,
+                           &type, &value, &start_index, &end_index);
+        }
+        if (attachments != NULL &&
+            g_variant_n_children (attachments) == 0 &&
+            g_strcmp0 (type_name, "IBusAttribute") == 0) {
+            ibus_attr_list_append_values (attr_list, type, value,
+                                          start_index, end_index);
+        } else {
+            ibus_attr_list_append (
+                    attr_list,
+                    IBUS_ATTRIBUTE (ibus_serializable_deserialize (var)));
+        }
+        g_clear_pointer (&attachments, g_variant_unref);
     }
-    g_variant_iter_free (iter);
+    g_variant_unref (child);
 
     return retval;
 }
@@ -139,12 +198,11 @@ ibus_attr_list_copy (IBusAttrList       *dest,
     g_return_val_if_fail (IBUS_IS_ATTR_LIST (dest), FALSE);
     g_return_val_if_fail (IBUS_IS_ATTR_LIST (src), FALSE);
 
-    gint i;
-    for (i = 0; ; i++) {
-        IBusAttribute *attr = ibus_attr_list_get ((IBusAttrList *)src, i);
-        if (attr == NULL) {
-            break;
-        }
+    guint i;
+
+    for (i = 0; i < src->attributes->len; i++) {
+        IBusAttribute *attr = g_array_index (src->attributes,
+                                             IBusAttribute *, i);
 
         attr = (IBusAttribute *) ibus_serializable_copy ((IBusSerializable *) attr);
         if (attr == NULL) {
@@ -176,6 +234,42 @@ ibus_attr_list_append (IBusAttrList  *attr_list,
     g_array_append_val (attr_list->attributes, attr);
 }
 
+void
+ibus_attr_list_append_values (IBusAttrList *attr_list,
+                              guint         type,
+                              guint         value,
+                              guint         start_index,
+                              guint         end_index)
+{
+    IBusAttribute *attr;
+
+    g_return_if_fail (IBUS_IS_ATTR_LIST (attr_list));
+
+    /* @type is not checked to keep the attributes of any type received
+     * from D-Bus. */
+    attr = IBUS_ATTRIBUTE (g_object_new (IBUS_TYPE_ATTRIBUTE, NULL));
+    attr->type = type;
+    attr->value = value;
+    attr->start_index = start_index;
+    attr->end_index = end_index;
+    g_object_ref_sink (attr);
+    g_array_append_val (attr_list->attributes, attr);
+}
+
+void
+ibus_attr_list_clear (IBusAttrList *attr_list)
+{
+    guint i;
+
+    g_return_if_fail (IBUS_IS_ATTR_LIST (attr_list));
+
+    for (i = 0; i < attr_list->attributes->len; i++) {
+        g_object_unref (g_array_index (attr_list->attributes,
+                                       IBusAttribute *, i));
+    }
+    g_array_set_size (attr_list->attributes, 0);
+}
+
 IBusAttribute *
 ibus_attr_list_get (IBusAttrList *attr_list,
                     guint         index)
@@ -190,6 +284,40 @@ ibus_attr_list_get (IBusAttrList *attr_list,
     return attr;
 }
 
+guint
+ibus_attr_list_get_n_attributes (IBusAttrList *attr_list)
+{
+    g_return_val_if_fail (IBUS_IS_ATTR_LIST (attr_list), 0);
+
+    return attr_list->attributes->len;
+}
+
+gboolean
+ibus_attr_list_get_values (IBusAttrList *attr_list,
+                           guint         index,
+                           guint        *type,
+                           guint        *value,
+                           guint        *start_index,
+                           guint        *end_index)
+{
+    IBusAttribute *attr;
+
+    g_return_val_if_fail (IBUS_IS_ATTR_LIST (attr_list), FALSE);
+
+    if (index >= attr_list->attributes->len)
+        return FALSE;
+
+    attr = g_array_index (attr_list->attributes, IBusAttribute *, index);
+    if (type)
+        *type = attr->type;
+    if (value)
+        *value = attr->value;
+    if (start_index)
+        *start_index = attr->start_index;
+    if (end_index)
+        *end_index = attr->end_index;
+    return TRUE;
+}
 
 static gboolean
 ibus_attr_list_has_attribution (IBusAttrList  *attr_list,
@@ -118,6 +118,75 @@ void                 ibus_attr_list_append      (IBusAttrList   *attr_list,
 IBusAttribute       *ibus_attr_list_get         (IBusAttrList   *attr_list,
                                                  guint           index);
 
+/**
+ * ibus_attr_list_clear:
+ * @attr_list: An IBusAttrList instance.
+ *
+ * Remove all the IBusAttribute from @attr_list and decrease their
+ * references. @attr_list can be reused with ibus_attr_list_append() or
+ * ibus_text_append_attribute() without creating a new IBusAttrList.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void                 ibus_attr_list_clear       (IBusAttrList   *attr_list);
+
+/**
+ * ibus_attr_list_append_values:
+ * @attr_list: An IBusAttrList instance.
+ * @type: Type of the attribute.
+ * @value: Value of the attribute.
+ * @start_index: Where attribute starts.
+ * @end_index: Where attribute ends.
+ *
+ * Append an attribute to IBusAttrList. The #IBusAttribute is taken from the
+ * attributes released by the other lists if possible.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void                 ibus_attr_list_append_values
+                                                (IBusAttrList   *attr_list,
+                                                 guint           type,
+                                                 guint           value,
+                                                 guint           start_index,
+                                                 guint           end_index);
+
+/**
+ * ibus_attr_list_get_n_attributes:
+ * @attr_list: An IBusAttrList instance.
+ *
+ * Returns: The number of the attributes in @attr_list.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+guint                ibus_attr_list_get_n_attributes
+                                                (IBusAttrList   *attr_list);
+
+/**
+ * ibus_attr_list_get_values:
+ * @attr_list: An IBusAttrList instance.
+ * @index: Index of the @attr_list.
+ * @type: (out) (optional): Type of the attribute.
+ * @value: (out) (optional): Value of the attribute.
+ * @start_index: (out) (optional): Where attribute starts.
+ * @end_index: (out) (optional): Where attribute ends.
+ *
+ * Gets the fields of the attribute at given index.
+ *
+ * Returns: %TRUE if @index is valid, %FALSE otherwise.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+gboolean             ibus_attr_list_get_values  (IBusAttrList   *attr_list,
+                                                 guint           index,
+                                                 guint          *type,
+                                                 guint          *value,
+                                                 guint          *start_index,
+                                                 guint          *end_index);
+
 G_END_DECLS
 #endif
 
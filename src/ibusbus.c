@@ -72,6 +72,30 @@ struct _IBusBusPrivate {
     gboolean client_only;
     GCancellable *cancellable;
     guint portal_name_watch_id;
+    /* input contexts created in advance for ic_pool_client_name. */
+    gchar *ic_pool_client_name;
+    guint ic_pool_size;
+    GQueue ic_pool;
+    /* the number of contexts being created for the pool. */
+    guint ic_pool_pending;
+    /* incremented when the pool is cleared to drop the pending contexts. */
+    guint ic_pool_serial;
+};
+
+typedef struct _IBusBusInputContextState IBusBusInputContextState;
+struct _IBusBusInputContextState {
+    gchar *client_name;
+    gint timeout_msec;
+    guint capabilities;
+    guint purpose;
+    guint hints;
+    IBusRectangle cursor_location;
+    /* FALSE if the caller did not give the cursor location. */
+    gboolean has_cursor_location;
+    gboolean client_commit_preedit;
+    /* TRUE if the state is sent after CreateInputContext because
+     * ibus-daemon does not know CreateInputContextWithState. */
+    gboolean apply;
 };
 
 static guint    bus_signals[LAST_SIGNAL] = { 0 };
@@ -83,6 +107,10 @@ static GObject  *ibus_bus_constructor           (GType                   type,
                                                  guint                   n_params,
                                                  GObjectConstructParam  *params);
 static void      ibus_bus_destroy               (IBusObject             *object);
+static void      ibus_bus_clear_input_context_pool
+                                                (IBusBus                *bus);
+static void      ibus_bus_refill_input_context_pool
+                                                (IBusBus                *bus);
 static void      ibus_bus_connect_async         (IBusBus                *bus);
 static void      ibus_bus_watch_dbus_signal     (IBusBus                *bus);
 static void      ibus_bus_unwatch_dbus_signal   (IBusBus                *bus);
@@ -359,6 +387,7 @@ ibus_bus_close_connection (IBusBus *bus)
     g_cancellable_reset (bus->priv->cancellable);
 
     bus->priv->connected = FALSE;
+    ibus_bus_clear_input_context_pool (bus);
 
     /* unref the old connection at first */
     if (bus->priv->connection != NULL) {
@@ -373,6 +402,62 @@ ibus_bus_close_connection (IBusBus *bus)
     }
 }
 
+static void
+_bus_set_wire_version_cb (GObject      *source_object,
+                          GAsyncResult *res,
+                          gpointer      user_data)
+{
+    GVariant *result;
+    guint version = IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY;
+
+    /* An old ibus-daemon does not have the method and the legacy format
+     * is kept. */
+    result = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source_object),
+                                            res,
+                                            NULL);
+    if (result == NULL)
+        return;
+    g_variant_get (result, "(u)", &version);
+    g_variant_unref (result);
+    /* Only the objects sent to ibus-daemon use the version. */
+    _ibus_serializable_set_connection_wire_version (
+            G_DBUS_CONNECTION (source_object), version);
+}
+
+/**
+ * ibus_bus_negotiate_wire_version:
+ *
+ * Tell ibus-daemon the newest #IBusSerializableWireVersion which this
+ * process supports. $IBUS_WIRE_VERSION can lower it, e.g. ibus-portal
+ * relays the serialized objects to the clients of any version.
+ */
+static void
+ibus_bus_negotiate_wire_version (IBusBus *bus)
+{
+    guint version = IBUS_SERIALIZABLE_WIRE_VERSION_CURRENT;
+    const gchar *env = g_getenv ("IBUS_WIRE_VERSION");
+
+    if (env != NULL)
+        version = MIN (version, (guint) g_ascii_strtoull (env, NULL, 10));
+    if (bus->priv->use_portal ||
+        version == IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY) {
+        return;
+    }
+
+    g_dbus_connection_call (bus->priv->connection,
+                            IBUS_SERVICE_IBUS,
+                            IBUS_PATH_IBUS,
+                            IBUS_INTERFACE_IBUS,
+                            "SetWireVersion",
+                            g_variant_new ("(u)", version),
+                            G_VARIANT_TYPE ("(u)"),
+                            G_DBUS_CALL_FLAGS_NONE,
+                            -1,
+                            bus->priv->cancellable,
+                            (GAsyncReadyCallback) _bus_set_wire_version_cb,
+                            NULL);
+}
+
 static void
 ibus_bus_connect_completed (IBusBus *bus)
 {
@@ -381,6 +466,7 @@ ibus_bus_connect_completed (IBusBus *bus)
     bus->priv->connected = TRUE;
     /* FIXME */
     ibus_bus_hello (bus);
+    ibus_bus_negotiate_wire_version (bus);
 
     g_signal_connect (bus->priv->connection,
                       "closed",
@@ -394,6 +480,8 @@ ibus_bus_connect_completed (IBusBus *bus)
     }
 
     g_signal_emit (bus, bus_signals[CONNECTED], 0);
+
+    ibus_bus_refill_input_context_pool (bus);
 }
 
 static void
@@ -596,6 +684,7 @@ ibus_bus_init (IBusBus *bus)
     bus->priv->client_only = FALSE;
     bus->priv->bus_address = NULL;
     bus->priv->cancellable = g_cancellable_new ();
+    g_queue_init (&bus->priv->ic_pool);
 
     path = g_path_get_dirname (ibus_get_socket_path ());
 
@@ -775,6 +864,11 @@ ibus_bus_destroy (IBusObject *object)
     g_free (bus->priv->bus_address);
     bus->priv->bus_address = NULL;
 
+    ibus_bus_clear_input_context_pool (bus);
+    g_free (bus->priv->ic_pool_client_name);
+    bus->priv->ic_pool_client_name = NULL;
+    bus->priv->ic_pool_size = 0;
+
     g_cancellable_cancel (bus->priv->cancellable);
     g_object_unref (bus->priv->cancellable);
     bus->priv->cancellable = NULL;
@@ -929,6 +1023,71 @@ ibus_bus_is_connected (IBusBus *bus)
     return bus->priv->connected;
 }
 
+static void
+_input_context_state_free (IBusBusInputContextState *state)
+{
+    g_free (state->client_name);
+    g_slice_free (IBusBusInputContextState, state);
+}
+
+static void
+_input_context_apply_state (IBusInputContext         *context,
+                            IBusBusInputContextState *state)
+{
+    const IBusRectangle *rect = &state->cursor_location;
+
+    ibus_input_context_set_client_commit_preedit (context,
+                                                  state->client_commit_preedit);
+    ibus_input_context_set_capabilities (context, state->capabilities);
+    ibus_input_context_set_content_type (context, state->purpose, state->hints);
+    /* do not move the candidate window to (0, 0) without the location. */
+    if (state->has_cursor_location) {
+        ibus_input_context_set_cursor_location (context,
+                                                rect->x, rect->y,
+                                                rect->width, rect->height);
+    }
+}
+
+/**
+ * ibus_bus_take_pooled_input_context:
+ *
+ * Returns: (transfer full): An input context created in advance for
+ *     @client_name, or %NULL.
+ */
+static IBusInputContext *
+ibus_bus_take_pooled_input_context (IBusBus     *bus,
+                                    const gchar *client_name)
+{
+    IBusInputContext *context;
+
+    if (g_strcmp0 (client_name, bus->priv->ic_pool_client_name) != 0)
+        return NULL;
+
+    context = (IBusInputContext *) g_queue_pop_head (&bus->priv->ic_pool);
+    if (context != NULL)
+        ibus_bus_refill_input_context_pool (bus);
+    return context;
+}
+
+static void
+_destroy_input_context (IBusInputContext *context)
+{
+    ibus_proxy_destroy ((IBusProxy *) context);
+    g_object_unref (context);
+}
+
+static void
+ibus_bus_clear_input_context_pool (IBusBus *bus)
+{
+    IBusInputContext *context;
+
+    /* the contexts being created are dropped when they are ready. */
+    bus->priv->ic_pool_serial++;
+    bus->priv->ic_pool_pending = 0;
+    while ((context = g_queue_pop_head (&bus->priv->ic_pool)) != NULL)
+        _destroy_input_context (context);
+}
+
 IBusInputContext *
 ibus_bus_create_input_context (IBusBus      *bus,
                                const gchar  *client_name)
@@ -939,6 +1098,11 @@ ibus_bus_create_input_context (IBusBus      *bus,
     gchar *path;
     IBusInputContext *context = NULL;
     GVariant *result;
+
+    context = ibus_bus_take_pooled_input_context (bus, client_name);
+    if (context != NULL)
+        return context;
+
     result = ibus_bus_call_sync (bus,
                                  IBUS_SERVICE_IBUS,
                                  IBUS_PATH_IBUS,
@@ -969,13 +1133,28 @@ _create_input_context_async_step_two_done (GObject      *source_object,
     GError *error = NULL;
     IBusInputContext *context =
             ibus_input_context_new_async_finish (res, &error);
-    if (context == NULL)
+    if (context == NULL) {
         g_task_return_error (task, error);
-    else
+    }
+    else {
+        if (g_task_get_source_tag (task) ==
+            ibus_bus_create_input_context_with_state_async) {
+            IBusBusInputContextState *state = g_task_get_task_data (task);
+            if (state->apply)
+                _input_context_apply_state (context, state);
+        }
         g_task_return_pointer (task, context, NULL);
+    }
     g_object_unref (task);
 }
 
+static void
+_create_input_context_async_start (IBusBus      *bus,
+                                   GTask        *task,
+                                   const gchar  *client_name,
+                                   gint          timeout_msec,
+                                   GCancellable *cancellable);
+
 static void
 _create_input_context_async_step_one_done (GDBusConnection *connection,
                                            GAsyncResult    *res,
@@ -987,7 +1166,31 @@ _create_input_context_async_step_one_done (GDBusConnection *connection,
     IBusBus *bus;
     GCancellable *cancellable;
 
+    bus = (IBusBus *)g_task_get_source_object (task);
+    g_assert (IBUS_IS_BUS (bus));
+
+    cancellable = g_task_get_cancellable (task);
+
     if (variant == NULL) {
+        IBusBusInputContextState *state = NULL;
+        if (g_task_get_source_tag (task) ==
+            ibus_bus_create_input_context_with_state_async) {
+            state = g_task_get_task_data (task);
+        }
+        /* an old ibus-daemon does not know CreateInputContextWithState. */
+        if (state != NULL && !state->apply &&
+            g_error_matches (error,
+                             G_DBUS_ERROR,
+                             G_DBUS_ERROR_UNKNOWN_METHOD)) {
+            g_error_free (error);
+            state->apply = TRUE;
+            _create_input_context_async_start (bus,
+                                               task,
+                                               state->client_name,
+                                               state->timeout_msec,
+                                               cancellable);
+            return;
+        }
         g_task_return_error (task, error);
         g_object_unref (task);
         return;
@@ -1001,41 +1204,27 @@ _create_input_context_async_step_one_done (GDBusConnection *connection,
         g_variant_unref(variant);
         g_task_return_new_error (task,
                 G_DBUS_ERROR, G_DBUS_ERROR_FAILED, "Connection is closed.");
+        g_object_unref (task);
         return;
     }
 
     g_variant_get (variant, "(&o)", &path);
-    g_variant_unref(variant);
-
-    bus = (IBusBus *)g_task_get_source_object (task);
-    g_assert (IBUS_IS_BUS (bus));
-
-    cancellable = g_task_get_cancellable (task);
 
     ibus_input_context_new_async (path,
             bus->priv->connection,
             cancellable,
             (GAsyncReadyCallback)_create_input_context_async_step_two_done,
             task);
+    g_variant_unref(variant);
 }
 
-void
-ibus_bus_create_input_context_async (IBusBus            *bus,
-                                     const gchar        *client_name,
-                                     gint                timeout_msec,
-                                     GCancellable       *cancellable,
-                                     GAsyncReadyCallback callback,
-                                     gpointer            user_data)
+static void
+_create_input_context_async_start (IBusBus      *bus,
+                                   GTask        *task,
+                                   const gchar  *client_name,
+                                   gint          timeout_msec,
+                                   GCancellable *cancellable)
 {
-    GTask *task;
-
-    g_return_if_fail (IBUS_IS_BUS (bus));
-    g_return_if_fail (client_name != NULL);
-    g_return_if_fail (callback != NULL);
-
-    task = g_task_new (bus, cancellable, callback, user_data);
-    g_task_set_source_tag (task, ibus_bus_create_input_context_async);
-
     /* do not use ibus_bus_call_async, instead use g_dbus_connection_call
      * directly, because we need two async steps for create an IBusInputContext.
      * 1. Call CreateInputContext to request ibus-daemon create a remote IC.
@@ -1055,6 +1244,85 @@ ibus_bus_create_input_context_async (IBusBus            *bus,
             task);
 }
 
+static void
+_input_context_pool_created (GObject      *source_object,
+                             GAsyncResult *res,
+                             gpointer      user_data)
+{
+    IBusBus *bus = (IBusBus *) source_object;
+    IBusInputContext *context;
+
+    context = g_task_propagate_pointer (G_TASK (res), NULL);
+    if (GPOINTER_TO_UINT (user_data) != bus->priv->ic_pool_serial) {
+        /* the pool was cleared while the context was being created. */
+        if (context != NULL)
+            _destroy_input_context (context);
+        return;
+    }
+
+    bus->priv->ic_pool_pending--;
+    if (context == NULL)
+        return;
+    if (bus->priv->ic_pool.length >= bus->priv->ic_pool_size) {
+        _destroy_input_context (context);
+        return;
+    }
+    g_queue_push_tail (&bus->priv->ic_pool, context);
+}
+
+static void
+ibus_bus_refill_input_context_pool (IBusBus *bus)
+{
+    if (bus->priv->ic_pool_client_name == NULL || !ibus_bus_is_connected (bus))
+        return;
+
+    while (bus->priv->ic_pool.length + bus->priv->ic_pool_pending <
+           bus->priv->ic_pool_size) {
+        GTask *task = g_task_new (bus,
+                                  NULL,
+                                  _input_context_pool_created,
+                                  GUINT_TO_POINTER (bus->priv->ic_pool_serial));
+        bus->priv->ic_pool_pending++;
+        _create_input_context_async_start (bus,
+                                           task,
+                                           bus->priv->ic_pool_client_name,
+                                           -1,
+                                           NULL);
+    }
+}
+
+void
+ibus_bus_create_input_context_async (IBusBus            *bus,
+                                     const gchar        *client_name,
+                                     gint                timeout_msec,
+                                     GCancellable       *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer            user_data)
+{
+    GTask *task;
+    IBusInputContext *context;
+
+    g_return_if_fail (IBUS_IS_BUS (bus));
+    g_return_if_fail (client_name != NULL);
+    g_return_if_fail (callback != NULL);
+
+    task = g_task_new (bus, cancellable, callback, user_data);
+    g_task_set_source_tag (task, ibus_bus_create_input_context_async);
+
+    context = ibus_bus_take_pooled_input_context (bus, client_name);
+    if (context != NULL) {
+        g_task_return_pointer (task, context, NULL);
+        g_object_unref (task);
+        return;
+    }
+
+    _create_input_context_async_start (bus,
+                                       task,
+                                       client_name,
+                                       timeout_msec,
+                                       cancellable);
+}
+
 IBusInputContext *
 ibus_bus_create_input_context_async_finish (IBusBus      *bus,
                                             GAsyncResult *res,
@@ -1080,6 +1348,128 @@ ibus_bus_create_input_context_async_finish (IBusBus      *bus,
     return context;
 }
 
+void
+ibus_bus_create_input_context_with_state_async (
+        IBusBus             *bus,
+        const gchar         *client_name,
+        guint                capabilities,
+        guint                purpose,
+        guint                hints,
+        const IBusRectangle *cursor_location,
+        gboolean             client_commit_preedit,
+        gint                 timeout_msec,
+        GCancellable        *cancellable,
+        GAsyncReadyCallback  callback,
+        gpointer             user_data)
+{
+    GTask *task;
+    IBusBusInputContextState *state;
+    IBusInputContext *context;
+    const IBusRectangle *rect;
+
+    g_return_if_fail (IBUS_IS_BUS (bus));
+    g_return_if_fail (client_name != NULL);
+    g_return_if_fail (callback != NULL);
+
+    task = g_task_new (bus, cancellable, callback, user_data);
+    g_task_set_source_tag (task,
+                           ibus_bus_create_input_context_with_state_async);
+
+    state = g_slice_new0 (IBusBusInputContextState);
+    state->client_name = g_strdup (client_name);
+    state->timeout_msec = timeout_msec;
+    state->capabilities = capabilities;
+    state->purpose = purpose;
+    state->hints = hints;
+    if (cursor_location != NULL) {
+        state->cursor_location = *cursor_location;
+        state->has_cursor_location = TRUE;
+    }
+    state->client_commit_preedit = client_commit_preedit;
+    g_task_set_task_data (task,
+                          state,
+                          (GDestroyNotify) _input_context_state_free);
+
+    context = ibus_bus_take_pooled_input_context (bus, client_name);
+    if (context != NULL) {
+        _input_context_apply_state (context, state);
+        g_task_return_pointer (task, context, NULL);
+        g_object_unref (task);
+        return;
+    }
+
+    /* the portal does not implement CreateInputContextWithState. */
+    if (bus->priv->use_portal) {
+        state->apply = TRUE;
+        _create_input_context_async_start (bus,
+                                           task,
+                                           client_name,
+                                           timeout_msec,
+                                           cancellable);
+        return;
+    }
+
+    rect = &state->cursor_location;
+    g_dbus_connection_call (bus->priv->connection,
+            ibus_bus_get_service_name (bus),
+            IBUS_PATH_IBUS,
+            IBUS_INTERFACE_IBUS,
+            "CreateInputContextWithState",
+            g_variant_new ("(suuu(iiii)b)",
+                           client_name,
+                           capabilities,
+                           purpose,
+                           hints,
+                           rect->x, rect->y, rect->width, rect->height,
+                           client_commit_preedit),
+            G_VARIANT_TYPE("(o)"),
+            G_DBUS_CALL_FLAGS_NO_AUTO_START,
+            timeout_msec,
+            cancellable,
+            (GAsyncReadyCallback)_create_input_context_async_step_one_done,
+            task);
+}
+
+IBusInputContext *
+ibus_bus_create_input_context_with_state_async_finish (IBusBus      *bus,
+                                                       GAsyncResult *res,
+                                                       GError      **error)
+{
+    g_return_val_if_fail (IBUS_IS_BUS (bus), NULL);
+    g_return_val_if_fail (g_task_is_valid (res, bus), NULL);
+    g_return_val_if_fail (g_task_get_source_tag (G_TASK (res)) ==
+                          ibus_bus_create_input_context_with_state_async,
+                          NULL);
+
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+void
+ibus_bus_set_input_context_pool (IBusBus     *bus,
+                                 const gchar *client_name,
+                                 guint        size)
+{
+    IBusInputContext *context;
+
+    g_return_if_fail (IBUS_IS_BUS (bus));
+    g_return_if_fail (client_name != NULL || size == 0);
+
+    if (size == 0 ||
+        g_strcmp0 (client_name, bus->priv->ic_pool_client_name) != 0) {
+        ibus_bus_clear_input_context_pool (bus);
+        g_free (bus->priv->ic_pool_client_name);
+        bus->priv->ic_pool_client_name =
+                size > 0 ? g_strdup (client_name) : NULL;
+    }
+
+    bus->priv->ic_pool_size = size;
+    while (bus->priv->ic_pool.length > size) {
+        context = (IBusInputContext *) g_queue_pop_tail (&bus->priv->ic_pool);
+        _destroy_input_context (context);
+    }
+    ibus_bus_refill_input_context_pool (bus);
+}
+
 gchar *
 ibus_bus_current_input_context (IBusBus      *bus)
 {
@@ -2032,6 +2422,123 @@ ibus_bus_get_engines_by_names (IBusBus             *bus,
     return (IBusEngineDesc **)g_array_free (array, FALSE);
 }
 
+static GVariant *
+ibus_bus_parse_query_engines_result (GVariant   *result,
+                                     guint64    *generation,
+                                     gboolean   *complete,
+                                     gchar    ***removed)
+{
+    guint64 generation_ = 0;
+    gboolean complete_ = FALSE;
+    GVariant *engines = NULL;
+    gchar **removed_ = NULL;
+
+    g_variant_get (result, "(tb@aa{sv}^as)",
+                   &generation_, &complete_, &engines, &removed_);
+    if (generation)
+        *generation = generation_;
+    if (complete)
+        *complete = complete_;
+    if (removed)
+        *removed = removed_;
+    else
+        g_strfreev (removed_);
+    return engines;
+}
+
+GVariant *
+ibus_bus_query_engines (IBusBus    *bus,
+                        GVariant   *query,
+                        guint64    *generation,
+                        gboolean   *complete,
+                        gchar    ***removed)
+{
+    GVariant *result;
+    GVariant *engines;
+
+    g_return_val_if_fail (IBUS_IS_BUS (bus), NULL);
+    g_return_val_if_fail (query == NULL ||
+                          g_variant_is_of_type (query,
+                                                G_VARIANT_TYPE_VARDICT),
+                          NULL);
+
+    if (query == NULL)
+        query = g_variant_new ("a{sv}", NULL);
+    result = ibus_bus_call_sync (bus,
+                                 IBUS_SERVICE_IBUS,
+                                 IBUS_PATH_IBUS,
+                                 IBUS_INTERFACE_IBUS,
+                                 "QueryEngines",
+                                 g_variant_new ("(@a{sv})", query),
+                                 G_VARIANT_TYPE ("(tbaa{sv}as)"));
+    if (result == NULL)
+        return NULL;
+
+    engines = ibus_bus_parse_query_engines_result (result,
+                                                   generation,
+                                                   complete,
+                                                   removed);
+    g_variant_unref (result);
+    return engines;
+}
+
+void
+ibus_bus_query_engines_async (IBusBus            *bus,
+                              GVariant           *query,
+                              gint                timeout_msec,
+                              GCancellable       *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer            user_data)
+{
+    g_return_if_fail (IBUS_IS_BUS (bus));
+    g_return_if_fail (query == NULL ||
+                      g_variant_is_of_type (query, G_VARIANT_TYPE_VARDICT));
+
+    if (query == NULL)
+        query = g_variant_new ("a{sv}", NULL);
+    ibus_bus_call_async (bus,
+                         IBUS_SERVICE_IBUS,
+                         IBUS_PATH_IBUS,
+                         IBUS_INTERFACE_IBUS,
+                         "QueryEngines",
+                         g_variant_new ("(@a{sv})", query),
+                         G_VARIANT_TYPE ("(tbaa{sv}as)"),
+                         ibus_bus_query_engines_async,
+                         timeout_msec,
+                         cancellable,
+                         callback,
+                         user_data);
+}
+
+GVariant *
+ibus_bus_query_engines_async_finish (IBusBus      *bus,
+                                     GAsyncResult *res,
+                                     guint64      *generation,
+                                     gboolean     *complete,
+                                     gchar      ***removed,
+                                     GError      **error)
+{
+    GTask *task;
+    GVariant *result;
+    GVariant *engines;
+
+    g_assert (IBUS_IS_BUS (bus));
+    g_assert (g_task_is_valid (res, bus));
+
+    task = G_TASK (res);
+    g_assert (g_task_get_source_tag (task) == ibus_bus_query_engines_async);
+    result = g_task_propagate_pointer (task, error);
+    if (result == NULL)
+        return NULL;
+
+    engines = ibus_bus_parse_query_engines_result (result,
+                                                   generation,
+                                                   complete,
+                                                   removed);
+    g_variant_unref (result);
+    return engines;
+}
+
 static void
 _config_destroy_cb (IBusConfig *config,
                     IBusBus    *bus)
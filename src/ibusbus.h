@@ -604,6 +604,91 @@ IBusInputContext *
                                          GAsyncResult   *res,
                                          GError        **error);
 
+/**
+ * ibus_bus_create_input_context_with_state_async:
+ * @bus: An #IBusBus.
+ * @client_name: Name of client.
+ * @capabilities: The initial capabilities, see #IBusCapabilite.
+ * @purpose: The initial #IBusInputPurpose.
+ * @hints: The initial #IBusInputHints.
+ * @cursor_location: (nullable): The initial cursor location or %NULL.
+ * @client_commit_preedit: %TRUE if the client commits the preedit text
+ *      on reset, see ibus_input_context_set_client_commit_preedit().
+ * @timeout_msec: The timeout in milliseconds or -1 to use the default timeout.
+ * @cancellable: A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied.
+ *      It should not be %NULL.
+ * @user_data: The data to pass to callback.
+ *
+ * Create an input context for client asynchronously, with the initial
+ * state applied by ibus-daemon in the same "CreateInputContextWithState"
+ * call instead of the following SetCapabilities, ContentType,
+ * SetCursorLocation and ClientCommitPreedit calls. If ibus-daemon does not
+ * implement the method, the state is sent after "CreateInputContext".
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void        ibus_bus_create_input_context_with_state_async
+                                        (IBusBus        *bus,
+                                         const gchar    *client_name,
+                                         guint           capabilities,
+                                         guint           purpose,
+                                         guint           hints,
+                                         const IBusRectangle
+                                                        *cursor_location,
+                                         gboolean        client_commit_preedit,
+                                         gint            timeout_msec,
+                                         GCancellable   *cancellable,
+                                         GAsyncReadyCallback
+                                                         callback,
+                                         gpointer        user_data);
+
+/**
+ * ibus_bus_create_input_context_with_state_async_finish:
+ * @bus: An #IBusBus.
+ * @res: A #GAsyncResult obtained from the #GAsyncReadyCallback passed to
+ *   ibus_bus_create_input_context_with_state_async().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with
+ * ibus_bus_create_input_context_with_state_async().
+ *
+ * Returns: (transfer full): A newly allocated #IBusInputContext if the
+ *      call is succeeded, %NULL otherwise.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+IBusInputContext *
+             ibus_bus_create_input_context_with_state_async_finish
+                                        (IBusBus        *bus,
+                                         GAsyncResult   *res,
+                                         GError        **error);
+
+/**
+ * ibus_bus_set_input_context_pool:
+ * @bus: An #IBusBus.
+ * @client_name: (nullable): Name of client, or %NULL if @size is 0.
+ * @size: The number of input contexts created in advance.
+ *
+ * Keep @size input contexts of @client_name created asynchronously in
+ * advance. ibus_bus_create_input_context(),
+ * ibus_bus_create_input_context_async() and
+ * ibus_bus_create_input_context_with_state_async() with the same
+ * @client_name take a context from the pool without a round trip to
+ * ibus-daemon, and the pool is filled again in the background. The pool is
+ * emptied when the connection is closed and filled again when it is
+ * connected. Passing 0 to @size destroys the pooled input contexts.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void        ibus_bus_set_input_context_pool
+                                        (IBusBus        *bus,
+                                         const gchar    *client_name,
+                                         guint           size);
+
 /**
  * ibus_bus_current_input_context:
  * @bus: An #IBusBus.
@@ -829,6 +914,97 @@ IBusEngineDesc **
              ibus_bus_get_engines_by_names
                                         (IBusBus             *bus,
                                          const gchar * const *names);
+
+/**
+ * ibus_bus_query_engines:
+ * @bus: An #IBusBus.
+ * @query: (nullable): A floating or normal "a{sv}" #GVariant of the query
+ *     or %NULL to query all engines.
+ * @generation: (out) (optional): The generation of the engine lists, which
+ *     can be passed as the "since" key of the next query.
+ * @complete: (out) (optional): %TRUE if the returned engines are all
+ *     engines matched with @query, and %FALSE if they are the changes after
+ *     the "since" generation.
+ * @removed: (out) (optional) (array zero-terminated=1) (transfer full):
+ *     The names of the active engines removed after the "since" generation.
+ *
+ * Query the engines synchronously with filtering them by ibus-daemon.
+ * The keys of @query are:
+ * "active" (b): Query the engines registered by running components instead
+ * of the engines of the component files.
+ * "language" (s): The language of the engines, e.g. "ja" or "ja_JP".
+ * "layout" (s): The keyboard layout of the engines.
+ * "name-pattern" (s): A glob pattern of the engine names.
+ * "fields" (as): The #IBusEngineDesc property names to be returned.
+ * All properties are returned by default.
+ * "since" (t): A generation returned by a previous call to get only the
+ * changes after it.
+ *
+ * Returns: (transfer full) (nullable): An "aa{sv}" #GVariant of the
+ *     requested properties of the matched engines.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+GVariant    *ibus_bus_query_engines     (IBusBus        *bus,
+                                         GVariant       *query,
+                                         guint64        *generation,
+                                         gboolean       *complete,
+                                         gchar        ***removed);
+
+/**
+ * ibus_bus_query_engines_async:
+ * @bus: An #IBusBus.
+ * @query: (nullable): A floating or normal "a{sv}" #GVariant of the query
+ *     or %NULL to query all engines.
+ * @timeout_msec: The timeout in milliseconds or -1 to use the default
+ *     timeout.
+ * @cancellable: (nullable): A #GCancellable or %NULL.
+ * @callback: (scope async): A #GAsyncReadyCallback to call when the
+ *     request is satisfied.
+ * @user_data: The data to pass to callback.
+ *
+ * Query the engines asynchronously. See ibus_bus_query_engines().
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void         ibus_bus_query_engines_async
+                                        (IBusBus        *bus,
+                                         GVariant       *query,
+                                         gint            timeout_msec,
+                                         GCancellable   *cancellable,
+                                         GAsyncReadyCallback
+                                                         callback,
+                                         gpointer        user_data);
+
+/**
+ * ibus_bus_query_engines_async_finish:
+ * @bus: An #IBusBus.
+ * @res: A #GAsyncResult obtained from the #GAsyncReadyCallback passed to
+ *     ibus_bus_query_engines_async().
+ * @generation: (out) (optional): The generation of the engine lists.
+ * @complete: (out) (optional): %TRUE if the returned engines are all
+ *     engines matched with the query.
+ * @removed: (out) (optional) (array zero-terminated=1) (transfer full):
+ *     The names of the active engines removed after the "since" generation.
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with ibus_bus_query_engines_async().
+ *
+ * Returns: (transfer full) (nullable): An "aa{sv}" #GVariant of the
+ *     matched engines.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+GVariant    *ibus_bus_query_engines_async_finish
+                                        (IBusBus        *bus,
+                                         GAsyncResult   *res,
+                                         guint64        *generation,
+                                         gboolean       *complete,
+                                         gchar        ***removed,
+                                         GError        **error);
 #ifndef IBUS_DISABLE_DEPRECATED
 /**
  * ibus_bus_get_use_sys_layout:
@@ -21,6 +21,7 @@
  * USA
  */
 #include <glib/gstdio.h>
+#include <string.h>
 #include "ibuscomponent.h"
 #include "ibusinternal.h"
 
@@ -79,6 +80,10 @@ static gint         ibus_component_deserialize  (IBusComponent          *compone
                                                  GVariant               *variant);
 static gboolean     ibus_component_copy         (IBusComponent          *dest,
                                                  const IBusComponent    *src);
+static gboolean     ibus_component_set_xml_field
+                                                (IBusComponent          *component,
+                                                 const gchar            *element_name,
+                                                 const gchar            *text);
 static gboolean     ibus_component_parse_xml_node
                                                 (IBusComponent          *component,
                                                  XMLNode                *node,
@@ -542,6 +547,36 @@ ibus_component_output_engines (IBusComponent  *component,
     g_string_append (output, "</engines>\n");
 }
 
+static gboolean
+ibus_component_set_xml_field (IBusComponent *component,
+                              const gchar   *element_name,
+                              const gchar   *text)
+{
+#define PARSE_ENTRY(field_name, name)                                   \
+    if (g_strcmp0 (element_name, name) == 0) {                          \
+        if (component->priv->field_name != NULL) {                      \
+            g_free (component->priv->field_name);                       \
+        }                                                               \
+        component->priv->field_name = g_strdup (text);                  \
+        return TRUE;                                                    \
+    }
+#define PARSE_ENTRY_1(name) PARSE_ENTRY (name, #name)
+    PARSE_ENTRY_1 (name);
+    PARSE_ENTRY_1 (description);
+    PARSE_ENTRY_1 (version);
+    PARSE_ENTRY_1 (license);
+    PARSE_ENTRY_1 (author);
+    PARSE_ENTRY_1 (homepage);
+    PARSE_ENTRY_1 (exec);
+    PARSE_ENTRY_1 (textdomain);
+#undef PARSE_ENTRY
+#undef PARSE_ENTRY_1
+
+    g_warning ("<component> element contains invalidate element <%s>",
+               element_name);
+    return FALSE;
+}
+
 static gboolean
 ibus_component_parse_xml_node (IBusComponent   *component,
                               XMLNode          *node,
@@ -558,26 +593,6 @@ ibus_component_parse_xml_node (IBusComponent   *component,
     for (p = node->sub_nodes; p != NULL; p = p->next) {
         XMLNode *sub_node = (XMLNode *)p->data;
 
-#define PARSE_ENTRY(field_name, element_name)                           \
-        if (g_strcmp0 (sub_node->name, element_name) == 0) {            \
-            if (component->priv->field_name != NULL) {                  \
-                g_free (component->priv->field_name);                   \
-            }                                                           \
-            component->priv->field_name = g_strdup (sub_node->text);    \
-            continue;                                                   \
-        }
-#define PARSE_ENTRY_1(name) PARSE_ENTRY (name, #name)
-        PARSE_ENTRY_1 (name);
-        PARSE_ENTRY_1 (description);
-        PARSE_ENTRY_1 (version);
-        PARSE_ENTRY_1 (license);
-        PARSE_ENTRY_1 (author);
-        PARSE_ENTRY_1 (homepage);
-        PARSE_ENTRY_1 (exec);
-        PARSE_ENTRY_1 (textdomain);
-#undef PARSE_ENTRY
-#undef PARSE_ENTRY_1
-
         if (g_strcmp0 (sub_node->name, "engines") == 0) {
             ibus_component_parse_engines (component, sub_node);
             continue;
@@ -588,7 +603,7 @@ ibus_component_parse_xml_node (IBusComponent   *component,
             continue;
         }
 
-        g_warning ("<component> element contains invalidate element <%s>", sub_node->name);
+        ibus_component_set_xml_field (component, sub_node->name, sub_node->text);
     }
 
     return TRUE;
@@ -685,6 +700,383 @@ ibus_component_parse_observed_paths (IBusComponent *component,
     }
 }
 
+/*
+ * The streaming parser of component XML files. It fills IBusComponent and
+ * IBusEngineDesc from the GMarkup callbacks directly instead of building
+ * an XMLNode tree and walking it. Only <observed-paths>, which is rare in
+ * the installed component files, is built as a small XMLNode tree.
+ */
+typedef enum {
+    COMPONENT_PARSER_ROOT,
+    COMPONENT_PARSER_COMPONENT,
+    COMPONENT_PARSER_ENGINES,
+    COMPONENT_PARSER_ENGINE,
+    COMPONENT_PARSER_FIELD,
+    COMPONENT_PARSER_OBSERVED_PATHS,
+    COMPONENT_PARSER_SKIP,
+} ComponentParserState;
+
+typedef struct _ComponentParser ComponentParser;
+struct _ComponentParser {
+    IBusComponent *component;
+    gboolean access_fs;
+    /* "component" for a component file or "engines" for the output of
+     * the exec attribute of <engines>. */
+    const gchar *root_name;
+
+    ComponentParserState state;
+    /* the state to go back at the end of a field or a skipped element. */
+    ComponentParserState parent_state;
+    guint skip_depth;
+
+    gchar *field_name;
+    GString *text;
+
+    IBusEngineDesc *engine;
+    /* the parsed IBusEngineDesc objects in the reversed order. */
+    GList *engines;
+    /* TRUE if the engines of current <engines> are given by its exec
+     * attribute. */
+    gboolean engines_from_exec;
+
+    /* the stack of the XMLNode objects in <observed-paths>. */
+    GQueue observed_nodes;
+};
+
+static gboolean     ibus_component_parse_markup (ComponentParser        *parser,
+                                                 const gchar            *text,
+                                                 gssize                  text_len,
+                                                 const gchar            *source);
+
+static void
+component_parser_init (ComponentParser *parser,
+                       IBusComponent   *component,
+                       const gchar     *root_name,
+                       gboolean         access_fs)
+{
+    memset (parser, 0, sizeof (ComponentParser));
+    parser->component = component;
+    parser->root_name = root_name;
+    parser->access_fs = access_fs;
+    parser->state = COMPONENT_PARSER_ROOT;
+    g_queue_init (&parser->observed_nodes);
+}
+
+static void
+component_parser_clear (ComponentParser *parser)
+{
+    g_clear_pointer (&parser->field_name, g_free);
+    if (parser->text != NULL) {
+        g_string_free (parser->text, TRUE);
+        parser->text = NULL;
+    }
+    g_clear_object (&parser->engine);
+    g_list_free_full (parser->engines, g_object_unref);
+    parser->engines = NULL;
+    /* the nodes in the stack are owned by the bottom one. */
+    if (!g_queue_is_empty (&parser->observed_nodes))
+        ibus_xml_free ((XMLNode *) g_queue_peek_tail (&parser->observed_nodes));
+    g_queue_clear (&parser->observed_nodes);
+}
+
+static void
+component_parser_run_exec (ComponentParser *parser,
+                           const gchar     *exec)
+{
+    gchar *output = NULL;
+    gchar *errput = NULL;
+    GError *error = NULL;
+    ComponentParser exec_parser;
+
+    if (!g_spawn_command_line_sync (exec, &output, &errput, NULL, &error)) {
+        g_warning ("Engines exec:%s is failed: %s: %s",
+                   exec, errput ? errput : "(null)", error->message);
+        g_error_free (error);
+        g_free (errput);
+        return;
+    }
+
+    component_parser_init (&exec_parser,
+                           parser->component,
+                           "engines",
+                           parser->access_fs);
+    if (output != NULL &&
+        ibus_component_parse_markup (&exec_parser, output, -1, exec)) {
+        parser->engines = g_list_concat (exec_parser.engines, parser->engines);
+        exec_parser.engines = NULL;
+        parser->engines_from_exec = TRUE;
+    }
+    component_parser_clear (&exec_parser);
+    g_free (output);
+
+    if (errput) {
+        g_warning ("Engines exec:%s is failed: %s", exec, errput);
+        g_free (errput);
+    }
+}
+
+static XMLNode *
+component_parser_push_node (ComponentParser *parser,
+                            const gchar     *element_name,
+                            const gchar    **attribute_names,
+                            const gchar    **attribute_values)
+{
+    XMLNode *parent = g_queue_peek_head (&parser->observed_nodes);
+    XMLNode *node = g_slice_new0 (XMLNode);
+    GArray *attributes;
+
+    node->name = g_strdup (element_name);
+    attributes = g_array_new (TRUE, TRUE, sizeof (gchar *));
+    while (*attribute_names != NULL && *attribute_values != NULL) {
+        gchar *p;
+        p = g_strdup (*attribute_names++);
+        g_array_append_val (attributes, p);
+        p = g_strdup (*attribute_values++);
+        g_array_append_val (attributes, p);
+    }
+    node->attributes = (gchar **) g_array_free (attributes, FALSE);
+
+    if (parent != NULL)
+        parent->sub_nodes = g_list_append (parent->sub_nodes, node);
+    g_queue_push_head (&parser->observed_nodes, node);
+    return node;
+}
+
+static void
+component_parser_start_field (ComponentParser *parser,
+                              const gchar     *element_name)
+{
+    parser->parent_state = parser->state;
+    parser->state = COMPONENT_PARSER_FIELD;
+    parser->field_name = g_strdup (element_name);
+}
+
+static void
+component_parser_start_skip (ComponentParser *parser)
+{
+    parser->parent_state = parser->state;
+    parser->state = COMPONENT_PARSER_SKIP;
+    parser->skip_depth = 1;
+}
+
+static void
+_component_start_element_cb (GMarkupParseContext *context,
+                             const gchar         *element_name,
+                             const gchar        **attribute_names,
+                             const gchar        **attribute_values,
+                             gpointer             user_data,
+                             GError             **error)
+{
+    ComponentParser *parser = (ComponentParser *) user_data;
+    guint i;
+
+    switch (parser->state) {
+    case COMPONENT_PARSER_ROOT:
+        if (g_strcmp0 (element_name, parser->root_name) != 0) {
+            g_set_error (error,
+                         G_MARKUP_ERROR,
+                         G_MARKUP_ERROR_INVALID_CONTENT,
+                         "The root element <%s> is not <%s>",
+                         element_name, parser->root_name);
+            return;
+        }
+        if (g_strcmp0 (element_name, "engines") == 0)
+            parser->state = COMPONENT_PARSER_ENGINES;
+        else
+            parser->state = COMPONENT_PARSER_COMPONENT;
+        break;
+    case COMPONENT_PARSER_COMPONENT:
+        if (g_strcmp0 (element_name, "engines") == 0) {
+            parser->state = COMPONENT_PARSER_ENGINES;
+            for (i = 0; attribute_names[i] != NULL; i++) {
+                if (g_strcmp0 (attribute_names[i], "exec") == 0) {
+                    component_parser_run_exec (parser, attribute_values[i]);
+                    break;
+                }
+            }
+        } else if (g_strcmp0 (element_name, "observed-paths") == 0) {
+            parser->state = COMPONENT_PARSER_OBSERVED_PATHS;
+            component_parser_push_node (parser,
+                                        element_name,
+                                        attribute_names,
+                                        attribute_values);
+        } else {
+            component_parser_start_field (parser, element_name);
+        }
+        break;
+    case COMPONENT_PARSER_ENGINES:
+        if (parser->engines_from_exec ||
+            g_strcmp0 (element_name, "engine") != 0) {
+            component_parser_start_skip (parser);
+            break;
+        }
+        parser->state = COMPONENT_PARSER_ENGINE;
+        parser->engine = (IBusEngineDesc *) g_object_new (IBUS_TYPE_ENGINE_DESC,
+                                                          NULL);
+        break;
+    case COMPONENT_PARSER_ENGINE:
+        component_parser_start_field (parser, element_name);
+        break;
+    case COMPONENT_PARSER_FIELD:
+        g_set_error (error,
+                     G_MARKUP_ERROR,
+                     G_MARKUP_ERROR_INVALID_CONTENT,
+                     "<%s> element contains element <%s>",
+                     parser->field_name, element_name);
+        break;
+    case COMPONENT_PARSER_OBSERVED_PATHS:
+        component_parser_push_node (parser,
+                                    element_name,
+                                    attribute_names,
+                                    attribute_values);
+        break;
+    case COMPONENT_PARSER_SKIP:
+        parser->skip_depth++;
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static void
+_component_end_element_cb (GMarkupParseContext *context,
+                           const gchar         *element_name,
+                           gpointer             user_data,
+                           GError             **error)
+{
+    ComponentParser *parser = (ComponentParser *) user_data;
+    const gchar *text;
+    XMLNode *node;
+
+    switch (parser->state) {
+    case COMPONENT_PARSER_COMPONENT:
+        parser->state = COMPONENT_PARSER_ROOT;
+        break;
+    case COMPONENT_PARSER_ENGINES:
+        parser->engines_from_exec = FALSE;
+        if (g_strcmp0 (parser->root_name, "engines") == 0)
+            parser->state = COMPONENT_PARSER_ROOT;
+        else
+            parser->state = COMPONENT_PARSER_COMPONENT;
+        break;
+    case COMPONENT_PARSER_ENGINE:
+        parser->engines = g_list_prepend (parser->engines, parser->engine);
+        parser->engine = NULL;
+        parser->state = COMPONENT_PARSER_ENGINES;
+        break;
+    case COMPONENT_PARSER_FIELD:
+        text = parser->text ? parser->text->str : "";
+        if (parser->parent_state == COMPONENT_PARSER_ENGINE) {
+            _ibus_engine_desc_set_xml_field (parser->engine,
+                                             parser->field_name,
+                                             text);
+        } else {
+            ibus_component_set_xml_field (parser->component,
+                                          parser->field_name,
+                                          text);
+        }
+        g_clear_pointer (&parser->field_name, g_free);
+        if (parser->text != NULL) {
+            g_string_free (parser->text, TRUE);
+            parser->text = NULL;
+        }
+        parser->state = parser->parent_state;
+        break;
+    case COMPONENT_PARSER_OBSERVED_PATHS:
+        node = (XMLNode *) g_queue_pop_head (&parser->observed_nodes);
+        if (node->text == NULL && node->sub_nodes == NULL)
+            node->text = g_strdup ("");
+        if (g_queue_is_empty (&parser->observed_nodes)) {
+            ibus_component_parse_observed_paths (parser->component,
+                                                 node,
+                                                 parser->access_fs);
+            ibus_xml_free (node);
+            parser->state = COMPONENT_PARSER_COMPONENT;
+        }
+        break;
+    case COMPONENT_PARSER_SKIP:
+        if (--parser->skip_depth == 0)
+            parser->state = parser->parent_state;
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static void
+_component_text_cb (GMarkupParseContext *context,
+                    const gchar         *text,
+                    gsize                text_len,
+                    gpointer             user_data,
+                    GError             **error)
+{
+    ComponentParser *parser = (ComponentParser *) user_data;
+    XMLNode *node;
+    gsize i;
+
+    for (i = 0; i < text_len; i++) {
+        if (!g_ascii_isspace (text[i]))
+            break;
+    }
+    if (i == text_len)
+        return;
+
+    switch (parser->state) {
+    case COMPONENT_PARSER_FIELD:
+        if (parser->text == NULL)
+            parser->text = g_string_new_len (text, text_len);
+        else
+            g_string_append_len (parser->text, text, text_len);
+        break;
+    case COMPONENT_PARSER_OBSERVED_PATHS:
+        node = (XMLNode *) g_queue_peek_head (&parser->observed_nodes);
+        if (node->sub_nodes || node->text) {
+            g_set_error (error,
+                         G_MARKUP_ERROR,
+                         G_MARKUP_ERROR_INVALID_CONTENT,
+                         "<%s> element contains mixed content",
+                         node->name);
+            return;
+        }
+        node->text = g_strndup (text, text_len);
+        break;
+    default:
+        break;
+    }
+}
+
+static const GMarkupParser component_markup_parser = {
+    _component_start_element_cb,
+    _component_end_element_cb,
+    _component_text_cb,
+    NULL,
+    NULL,
+};
+
+static gboolean
+ibus_component_parse_markup (ComponentParser *parser,
+                             const gchar     *text,
+                             gssize           text_len,
+                             const gchar     *source)
+{
+    GMarkupParseContext *context;
+    GError *error = NULL;
+    gboolean retval;
+
+    context = g_markup_parse_context_new (&component_markup_parser,
+                                          0,
+                                          parser,
+                                          NULL);
+    retval = g_markup_parse_context_parse (context, text, text_len, &error) &&
+             g_markup_parse_context_end_parse (context, &error);
+    if (!retval) {
+        g_warning ("Parse %s failed: %s", source, error->message);
+        g_error_free (error);
+    }
+    g_markup_parse_context_free (context);
+    return retval;
+}
+
 #define IBUS_COMPONENT_GET_PROPERTY(property, return_type)  \
 return_type                                                 \
 ibus_component_get_ ## property (IBusComponent *component)  \
@@ -769,9 +1161,12 @@ ibus_component_new_from_file (const gchar *filename)
 {
     g_assert (filename);
 
-    XMLNode *node;
     struct stat buf;
+    gchar *contents = NULL;
+    gsize length = 0;
     IBusComponent *component;
+    ComponentParser parser;
+    GList *p;
     gboolean retval;
 
     if (g_stat (filename, &buf) != 0) {
@@ -779,15 +1174,23 @@ ibus_component_new_from_file (const gchar *filename)
         return NULL;
     }
 
-    node = ibus_xml_parse_file (filename);
-
-    if (!node) {
+    if (!g_file_get_contents (filename, &contents, &length, NULL)) {
         return NULL;
     }
 
     component = (IBusComponent *)g_object_new (IBUS_TYPE_COMPONENT, NULL);
-    retval = ibus_component_parse_xml_node (component, node, TRUE);
-    ibus_xml_free (node);
+    component_parser_init (&parser, component, "component", TRUE);
+    retval = ibus_component_parse_markup (&parser, contents, length, filename);
+    g_free (contents);
+
+    if (retval) {
+        parser.engines = g_list_reverse (parser.engines);
+        for (p = parser.engines; p != NULL; p = p->next)
+            ibus_component_add_engine (component, (IBusEngineDesc *) p->data);
+        g_list_free (parser.engines);
+        parser.engines = NULL;
+    }
+    component_parser_clear (&parser);
 
     if (!retval) {
         g_object_unref (component);
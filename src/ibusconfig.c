@@ -39,6 +39,27 @@ enum {
 struct _IBusConfigPrivate {
     GArray *watch_rules;
     guint watch_config_signal_id;
+    /* TRUE while the ValueChanged signals of all sections are watched. */
+    gboolean watch_all;
+    /* a map from a section name to an IBusConfigCacheSection, or NULL
+     * if the cache is disabled. */
+    GHashTable *cache;
+};
+
+typedef struct _IBusConfigCacheSection IBusConfigCacheSection;
+struct _IBusConfigCacheSection {
+    /* a map from an option name to its GVariant value. */
+    GHashTable *values;
+    /* the "a{sv}" returned by GetValues, or NULL if the section is not
+     * fully loaded. */
+    GVariant *all;
+};
+
+typedef struct _IBusConfigCacheCall IBusConfigCacheCall;
+struct _IBusConfigCacheCall {
+    gchar *section;
+    /* NULL for GetValues. */
+    gchar *name;
 };
 
 static guint    config_signals[LAST_SIGNAL] = { 0 };
@@ -64,6 +85,18 @@ static void      _signal_unsubscribe        (GDBusProxy         *proxy,
 
 static void      _remove_all_match_rules    (IBusConfig         *config);
 
+static GVariant *_cache_lookup              (IBusConfig         *config,
+                                             const gchar        *section,
+                                             const gchar        *name);
+static void      _cache_insert              (IBusConfig         *config,
+                                             const gchar        *section,
+                                             const gchar        *name,
+                                             GVariant           *value);
+static void      _cache_invalidate          (IBusConfig         *config,
+                                             const gchar        *section,
+                                             const gchar        *name);
+static void      _cache_clear               (IBusConfig         *config);
+
 G_DEFINE_TYPE_WITH_CODE (IBusConfig, ibus_config, IBUS_TYPE_PROXY,
                          G_ADD_PRIVATE (IBusConfig)
                          G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE, initable_iface_init)
@@ -105,11 +138,22 @@ ibus_config_class_init (IBusConfigClass *class)
             G_TYPE_VARIANT | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
+static void
+_name_owner_notify_cb (IBusConfig *config,
+                       GParamSpec *pspec,
+                       gpointer    user_data)
+{
+    _cache_clear (config);
+}
+
 static void
 ibus_config_init (IBusConfig *config)
 {
     config->priv = IBUS_CONFIG_GET_PRIVATE (config);
     config->priv->watch_rules = g_array_new (FALSE, FALSE, sizeof (gchar *));
+    /* values cached from the previous owner are not valid anymore. */
+    g_signal_connect (config, "notify::g-name-owner",
+                      G_CALLBACK (_name_owner_notify_cb), NULL);
 }
 
 static void
@@ -120,6 +164,10 @@ ibus_config_real_destroy (IBusProxy *proxy)
     _signal_unsubscribe (G_DBUS_PROXY (proxy), priv->watch_config_signal_id);
     _remove_all_match_rules (IBUS_CONFIG (proxy));
     g_array_free (priv->watch_rules, FALSE);
+    if (priv->cache != NULL) {
+        g_hash_table_destroy (priv->cache);
+        priv->cache = NULL;
+    }
 
     IBUS_PROXY_CLASS(ibus_config_parent_class)->destroy (proxy);
 }
@@ -138,6 +186,7 @@ ibus_config_g_signal (GDBusProxy  *proxy,
 
         g_variant_get (parameters, "(&s&sv)", &section, &name, &value);
 
+        _cache_invalidate ((IBusConfig *) proxy, section, name);
         g_signal_emit (proxy,
                        config_signals[VALUE_CHANGED],
                        0,
@@ -168,6 +217,229 @@ _connection_signal_cb (GDBusConnection *connection,
                           parameters);
 }
 
+static void
+_cache_section_free (IBusConfigCacheSection *cache_section)
+{
+    g_hash_table_destroy (cache_section->values);
+    if (cache_section->all != NULL)
+        g_variant_unref (cache_section->all);
+    g_slice_free (IBusConfigCacheSection, cache_section);
+}
+
+static IBusConfigCacheCall *
+_cache_call_new (const gchar *section,
+                 const gchar *name)
+{
+    IBusConfigCacheCall *call = g_slice_new (IBusConfigCacheCall);
+    call->section = g_strdup (section);
+    call->name = g_strdup (name);
+    return call;
+}
+
+static void
+_cache_call_free (IBusConfigCacheCall *call)
+{
+    g_free (call->section);
+    g_free (call->name);
+    g_slice_free (IBusConfigCacheCall, call);
+}
+
+/* A cached value is dropped only by a ValueChanged signal, so values of
+ * a section are cached only while the signals of the section are
+ * delivered to this client. */
+static gboolean
+_cache_is_watched (IBusConfig  *config,
+                   const gchar *section)
+{
+    IBusConfigPrivate *priv = config->priv;
+    gchar *rule;
+    gboolean retval = FALSE;
+    gint i;
+
+    if (priv->watch_all)
+        return TRUE;
+
+    rule = _make_match_rule (section, NULL);
+    for (i = 0; i < priv->watch_rules->len; i++) {
+        if (g_strcmp0 (g_array_index (priv->watch_rules, gchar *, i),
+                       rule) == 0) {
+            retval = TRUE;
+            break;
+        }
+    }
+    g_free (rule);
+    return retval;
+}
+
+/* Returns a new reference of the cached value, or the cached "a{sv}" of
+ * @section if @name is NULL. */
+static GVariant *
+_cache_lookup (IBusConfig  *config,
+               const gchar *section,
+               const gchar *name)
+{
+    IBusConfigCacheSection *cache_section;
+    GVariant *value;
+
+    if (config->priv->cache == NULL)
+        return NULL;
+
+    cache_section = g_hash_table_lookup (config->priv->cache, section);
+    if (cache_section == NULL)
+        return NULL;
+
+    if (name == NULL)
+        value = cache_section->all;
+    else
+        value = g_hash_table_lookup (cache_section->values, name);
+    return value != NULL ? g_variant_ref (value) : NULL;
+}
+
+/* Caches @value of @name, or all values of @section if @name is NULL. */
+static void
+_cache_insert (IBusConfig  *config,
+               const gchar *section,
+               const gchar *name,
+               GVariant    *value)
+{
+    IBusConfigCacheSection *cache_section;
+
+    if (config->priv->cache == NULL || !_cache_is_watched (config, section))
+        return;
+
+    cache_section = g_hash_table_lookup (config->priv->cache, section);
+    if (cache_section == NULL) {
+        cache_section = g_slice_new0 (IBusConfigCacheSection);
+        cache_section->values =
+                g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free,
+                                       (GDestroyNotify) g_variant_unref);
+        g_hash_table_insert (config->priv->cache,
+                             g_strdup (section),
+                             cache_section);
+    }
+
+    if (name != NULL) {
+        g_hash_table_replace (cache_section->values,
+                              g_strdup (name),
+                              g_variant_ref (value));
+        return;
+    }
+
+    GVariantIter iter;
+    const gchar *key;
+    GVariant *child;
+
+    if (cache_section->all != NULL)
+        g_variant_unref (cache_section->all);
+    cache_section->all = g_variant_ref (value);
+    g_hash_table_remove_all (cache_section->values);
+    g_variant_iter_init (&iter, value);
+    while (g_variant_iter_next (&iter, "{&sv}", &key, &child)) {
+        g_hash_table_replace (cache_section->values, g_strdup (key), child);
+    }
+}
+
+/* Drops the cached value of @name, or all values of @section if @name is
+ * NULL. */
+static void
+_cache_invalidate (IBusConfig  *config,
+                   const gchar *section,
+                   const gchar *name)
+{
+    IBusConfigCacheSection *cache_section;
+
+    if (config->priv->cache == NULL)
+        return;
+
+    if (name == NULL) {
+        g_hash_table_remove (config->priv->cache, section);
+        return;
+    }
+
+    cache_section = g_hash_table_lookup (config->priv->cache, section);
+    if (cache_section == NULL)
+        return;
+    g_hash_table_remove (cache_section->values, name);
+    if (cache_section->all != NULL) {
+        g_variant_unref (cache_section->all);
+        cache_section->all = NULL;
+    }
+}
+
+static void
+_cache_clear (IBusConfig *config)
+{
+    if (config->priv->cache != NULL)
+        g_hash_table_remove_all (config->priv->cache);
+}
+
+static void
+_cache_call_done (GDBusProxy   *proxy,
+                  GAsyncResult *res,
+                  GTask        *task)
+{
+    IBusConfigCacheCall *call = g_task_get_task_data (task);
+    GError *error = NULL;
+    GVariant *retval;
+    GVariant *value = NULL;
+
+    retval = g_dbus_proxy_call_finish (proxy, res, &error);
+    if (retval == NULL) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    if (call->name != NULL)
+        g_variant_get (retval, "(v)", &value);
+    else
+        g_variant_get (retval, "(@a{sv})", &value);
+    g_variant_unref (retval);
+
+    _cache_insert ((IBusConfig *) proxy, call->section, call->name, value);
+    g_task_return_pointer (task, value, (GDestroyNotify) g_variant_unref);
+    g_object_unref (task);
+}
+
+/* Calls GetValue, or GetValues if @name is NULL, through the cache. */
+static void
+_cache_call_async (IBusConfig         *config,
+                   const gchar        *section,
+                   const gchar        *name,
+                   gint                timeout_ms,
+                   GCancellable       *cancellable,
+                   GAsyncReadyCallback callback,
+                   gpointer            user_data,
+                   gpointer            source_tag)
+{
+    GTask *task;
+    GVariant *value;
+
+    task = g_task_new (config, cancellable, callback, user_data);
+    g_task_set_source_tag (task, source_tag);
+
+    value = _cache_lookup (config, section, name);
+    if (value != NULL) {
+        g_task_return_pointer (task, value, (GDestroyNotify) g_variant_unref);
+        g_object_unref (task);
+        return;
+    }
+
+    g_task_set_task_data (task,
+                          _cache_call_new (section, name),
+                          (GDestroyNotify) _cache_call_free);
+    g_dbus_proxy_call ((GDBusProxy *) config,
+                       name != NULL ? "GetValue" : "GetValues",
+                       name != NULL ? g_variant_new ("(ss)", section, name)
+                                    : g_variant_new ("(s)", section),
+                       G_DBUS_CALL_FLAGS_NONE,
+                       timeout_ms,
+                       cancellable,
+                       (GAsyncReadyCallback) _cache_call_done,
+                       task);
+}
+
 static gchar *
 _make_match_rule (const gchar *section,
                   const gchar *name)
@@ -219,6 +491,7 @@ ibus_config_watch (IBusConfig  *config,
         g_object_unref (bus);
         g_free (rule);
 
+        config->priv->watch_all = retval;
         return retval;
     }
 
@@ -230,6 +503,9 @@ ibus_config_watch (IBusConfig  *config,
             g_object_unref (bus);
             return FALSE;
         }
+        /* changes of the other sections are not notified anymore. */
+        config->priv->watch_all = FALSE;
+        _cache_clear (config);
     }
 
     rule = _make_match_rule (section, name);
@@ -258,6 +534,10 @@ ibus_config_unwatch (IBusConfig  *config,
 
     retval = ibus_bus_remove_match (bus, rule);
     g_object_unref (bus);
+    if (retval && section == NULL) {
+        config->priv->watch_all = FALSE;
+        _cache_clear (config);
+    }
     if (retval && (section != NULL || name != NULL)) {
         /* Remove the previously registered match rule from
            config->priv->watch_rules. */
@@ -272,6 +552,7 @@ ibus_config_unwatch (IBusConfig  *config,
                 break;
             }
         }
+        _cache_invalidate (config, section, NULL);
     }
     g_free (rule);
 
@@ -400,6 +681,10 @@ ibus_config_get_value (IBusConfig  *config,
     g_assert (section != NULL);
     g_assert (name != NULL);
 
+    GVariant *value = _cache_lookup (config, section, name);
+    if (value != NULL)
+        return value;
+
     GError *error = NULL;
     GVariant *result;
     result = g_dbus_proxy_call_sync ((GDBusProxy *) config,
@@ -417,9 +702,9 @@ ibus_config_get_value (IBusConfig  *config,
         return NULL;
     }
 
-    GVariant *value = NULL;
     g_variant_get (result, "(v)", &value);
     g_variant_unref (result);
+    _cache_insert (config, section, name, value);
 
     return value;
 }
@@ -437,6 +722,12 @@ ibus_config_get_value_async (IBusConfig         *config,
     g_assert (section != NULL);
     g_assert (name != NULL);
 
+    if (config->priv->cache != NULL) {
+        _cache_call_async (config, section, name, timeout_ms, cancellable,
+                           callback, user_data, ibus_config_get_value_async);
+        return;
+    }
+
     g_dbus_proxy_call ((GDBusProxy *)config,
                        "GetValue",
                        g_variant_new ("(ss)", section, name),
@@ -456,6 +747,9 @@ ibus_config_get_value_async_finish (IBusConfig    *config,
     g_assert (G_IS_ASYNC_RESULT (result));
     g_assert (error == NULL || *error == NULL);
 
+    if (g_async_result_is_tagged (result, ibus_config_get_value_async))
+        return g_task_propagate_pointer (G_TASK (result), error);
+
     GVariant *value = NULL;
     GVariant *retval = g_dbus_proxy_call_finish ((GDBusProxy *)config,
                                                  result,
@@ -475,6 +769,10 @@ ibus_config_get_values (IBusConfig  *config,
     g_assert (IBUS_IS_CONFIG (config));
     g_assert (section != NULL);
 
+    GVariant *value = _cache_lookup (config, section, NULL);
+    if (value != NULL)
+        return value;
+
     GError *error = NULL;
     GVariant *result;
     result = g_dbus_proxy_call_sync ((GDBusProxy *) config,
@@ -490,9 +788,9 @@ ibus_config_get_values (IBusConfig  *config,
         return NULL;
     }
 
-    GVariant *value = NULL;
     g_variant_get (result, "(@a{sv})", &value);
     g_variant_unref (result);
+    _cache_insert (config, section, NULL, value);
 
     return value;
 }
@@ -508,6 +806,12 @@ ibus_config_get_values_async (IBusConfig         *config,
     g_assert (IBUS_IS_CONFIG (config));
     g_assert (section != NULL);
 
+    if (config->priv->cache != NULL) {
+        _cache_call_async (config, section, NULL, timeout_ms, cancellable,
+                           callback, user_data, ibus_config_get_values_async);
+        return;
+    }
+
     g_dbus_proxy_call ((GDBusProxy *)config,
                        "GetValues",
                        g_variant_new ("(s)", section),
@@ -527,6 +831,9 @@ ibus_config_get_values_async_finish (IBusConfig    *config,
     g_assert (G_IS_ASYNC_RESULT (result));
     g_assert (error == NULL || *error == NULL);
 
+    if (g_async_result_is_tagged (result, ibus_config_get_values_async))
+        return g_task_propagate_pointer (G_TASK (result), error);
+
     GVariant *value = NULL;
     GVariant *retval = g_dbus_proxy_call_finish ((GDBusProxy *)config,
                                                  result,
@@ -550,6 +857,8 @@ ibus_config_set_value (IBusConfig   *config,
     g_assert (name != NULL);
     g_assert (value != NULL);
 
+    _cache_invalidate (config, section, name);
+
     GError *error = NULL;
     GVariant *result;
     result = g_dbus_proxy_call_sync ((GDBusProxy *) config,
@@ -585,6 +894,8 @@ ibus_config_set_value_async (IBusConfig         *config,
     g_assert (name != NULL);
     g_assert (value != NULL);
 
+    _cache_invalidate (config, section, name);
+
     g_dbus_proxy_call ((GDBusProxy *) config,
                        "SetValue",                /* method_name */
                        g_variant_new ("(ssv)",
@@ -625,6 +936,8 @@ ibus_config_unset (IBusConfig   *config,
     g_assert (section != NULL);
     g_assert (name != NULL);
 
+    _cache_invalidate (config, section, name);
+
     GError *error = NULL;
     GVariant *result;
     result = g_dbus_proxy_call_sync ((GDBusProxy *) config,
@@ -645,6 +958,32 @@ ibus_config_unset (IBusConfig   *config,
     return TRUE;
 }
 
+void
+ibus_config_set_cache_enabled (IBusConfig *config,
+                               gboolean    enabled)
+{
+    g_return_if_fail (IBUS_IS_CONFIG (config));
+
+    if (enabled && config->priv->cache == NULL) {
+        config->priv->cache =
+                g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free,
+                                       (GDestroyNotify) _cache_section_free);
+    }
+    else if (!enabled && config->priv->cache != NULL) {
+        g_hash_table_destroy (config->priv->cache);
+        config->priv->cache = NULL;
+    }
+}
+
+gboolean
+ibus_config_get_cache_enabled (IBusConfig *config)
+{
+    g_return_val_if_fail (IBUS_IS_CONFIG (config), FALSE);
+
+    return config->priv->cache != NULL;
+}
+
 static guint
 _signal_subscribe (GDBusProxy *proxy)
 {
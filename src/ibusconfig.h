@@ -362,6 +362,45 @@ gboolean         ibus_config_unwatch    (IBusConfig         *config,
 
 /* FIXME add an asynchronous version of unwatch */
 
+/**
+ * ibus_config_set_cache_enabled:
+ * @config: An #IBusConfig
+ * @enabled: %TRUE to cache the configuration values.
+ *
+ * Enable or disable the read-through cache of @config.
+ *
+ * While the cache is enabled, values read by ibus_config_get_value(),
+ * ibus_config_get_values() and their asynchronous versions are kept in
+ * @config and later reads are answered without a D-Bus round trip.
+ * Reading a whole section with ibus_config_get_values() fills the cache of
+ * every option in the section.  A cached value is dropped when the
+ * #IBusConfig::value-changed signal of it is received, or when it is set
+ * or unset through @config, so only the sections watched with
+ * ibus_config_watch() are cached.
+ *
+ * Disabling the cache drops all cached values.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void             ibus_config_set_cache_enabled
+                                        (IBusConfig         *config,
+                                         gboolean            enabled);
+
+/**
+ * ibus_config_get_cache_enabled:
+ * @config: An #IBusConfig
+ *
+ * Returns: %TRUE if the read-through cache of @config is enabled.
+ *
+ * See also: ibus_config_set_cache_enabled().
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+gboolean         ibus_config_get_cache_enabled
+                                        (IBusConfig         *config);
+
 G_END_DECLS
 #endif
 
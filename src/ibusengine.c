@@ -90,6 +90,27 @@ struct _IBusEnginePrivate {
     gchar                 *current_extension_name;
     gboolean               has_focus_id;
     gboolean               has_active_surrounding_text;
+
+    /* key events passed to process_key_event_async, in the received
+     * order. The lock protects them from ibus_engine_process_key_event_return
+     * in worker threads. */
+    GMutex                 key_event_lock;
+    GQueue                 pending_key_events;
+    guint                  key_event_id;
+    GSource               *flush_key_events_source;
+};
+
+typedef struct _IBusPendingKeyEvent IBusPendingKeyEvent;
+struct _IBusPendingKeyEvent {
+    GDBusMethodInvocation *invocation;
+    /* the thread-default main context which dispatched the method call. */
+    GMainContext          *context;
+    guint                  id;
+    guint                  keyval;
+    guint                  keycode;
+    guint                  state;
+    gboolean               completed;
+    gboolean               handled;
 };
 
 
@@ -196,10 +217,13 @@ static void      ibus_engine_set_content_type
 static void      ibus_engine_emit_signal     (IBusEngine         *engine,
                                               const gchar        *signal_name,
                                               GVariant           *parameters);
+static GVariant *ibus_engine_serialize       (IBusEngine         *engine,
+                                              gpointer            object);
 static void      ibus_engine_dbus_property_changed
                                              (IBusEngine         *engine,
                                               const gchar        *property_name,
                                               GVariant           *value);
+static void      ibus_pending_key_event_free (IBusPendingKeyEvent *event);
 
 
 G_DEFINE_TYPE_WITH_PRIVATE (IBusEngine, ibus_engine, IBUS_TYPE_SERVICE)
@@ -1003,6 +1027,8 @@ ibus_engine_init (IBusEngine *engine)
             g_str_equal,
             g_free,
             g_free);
+    g_mutex_init (&priv->key_event_lock);
+    g_queue_init (&priv->pending_key_events);
 }
 
 
@@ -1026,6 +1052,24 @@ ibus_engine_destroy (IBusEngine *engine)
     if (priv->extension_keybindings)
         g_clear_pointer (&priv->extension_keybindings, g_hash_table_destroy);
 
+    /* the key events which are not completed yet are not handled. */
+    g_mutex_lock (&priv->key_event_lock);
+    GSource *flush_key_events_source = priv->flush_key_events_source;
+    priv->flush_key_events_source = NULL;
+    while (!g_queue_is_empty (&priv->pending_key_events)) {
+        IBusPendingKeyEvent *event =
+                g_queue_pop_head (&priv->pending_key_events);
+        g_dbus_method_invocation_return_value (event->invocation,
+                                               g_variant_new ("(b)",
+                                                              event->handled));
+        ibus_pending_key_event_free (event);
+    }
+    g_mutex_unlock (&priv->key_event_lock);
+    if (flush_key_events_source != NULL) {
+        g_source_destroy (flush_key_events_source);
+        g_source_unref (flush_key_events_source);
+    }
+
     IBUS_OBJECT_CLASS(ibus_engine_parent_class)->destroy (IBUS_OBJECT (engine));
 }
 
@@ -1099,8 +1143,7 @@ ibus_engine_panel_extension (IBusEngine  *engine,
             "is-enabled", priv->enable_extension,
             NULL);
     g_assert (IBUS_IS_EXTENSION_EVENT (event));
-    data = ibus_serializable_serialize_object (
-            IBUS_SERIALIZABLE (event));
+    data = ibus_engine_serialize (engine, event);
 
     g_assert (data != NULL);
     ibus_engine_emit_signal (engine,
@@ -1270,6 +1313,85 @@ ibus_engine_service_panel_extension_register_keys (IBusEngine      *engine,
 }
 
 
+static void
+ibus_pending_key_event_free (IBusPendingKeyEvent *event)
+{
+    g_main_context_unref (event->context);
+    g_slice_free (IBusPendingKeyEvent, event);
+}
+
+/**
+ * ibus_engine_flush_key_events:
+ *
+ * Reply the completed key events at the head of the pending queue in the
+ * main context of the method calls, so the replies keep the order of the
+ * key events.
+ */
+static gboolean
+ibus_engine_flush_key_events (IBusEngine *engine)
+{
+    IBusEnginePrivate *priv = engine->priv;
+
+    g_mutex_lock (&priv->key_event_lock);
+    /* the dispatched source is still referred by the main context. */
+    g_clear_pointer (&priv->flush_key_events_source, g_source_unref);
+    while (!g_queue_is_empty (&priv->pending_key_events)) {
+        IBusPendingKeyEvent *event =
+                g_queue_peek_head (&priv->pending_key_events);
+        if (!event->completed)
+            break;
+        g_queue_pop_head (&priv->pending_key_events);
+        g_mutex_unlock (&priv->key_event_lock);
+
+        gboolean retval = event->handled;
+        if (!retval) {
+            retval = ibus_engine_filter_key_event (engine,
+                                                   event->keyval,
+                                                   event->keycode,
+                                                   event->state);
+        }
+        g_dbus_method_invocation_return_value (event->invocation,
+                                               g_variant_new ("(b)", retval));
+        ibus_pending_key_event_free (event);
+
+        g_mutex_lock (&priv->key_event_lock);
+    }
+    g_mutex_unlock (&priv->key_event_lock);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+ibus_engine_service_process_key_event_async (IBusEngine            *engine,
+                                             guint                  keyval,
+                                             guint                  keycode,
+                                             guint                  state,
+                                             GDBusMethodInvocation *invocation)
+{
+    IBusEnginePrivate *priv = engine->priv;
+    IBusPendingKeyEvent *event = g_slice_new0 (IBusPendingKeyEvent);
+    guint id;
+
+    event->invocation = invocation;
+    event->context = g_main_context_ref_thread_default ();
+    event->keyval = keyval;
+    event->keycode = keycode;
+    event->state = state;
+
+    g_mutex_lock (&priv->key_event_lock);
+    /* 0 is not used as an id. */
+    if (++priv->key_event_id == 0)
+        ++priv->key_event_id;
+    id = event->id = priv->key_event_id;
+    g_queue_push_tail (&priv->pending_key_events, event);
+    g_mutex_unlock (&priv->key_event_lock);
+
+    IBUS_ENGINE_GET_CLASS (engine)->process_key_event_async (engine,
+                                                             keyval,
+                                                             keycode,
+                                                             state,
+                                                             id);
+}
+
 static void
 ibus_engine_service_method_call (IBusService           *service,
                                  GDBusConnection       *connection,
@@ -1320,6 +1442,14 @@ ibus_engine_service_method_call (IBusService           *service,
         gboolean retval = FALSE;
 
         g_variant_get (parameters, "(uuu)", &keyval, &keycode, &state);
+        if (IBUS_ENGINE_GET_CLASS (engine)->process_key_event_async) {
+            ibus_engine_service_process_key_event_async (engine,
+                                                         keyval,
+                                                         keycode,
+                                                         state,
+                                                         invocation);
+            return;
+        }
         g_signal_emit (engine,
                        engine_signals[PROCESS_KEY_EVENT],
                        0,
@@ -1880,6 +2010,15 @@ ibus_engine_set_content_type (IBusEngine *engine,
 }
 
 
+static GVariant *
+ibus_engine_serialize (IBusEngine *engine,
+                       gpointer    object)
+{
+    return _ibus_serializable_serialize_for_connection (
+            (IBusSerializable *)object,
+            ibus_service_get_connection ((IBusService *)engine));
+}
+
 static void
 ibus_engine_emit_signal (IBusEngine  *engine,
                          const gchar *signal_name,
@@ -1985,7 +2124,7 @@ ibus_engine_commit_text (IBusEngine *engine,
     g_return_if_fail (IBUS_IS_ENGINE (engine));
     g_return_if_fail (IBUS_IS_TEXT (text));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    GVariant *variant = ibus_engine_serialize (engine, text);
     ibus_engine_emit_signal (engine,
                              "CommitText",
                              g_variant_new ("(v)", variant));
@@ -2015,7 +2154,7 @@ ibus_engine_update_preedit_text_with_mode (IBusEngine            *engine,
     g_return_if_fail (IBUS_IS_ENGINE (engine));
     g_return_if_fail (IBUS_IS_TEXT (text));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    GVariant *variant = ibus_engine_serialize (engine, text);
     ibus_engine_emit_signal (engine,
                              "UpdatePreeditText",
                              g_variant_new ("(vubu)",
@@ -2035,7 +2174,7 @@ void ibus_engine_update_auxiliary_text (IBusEngine      *engine,
     g_return_if_fail (IBUS_IS_ENGINE (engine));
     g_return_if_fail (IBUS_IS_TEXT (text));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    GVariant *variant = ibus_engine_serialize (engine, text);
     ibus_engine_emit_signal (engine,
                              "UpdateAuxiliaryText",
                              g_variant_new ("(vb)", variant, visible));
@@ -2052,7 +2191,7 @@ ibus_engine_update_lookup_table (IBusEngine        *engine,
     g_return_if_fail (IBUS_IS_ENGINE (engine));
     g_return_if_fail (IBUS_IS_LOOKUP_TABLE (table));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable *)table);
+    GVariant *variant = ibus_engine_serialize (engine, table);
     ibus_engine_emit_signal (engine,
                              "UpdateLookupTable",
                              g_variant_new ("(vb)", variant, visible));
@@ -2079,7 +2218,8 @@ ibus_engine_update_lookup_table_fast (IBusEngine        *engine,
     gint cursor_pos;
     gint i;
 
-    if (table->candidates->len < table->page_size << 2) {
+    if (ibus_lookup_table_get_number_of_candidates (table) <
+        table->page_size << 2) {
         ibus_engine_update_lookup_table (engine, table, visible);
         return;
     }
@@ -2235,8 +2375,7 @@ ibus_engine_register_properties (IBusEngine   *engine,
     g_return_if_fail (IBUS_IS_ENGINE (engine));
     g_return_if_fail (IBUS_IS_PROP_LIST (prop_list));
 
-    GVariant *variant = ibus_serializable_serialize (
-            (IBusSerializable *)prop_list);
+    GVariant *variant = ibus_engine_serialize (engine, prop_list);
     ibus_engine_emit_signal (engine,
                              "RegisterProperties",
                              g_variant_new ("(v)", variant));
@@ -2252,7 +2391,7 @@ ibus_engine_update_property (IBusEngine   *engine,
     g_return_if_fail (IBUS_IS_ENGINE (engine));
     g_return_if_fail (IBUS_IS_PROPERTY (prop));
 
-    GVariant *variant = ibus_serializable_serialize ((IBusSerializable *)prop);
+    GVariant *variant = ibus_engine_serialize (engine, prop);
     ibus_engine_emit_signal (engine,
                              "UpdateProperty",
                              g_variant_new ("(v)", variant));
@@ -2286,6 +2425,28 @@ ibus_engine_get_name (IBusEngine *engine)
     return engine->priv->engine_name;
 }
 
+void
+_ibus_engine_recycle (IBusEngine *engine)
+{
+    IBusEnginePrivate *priv;
+
+    g_return_if_fail (IBUS_IS_ENGINE (engine));
+
+    priv = engine->priv;
+    /* ibus-daemon only calls ReleaseEngine and the engine could still have
+     * the focus and the preedit of the previous input context. */
+    g_signal_emit (engine, engine_signals[FOCUS_OUT], 0);
+    g_signal_emit (engine, engine_signals[RESET], 0);
+    g_signal_emit (engine, engine_signals[DISABLE], 0);
+
+    engine->client_capabilities = 0;
+    ibus_engine_set_surrounding_text (engine, NULL, 0, 0);
+    priv->content_purpose = 0;
+    priv->content_hints = 0;
+    priv->enable_extension = FALSE;
+    g_clear_pointer (&priv->current_extension_name, g_free);
+}
+
 
 void
 ibus_engine_send_message (IBusEngine  *engine,
@@ -2295,9 +2456,51 @@ ibus_engine_send_message (IBusEngine  *engine,
 
     g_return_if_fail (IBUS_IS_ENGINE (engine));
     g_return_if_fail (IBUS_IS_MESSAGE (message));
-    variant = ibus_serializable_serialize ((IBusSerializable *)message);
+    variant = ibus_engine_serialize (engine, message);
     ibus_engine_emit_signal (engine,
                              "SendMessage",
                               g_variant_new ("(v)", variant));
     _g_object_unref_if_floating (message);
 }
+
+void
+ibus_engine_process_key_event_return (IBusEngine *engine,
+                                      guint       id,
+                                      gboolean    handled)
+{
+    IBusEnginePrivate *priv;
+    GList *p;
+    gboolean flush = FALSE;
+
+    g_return_if_fail (IBUS_IS_ENGINE (engine));
+
+    priv = engine->priv;
+    g_mutex_lock (&priv->key_event_lock);
+    for (p = priv->pending_key_events.head; p != NULL; p = p->next) {
+        IBusPendingKeyEvent *event = p->data;
+        if (event->id != id)
+            continue;
+        event->completed = TRUE;
+        event->handled = handled;
+        flush = (p == priv->pending_key_events.head);
+        break;
+    }
+    /* the pending key events are replied when the engine is destroyed. */
+    if (p == NULL && !IBUS_OBJECT_DESTROYED (engine))
+        g_warning ("%s: Unknown key event id %u", G_STRFUNC, id);
+    if (flush && priv->flush_key_events_source == NULL) {
+        IBusPendingKeyEvent *event =
+                g_queue_peek_head (&priv->pending_key_events);
+        GSource *source = g_idle_source_new ();
+        g_source_set_priority (source, G_PRIORITY_HIGH_IDLE);
+        g_source_set_callback (source,
+                               (GSourceFunc) ibus_engine_flush_key_events,
+                               g_object_ref (engine),
+                               (GDestroyNotify) g_object_unref);
+        /* reply in the main context which dispatched the method call
+         * instead of the global default main context. */
+        g_source_attach (source, event->context);
+        priv->flush_key_events_source = source;
+    }
+    g_mutex_unlock (&priv->key_event_lock);
+}
@@ -181,10 +181,16 @@ struct _IBusEngineClass {
                                      const gchar    *client);
     void        (* focus_out_id)    (IBusEngine     *engine,
                                      const gchar    *object_path);
+    void        (* process_key_event_async)
+                                    (IBusEngine     *engine,
+                                     guint           keyval,
+                                     guint           keycode,
+                                     guint           state,
+                                     guint           id);
 
     /*< private >*/
     /* padding */
-    gpointer pdummy[2];
+    gpointer pdummy[1];
 };
 
 GType        ibus_engine_get_type       (void);
@@ -504,5 +510,29 @@ const gchar *ibus_engine_get_name       (IBusEngine         *engine);
  */
 void         ibus_engine_send_message   (IBusEngine         *engine,
                                          IBusMessage        *message);
+
+/**
+ * ibus_engine_process_key_event_return:
+ * @engine: An #IBusEngine.
+ * @id: The key event id given to #IBusEngineClass.process_key_event_async().
+ * @handled: %TRUE if the engine processed the key event.
+ *
+ * Complete a key event which is passed to
+ * #IBusEngineClass.process_key_event_async(). The engine must call this
+ * once for each @id. This function is thread safe and can be called from
+ * a worker thread. The replies are sent to the client in the order of the
+ * key events even if the engine completes them in a different order, from
+ * the thread-default main context which received the key events.
+ *
+ * If a subclass implements #IBusEngineClass.process_key_event_async(),
+ * #IBusEngine::process-key-event is not emitted.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void         ibus_engine_process_key_event_return
+                                        (IBusEngine         *engine,
+                                         guint               id,
+                                         gboolean            handled);
 G_END_DECLS
 #endif
@@ -705,6 +705,45 @@ ibus_engine_desc_output (IBusEngineDesc *desc,
     g_string_append (output, "</engine>\n");
 }
 
+gboolean
+_ibus_engine_desc_set_xml_field (IBusEngineDesc *desc,
+                                 const gchar    *element_name,
+                                 const gchar    *text)
+{
+#define PARSE_ENTRY(field_name, name)                           \
+    if (g_strcmp0 (element_name, name) == 0) {                  \
+        g_free (desc->priv->field_name);                        \
+        desc->priv->field_name = g_strdup (text);               \
+        return TRUE;                                            \
+    }
+#define PARSE_ENTRY_1(name) PARSE_ENTRY(name, #name)
+    PARSE_ENTRY_1(name);
+    PARSE_ENTRY_1(longname);
+    PARSE_ENTRY_1(description);
+    PARSE_ENTRY_1(language);
+    PARSE_ENTRY_1(license);
+    PARSE_ENTRY_1(author);
+    PARSE_ENTRY_1(icon);
+    PARSE_ENTRY_1(layout);
+    PARSE_ENTRY_1(layout_variant);
+    PARSE_ENTRY_1(layout_option);
+    PARSE_ENTRY_1(hotkeys);
+    PARSE_ENTRY_1(symbol);
+    PARSE_ENTRY_1(setup);
+    PARSE_ENTRY_1(version);
+    PARSE_ENTRY_1(textdomain);
+    PARSE_ENTRY_1(icon_prop_key);
+#undef PARSE_ENTRY
+#undef PARSE_ENTRY_1
+    if (g_strcmp0 (element_name, "rank") == 0) {
+        desc->priv->rank = text ? atoi (text) : 0;
+        return TRUE;
+    }
+    g_warning ("<engines> element contains invalidate element <%s>",
+               element_name);
+    return FALSE;
+}
+
 static gboolean
 ibus_engine_desc_parse_xml_node (IBusEngineDesc *desc,
                                 XMLNode       *node)
@@ -713,37 +752,7 @@ ibus_engine_desc_parse_xml_node (IBusEngineDesc *desc,
 
     for (p = node->sub_nodes; p != NULL; p = p->next) {
         XMLNode *sub_node = (XMLNode *) p->data;
-
-#define PARSE_ENTRY(field_name, element_name)                   \
-        if (g_strcmp0 (sub_node->name, element_name) == 0) {    \
-            g_free (desc->priv->field_name);                    \
-            desc->priv->field_name = g_strdup (sub_node->text); \
-            continue;                                           \
-        }
-#define PARSE_ENTRY_1(name) PARSE_ENTRY(name, #name)
-        PARSE_ENTRY_1(name);
-        PARSE_ENTRY_1(longname);
-        PARSE_ENTRY_1(description);
-        PARSE_ENTRY_1(language);
-        PARSE_ENTRY_1(license);
-        PARSE_ENTRY_1(author);
-        PARSE_ENTRY_1(icon);
-        PARSE_ENTRY_1(layout);
-        PARSE_ENTRY_1(layout_variant);
-        PARSE_ENTRY_1(layout_option);
-        PARSE_ENTRY_1(hotkeys);
-        PARSE_ENTRY_1(symbol);
-        PARSE_ENTRY_1(setup);
-        PARSE_ENTRY_1(version);
-        PARSE_ENTRY_1(textdomain);
-        PARSE_ENTRY_1(icon_prop_key);
-#undef PARSE_ENTRY
-#undef PARSE_ENTRY_1
-        if (g_strcmp0 (sub_node->name , "rank") == 0) {
-            desc->priv->rank = atoi (sub_node->text);
-            continue;
-        }
-        g_warning ("<engines> element contains invalidate element <%s>", sub_node->name);
+        _ibus_engine_desc_set_xml_field (desc, sub_node->name, sub_node->text);
     }
     return TRUE;
 }
@@ -434,6 +434,33 @@ ibus_engine_simple_commit_str (IBusEngineSimple *simple,
 }
 
 
+/* Reuse the last preedit text if nobody else refers it so that each key
+ * does not create new IBusText and IBusAttribute objects.
+ */
+static IBusText *
+ibus_engine_simple_new_preedit_text (IBusEngineSimple *simple,
+                                     const gchar      *str,
+                                     guint             len)
+{
+    IBusEngineSimplePrivate *priv = simple->priv;
+    IBusText *text = priv->updated_preedit;
+
+    if (text != updated_preedit_empty && G_OBJECT (text)->ref_count == 1) {
+        ibus_text_set_string (text, str);
+        g_object_ref (text);
+    } else {
+        text = ibus_text_new_from_string (str);
+        g_object_ref_sink (text);
+    }
+    ibus_text_append_attribute (text,
+                                IBUS_ATTR_TYPE_UNDERLINE,
+                                IBUS_ATTR_UNDERLINE_SINGLE,
+                                0,
+                                len);
+    return text;
+}
+
+
 static void
 ibus_engine_simple_update_preedit_text (IBusEngineSimple *simple)
 {
@@ -456,11 +483,9 @@ ibus_engine_simple_update_preedit_text (IBusEngineSimple *simple)
             );
         }
     } else if (priv->tentative_emoji && *priv->tentative_emoji) {
-        IBusText *text = ibus_text_new_from_string (priv->tentative_emoji);
         int len = strlen (priv->tentative_emoji);
-        ibus_text_append_attribute (text,
-                IBUS_ATTR_TYPE_UNDERLINE, IBUS_ATTR_UNDERLINE_SINGLE, 0, len);
-        g_object_ref_sink (text);
+        IBusText *text = ibus_engine_simple_new_preedit_text (
+                simple, priv->tentative_emoji, len);
         ibus_engine_update_preedit_text ((IBusEngine *)simple, text, len, TRUE);
         g_object_unref (priv->updated_preedit);
         priv->updated_preedit = text;
@@ -590,13 +615,9 @@ ibus_engine_simple_update_preedit_text (IBusEngineSimple *simple)
         g_warning ("%s is too long compose length: %lu", s->str, s->len);
     } else {
         guint len = (guint)g_utf8_strlen (s->str, -1);
-        IBusText *text = ibus_text_new_from_string (s->str);
-        ibus_text_append_attribute (text,
-                                    IBUS_ATTR_TYPE_UNDERLINE,
-                                    IBUS_ATTR_UNDERLINE_SINGLE,
-                                    0,
-                                    len);
-        g_object_ref_sink (text);
+        IBusText *text = ibus_engine_simple_new_preedit_text (simple,
+                                                              s->str,
+                                                              len);
         /* gnome-shell does not handle "SendMessageReceived" D-Bus method yet.
          * Seems other Wayland desktops do not implement xdg-system-bell
          * Wayland protocol yet.
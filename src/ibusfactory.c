@@ -42,6 +42,13 @@ struct _IBusFactoryPrivate {
     guint id;
     GList          *engine_list;
     GHashTable     *engine_table;
+    /* the maximum number of idle engines kept for each engine name. */
+    guint           engine_pool_size;
+    /* a map from an engine name to a GQueue of the idle engines. */
+    GHashTable     *engine_pool;
+    /* engine names whose pools should be filled in an idle callback. */
+    GHashTable     *engine_pool_refill;
+    guint           engine_pool_refill_id;
 };
 
 static guint            factory_signals[LAST_SIGNAL] = { 0 };
@@ -96,6 +103,9 @@ static const gchar introspection_xml[] =
     "      <arg direction='in'  type='s' name='name' />"
     "      <arg direction='out' type='o' />"
     "    </method>"
+    "    <method name='ReleaseEngine'>"
+    "      <arg direction='in'  type='o' name='object_path' />"
+    "    </method>"
     "  </interface>"
     "</node>";
 
@@ -192,6 +202,16 @@ ibus_factory_init (IBusFactory *factory)
                                g_str_equal,
                                g_free,
                                NULL);
+    factory->priv->engine_pool =
+        g_hash_table_new_full (g_str_hash,
+                               g_str_equal,
+                               g_free,
+                               (GDestroyNotify) g_queue_free);
+    factory->priv->engine_pool_refill =
+        g_hash_table_new_full (g_str_hash,
+                               g_str_equal,
+                               g_free,
+                               NULL);
 }
 
 static void
@@ -199,6 +219,11 @@ ibus_factory_destroy (IBusFactory *factory)
 {
     GList *list;
 
+    if (factory->priv->engine_pool_refill_id != 0) {
+        g_source_remove (factory->priv->engine_pool_refill_id);
+        factory->priv->engine_pool_refill_id = 0;
+    }
+
     list = g_list_copy (factory->priv->engine_list);
     g_list_free_full (list, (GDestroyNotify)ibus_object_destroy);
     g_list_free(factory->priv->engine_list);
@@ -206,6 +231,15 @@ ibus_factory_destroy (IBusFactory *factory)
 
     if (factory->priv->engine_table) {
         g_hash_table_destroy (factory->priv->engine_table);
+        factory->priv->engine_table = NULL;
+    }
+    if (factory->priv->engine_pool) {
+        g_hash_table_destroy (factory->priv->engine_pool);
+        factory->priv->engine_pool = NULL;
+    }
+    if (factory->priv->engine_pool_refill) {
+        g_hash_table_destroy (factory->priv->engine_pool_refill);
+        factory->priv->engine_pool_refill = NULL;
     }
 
     IBUS_OBJECT_CLASS(ibus_factory_parent_class)->destroy (IBUS_OBJECT (factory));
@@ -239,10 +273,141 @@ static void
 ibus_factory_engine_destroy_cb (IBusEngine  *engine,
                                 IBusFactory *factory)
 {
+    const gchar *engine_name = ibus_engine_get_name (engine);
+    GQueue *pool = NULL;
+
+    /* an engine without the name is never pooled. */
+    if (factory->priv->engine_pool != NULL && engine_name != NULL)
+        pool = g_hash_table_lookup (factory->priv->engine_pool, engine_name);
+    if (pool != NULL)
+        g_queue_remove (pool, engine);
+
     factory->priv->engine_list = g_list_remove (factory->priv->engine_list, engine);
     g_object_unref (engine);
 }
 
+/**
+ * ibus_factory_add_engine_instance:
+ *
+ * Keep the new engine in engine_list until it is destroyed.
+ */
+static void
+ibus_factory_add_engine_instance (IBusFactory *factory,
+                                  IBusEngine  *engine)
+{
+    g_object_ref_sink (engine);
+    factory->priv->engine_list = g_list_append (factory->priv->engine_list, engine);
+    g_signal_connect (engine,
+                      "destroy",
+                      G_CALLBACK (ibus_factory_engine_destroy_cb),
+                      factory);
+}
+
+static GQueue *
+ibus_factory_get_engine_pool (IBusFactory *factory,
+                              const gchar *engine_name)
+{
+    GQueue *pool = g_hash_table_lookup (factory->priv->engine_pool,
+                                        engine_name);
+    if (pool == NULL) {
+        pool = g_queue_new ();
+        g_hash_table_insert (factory->priv->engine_pool,
+                             g_strdup (engine_name),
+                             pool);
+    }
+    return pool;
+}
+
+static gboolean
+ibus_factory_refill_engine_pool_cb (IBusFactory *factory)
+{
+    GHashTableIter iter;
+    gpointer key;
+
+    factory->priv->engine_pool_refill_id = 0;
+
+    g_hash_table_iter_init (&iter, factory->priv->engine_pool_refill);
+    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+        const gchar *engine_name = (const gchar *) key;
+        GQueue *pool = ibus_factory_get_engine_pool (factory, engine_name);
+
+        while (pool->length < factory->priv->engine_pool_size) {
+            IBusEngine *engine = NULL;
+            g_signal_emit (factory, factory_signals[CREATE_ENGINE],
+                           0, engine_name, &engine);
+            if (engine == NULL)
+                break;
+            ibus_factory_add_engine_instance (factory, engine);
+            /* CreateEngine could not find it in the pool. */
+            if (g_strcmp0 (ibus_engine_get_name (engine), engine_name) != 0) {
+                ibus_object_destroy ((IBusObject *) engine);
+                break;
+            }
+            g_queue_push_tail (pool, engine);
+        }
+    }
+    g_hash_table_remove_all (factory->priv->engine_pool_refill);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Create the spare engines of @engine_name in the background. */
+static void
+ibus_factory_refill_engine_pool (IBusFactory *factory,
+                                 const gchar *engine_name)
+{
+    if (factory->priv->engine_pool_size == 0)
+        return;
+
+    g_hash_table_add (factory->priv->engine_pool_refill,
+                      g_strdup (engine_name));
+    if (factory->priv->engine_pool_refill_id == 0) {
+        factory->priv->engine_pool_refill_id =
+                g_idle_add_full (G_PRIORITY_LOW,
+                                 (GSourceFunc) ibus_factory_refill_engine_pool_cb,
+                                 factory,
+                                 NULL);
+    }
+}
+
+static void
+ibus_factory_release_engine (IBusFactory *factory,
+                             const gchar *object_path)
+{
+    GList *p;
+    IBusEngine *engine = NULL;
+    const gchar *engine_name;
+    GQueue *pool;
+
+    for (p = factory->priv->engine_list; p != NULL; p = p->next) {
+        if (g_strcmp0 (ibus_service_get_object_path ((IBusService *) p->data),
+                       object_path) == 0) {
+            engine = (IBusEngine *) p->data;
+            break;
+        }
+    }
+    if (engine == NULL)
+        return;
+
+    /* CreateEngine looks up the pool with the engine name. */
+    engine_name = ibus_engine_get_name (engine);
+    if (engine_name == NULL || factory->priv->engine_pool_size == 0) {
+        ibus_object_destroy ((IBusObject *) engine);
+        return;
+    }
+
+    pool = ibus_factory_get_engine_pool (factory, engine_name);
+    if (g_queue_find (pool, engine) != NULL)
+        return;
+    if (pool->length >= factory->priv->engine_pool_size) {
+        ibus_object_destroy ((IBusObject *) engine);
+        return;
+    }
+
+    _ibus_engine_recycle (engine);
+    g_queue_push_tail (pool, engine);
+}
+
 static void
 ibus_factory_service_method_call (IBusService           *service,
                                   GDBusConnection       *connection,
@@ -258,8 +423,22 @@ ibus_factory_service_method_call (IBusService           *service,
     if (g_strcmp0 (method_name, "CreateEngine") == 0) {
         gchar *engine_name = NULL;
         IBusEngine *engine = NULL;
+        GQueue *pool;
 
         g_variant_get (parameters, "(&s)", &engine_name);
+        pool = g_hash_table_lookup (factory->priv->engine_pool, engine_name);
+        if (pool != NULL && !g_queue_is_empty (pool)) {
+            /* the pooled engine is registered and reset already. */
+            engine = (IBusEngine *) g_queue_pop_head (pool);
+            g_dbus_method_invocation_return_value (
+                    invocation,
+                    g_variant_new ("(o)",
+                                   ibus_service_get_object_path (
+                                           (IBusService *) engine)));
+            ibus_factory_refill_engine_pool (factory, engine_name);
+            return;
+        }
+
         g_signal_emit (factory, factory_signals[CREATE_ENGINE],
                        0, engine_name, &engine);
 
@@ -274,15 +453,11 @@ ibus_factory_service_method_call (IBusService           *service,
 
             g_assert (engine != NULL);
             g_assert (object_path != NULL);
-            g_object_ref_sink (engine);
-            factory->priv->engine_list = g_list_append (factory->priv->engine_list, engine);
-            g_signal_connect (engine,
-                              "destroy",
-                              G_CALLBACK (ibus_factory_engine_destroy_cb),
-                              factory);
+            ibus_factory_add_engine_instance (factory, engine);
             g_dbus_method_invocation_return_value (invocation,
                                                    g_variant_new ("(o)", object_path));
             g_free (object_path);
+            ibus_factory_refill_engine_pool (factory, engine_name);
         }
         else {
             g_dbus_method_invocation_return_error (invocation,
@@ -294,6 +469,15 @@ ibus_factory_service_method_call (IBusService           *service,
         return;
     }
 
+    if (g_strcmp0 (method_name, "ReleaseEngine") == 0) {
+        const gchar *path = NULL;
+
+        g_variant_get (parameters, "(&o)", &path);
+        g_dbus_method_invocation_return_value (invocation, NULL);
+        ibus_factory_release_engine (factory, path);
+        return;
+    }
+
     IBUS_SERVICE_CLASS (ibus_factory_parent_class)->
             service_method_call (service,
                                  connection,
@@ -383,3 +567,33 @@ ibus_factory_create_engine (IBusFactory    *factory,
 
     return engine;
 }
+
+void
+ibus_factory_set_engine_pool_size (IBusFactory *factory,
+                                   guint        size)
+{
+    GHashTableIter iter;
+    gpointer value;
+
+    g_return_if_fail (IBUS_IS_FACTORY (factory));
+
+    factory->priv->engine_pool_size = size;
+
+    /* destroy the idle engines over the new size. */
+    g_hash_table_iter_init (&iter, factory->priv->engine_pool);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        GQueue *pool = (GQueue *) value;
+        while (pool->length > size) {
+            IBusEngine *engine = (IBusEngine *) g_queue_pop_tail (pool);
+            ibus_object_destroy ((IBusObject *) engine);
+        }
+    }
+}
+
+guint
+ibus_factory_get_engine_pool_size (IBusFactory *factory)
+{
+    g_return_val_if_fail (IBUS_IS_FACTORY (factory), 0);
+
+    return factory->priv->engine_pool_size;
+}
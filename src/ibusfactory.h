@@ -183,6 +183,42 @@ void             ibus_factory_add_engine        (IBusFactory    *factory,
 IBusEngine      *ibus_factory_create_engine     (IBusFactory    *factory,
                                                  const gchar    *engine_name);
 
+/**
+ * ibus_factory_set_engine_pool_size:
+ * @factory: An #IBusFactory.
+ * @size: The number of idle engines kept for each engine name.
+ *
+ * Keep up to @size idle engines of each engine name registered on the
+ * D-Bus connection. An engine released by ibus-daemon is reset, disabled
+ * and put in the pool instead of being destroyed, and the next
+ * CreateEngine call of the same engine name returns it without creating
+ * a new #IBusEngine. After an engine is taken, the pool is filled again
+ * with new engines in a low priority idle callback.
+ *
+ * An engine which keeps its own state across input contexts should
+ * reset it in its #IBusEngine::reset or #IBusEngine::disable handler
+ * before enabling the pool. 0, the default, disables the pool and
+ * destroys the idle engines.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void             ibus_factory_set_engine_pool_size
+                                                (IBusFactory    *factory,
+                                                 guint           size);
+
+/**
+ * ibus_factory_get_engine_pool_size:
+ * @factory: An #IBusFactory.
+ *
+ * Returns: The number of idle engines kept for each engine name.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+guint            ibus_factory_get_engine_pool_size
+                                                (IBusFactory    *factory);
+
 G_END_DECLS
 #endif
 
@@ -1230,7 +1230,10 @@ ibus_input_context_set_surrounding_text (IBusInputContext   *context,
 
         if (priv->needs_surrounding_text) {
             GVariant *variant =
-                    ibus_serializable_serialize ((IBusSerializable *)text);
+                    _ibus_serializable_serialize_for_connection (
+                            (IBusSerializable *)text,
+                            g_dbus_proxy_get_connection (
+                                    (GDBusProxy *)context));
             g_dbus_proxy_call ((GDBusProxy *) context,
                                "SetSurroundingText",        /* method_name */
                                g_variant_new ("(vuu)",
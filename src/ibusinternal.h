@@ -28,6 +28,7 @@
 #define __IBUS_INTERNEL_H_
 
 #include <glib.h>
+#include <gio/gio.h>
 /**
  * I_:
  * @string: A string
@@ -62,6 +63,101 @@
 G_GNUC_INTERNAL void
 ibus_g_variant_get_child_string (GVariant *variant, gsize index, char **str);
 
+/**
+ * _ibus_cache_load:
+ * @filename: The cache file.
+ * @magic: The magic number of the cache.
+ * @version: The format version of the cache.
+ * @type: The #GVariantType of the body.
+ *
+ * Maps @filename, whose header is the big-endian @magic and @version,
+ * and the rest is a #GVariant of @type.
+ *
+ * Returns: (transfer full) (nullable): The body of the cache, or %NULL if
+ *     @filename does not exist, is truncated or has another header.
+ */
+G_GNUC_INTERNAL GVariant *
+_ibus_cache_load (const gchar        *filename,
+                  guint32             magic,
+                  guint32             version,
+                  const GVariantType *type);
+
+/**
+ * _ibus_cache_save:
+ * @filename: The cache file.
+ * @magic: The magic number of the cache.
+ * @version: The format version of the cache.
+ * @variant: The body of the cache.
+ *
+ * Writes @variant to @filename with the header for _ibus_cache_load().
+ */
+G_GNUC_INTERNAL void
+_ibus_cache_save (const gchar *filename,
+                  guint32      magic,
+                  guint32      version,
+                  GVariant    *variant);
+
+#ifdef __IBUS_SERIALIZABLE_H_
+/**
+ * _ibus_serializable_has_attachments:
+ *
+ * Returns: %TRUE if @serializable has any attachments.
+ */
+G_GNUC_INTERNAL gboolean
+_ibus_serializable_has_attachments (IBusSerializable *serializable);
+
+/**
+ * _ibus_serializable_set_connection_wire_version:
+ *
+ * Records the #IBusSerializableWireVersion negotiated with the peer of
+ * @connection.
+ */
+G_GNUC_INTERNAL void
+_ibus_serializable_set_connection_wire_version (GDBusConnection *connection,
+                                                guint            version);
+
+/**
+ * _ibus_serializable_serialize_for_connection:
+ *
+ * Same as ibus_serializable_serialize_object() but uses the
+ * #IBusSerializableWireVersion negotiated with the peer of @connection,
+ * or the default version of the process if it is not negotiated.
+ */
+G_GNUC_INTERNAL GVariant *
+_ibus_serializable_serialize_for_connection (IBusSerializable *serializable,
+                                             GDBusConnection  *connection);
+#endif
+
+#ifdef __IBUS_ENGINE_H_
+/**
+ * _ibus_engine_recycle:
+ * @engine: An #IBusEngine.
+ *
+ * Focus out, reset and disable @engine and drop the state cached from the
+ * previous input context, so that @engine can be reused for another one.
+ */
+G_GNUC_INTERNAL void
+_ibus_engine_recycle (IBusEngine *engine);
+#endif
+
+#ifdef __IBUS_ENGINE_DESC_H_
+/**
+ * _ibus_engine_desc_set_xml_field:
+ * @desc: An #IBusEngineDesc.
+ * @element_name: The name of a sub element of &lt;engine&gt;.
+ * @text: The text of the element.
+ *
+ * Set the field of @desc which is described by @element_name in a
+ * component XML file.
+ *
+ * Returns: %FALSE if @element_name is unknown.
+ */
+G_GNUC_INTERNAL gboolean
+_ibus_engine_desc_set_xml_field (IBusEngineDesc *desc,
+                                 const gchar    *element_name,
+                                 const gchar    *text);
+#endif
+
 #ifdef IBUS_KEY_dead_grave
 #ifdef IBUS_KEY_dead_longsolidusoverlay
 /* Checks if a keysym is a dead key. Dead key keysym values are defined in
@@ -28,12 +28,17 @@
 #include "ibuskeys.h"
 #include "ibuskeysyms.h"
 #include "ibuskeymap.h"
+#include "ibusinternal.h"
+
+#define KEYMAP_CACHE_MAGIC 0x4b4d4150 /* "KMAP" */
+#define KEYMAP_CACHE_VERSION 0x00000001
 
 typedef guint KEYMAP[256][7];
 /* functions prototype */
 static void         ibus_keymap_destroy         (IBusKeymap             *keymap);
 static gboolean     ibus_keymap_load            (const gchar            *name,
-                                                 KEYMAP                  keymap);
+                                                 KEYMAP                  keymap,
+                                                 GVariantBuilder        *sources);
 static GHashTable   *keymaps = NULL;
 
 G_DEFINE_TYPE (IBusKeymap, ibus_keymap, IBUS_TYPE_OBJECT)
@@ -70,8 +75,9 @@ ibus_keymap_destroy (IBusKeymap *keymap)
     while (*p == ' ') p++;
 
 static gboolean
-ibus_keymap_parse_line (gchar  *str,
-                        KEYMAP  keymap)
+ibus_keymap_parse_line (gchar           *str,
+                        KEYMAP           keymap,
+                        GVariantBuilder *sources)
 {
     gchar *p1, *p2, ch;
     gint i;
@@ -102,7 +108,7 @@ ibus_keymap_parse_line (gchar  *str,
         p1 += sizeof ("include ") - 1;
         for (p2 = p1; *p2 != '\n'; p2++);
         *p2 = '\0';
-        return ibus_keymap_load (p1, keymap);
+        return ibus_keymap_load (p1, keymap, sources);
     }
 
     for (i = 0; i < sizeof (prefix) / sizeof (prefix[0]); i++) {
@@ -157,36 +163,60 @@ ibus_keymap_parse_line (gchar  *str,
     return TRUE;
 }
 
-static gboolean
-ibus_keymap_load (const gchar *name,
-                  KEYMAP       keymap)
+static gchar *
+ibus_keymap_get_filename (const gchar *name)
 {
     const gchar *envstr;
+
+    if ((envstr = g_getenv ("IBUS_KEYMAP_PATH")) != NULL)
+        return g_build_filename (envstr, name, NULL);
+    return g_build_filename (IBUS_DATA_DIR, "keymaps", name, NULL);
+}
+
+/**
+ * ibus_keymap_load:
+ * @name: The name of the keymap file.
+ * @keymap: The table to be updated.
+ * @sources: (nullable): A "a(stt)" builder to which the file name, mtime
+ *     and size of @name and its included files are added.
+ *
+ * Parse the keymap text file of @name.
+ */
+static gboolean
+ibus_keymap_load (const gchar     *name,
+                  KEYMAP           keymap,
+                  GVariantBuilder *sources)
+{
     gchar *fname;
     FILE *pf;
     gchar buf[256];
     gint lineno;
+    GStatBuf stat_buf;
 
-
-    if ((envstr = g_getenv ("IBUS_KEYMAP_PATH")) != NULL)
-        fname = g_build_filename (envstr, name, NULL);
-    else
-        fname = g_build_filename (IBUS_DATA_DIR, "keymaps", name, NULL);
+    fname = ibus_keymap_get_filename (name);
 
     if (fname == NULL) {
         return FALSE;
     }
     pf = g_fopen (fname, "r");
-    g_free (fname);
 
     if (pf == NULL) {
+        g_free (fname);
         return FALSE;
     }
 
+    if (sources != NULL && g_stat (fname, &stat_buf) == 0) {
+        g_variant_builder_add (sources, "(stt)",
+                               fname,
+                               (guint64) stat_buf.st_mtime,
+                               (guint64) stat_buf.st_size);
+    }
+    g_free (fname);
+
     lineno = 0;
     while (fgets (buf, sizeof (buf), pf) != NULL) {
         lineno ++;
-        if (!ibus_keymap_parse_line (buf, keymap)) {
+        if (!ibus_keymap_parse_line (buf, keymap, sources)) {
             g_warning ("parse %s failed on %d line", name, lineno);
             lineno = -1;
             break;
@@ -229,6 +259,140 @@ ibus_keymap_fill (KEYMAP keymap)
     }
 }
 
+static gchar *
+ibus_keymap_get_cache_filename (const gchar *name)
+{
+    /* the name is also a part of the file name of the cache. */
+    if (*name == '\0' || *name == '.' || strchr (name, G_DIR_SEPARATOR))
+        return NULL;
+    return g_build_filename (g_get_user_cache_dir (),
+                             "ibus", "keymaps", name, NULL);
+}
+
+/**
+ * ibus_keymap_load_cache:
+ * @name: The name of the keymap.
+ * @keymap: The table to be filled.
+ *
+ * Map the compiled keymap of @name if none of its text files has been
+ * modified since it was compiled. The file header is the magic and the
+ * version, and the rest is a "(a(stt)au)" GVariant of the file names,
+ * mtimes and sizes of the text files and the filled table. The first text
+ * file is the file of @name.
+ */
+static gboolean
+ibus_keymap_load_cache (const gchar *name,
+                        KEYMAP       keymap)
+{
+    gchar *cachename = ibus_keymap_get_cache_filename (name);
+    gchar *fname;
+    GVariant *variant;
+    GVariantIter *iter;
+    const gchar *source = NULL;
+    guint64 mtime = 0, size = 0;
+    GVariant *table;
+    gconstpointer values;
+    gsize n_values = 0;
+    gboolean first = TRUE;
+    gboolean retval = TRUE;
+
+    if (cachename == NULL)
+        return FALSE;
+    variant = _ibus_cache_load (cachename,
+                                KEYMAP_CACHE_MAGIC,
+                                KEYMAP_CACHE_VERSION,
+                                G_VARIANT_TYPE ("(a(stt)au)"));
+    g_free (cachename);
+    if (variant == NULL)
+        return FALSE;
+
+    fname = ibus_keymap_get_filename (name);
+    g_variant_get (variant, "(a(stt)@au)", &iter, &table);
+    while (retval &&
+           g_variant_iter_next (iter, "(&stt)", &source, &mtime, &size)) {
+        GStatBuf stat_buf;
+
+        /* IBUS_KEYMAP_PATH could point to another directory. */
+        if (first && g_strcmp0 (source, fname) != 0)
+            retval = FALSE;
+        else if (g_stat (source, &stat_buf) != 0 ||
+                 mtime != (guint64) stat_buf.st_mtime ||
+                 size != (guint64) stat_buf.st_size)
+            retval = FALSE;
+        first = FALSE;
+    }
+    g_variant_iter_free (iter);
+    g_free (fname);
+
+    values = g_variant_get_fixed_array (table, &n_values, sizeof (guint32));
+    if (first || n_values != sizeof (KEYMAP) / sizeof (guint))
+        retval = FALSE;
+    if (retval)
+        memcpy (keymap, values, sizeof (KEYMAP));
+    g_variant_unref (table);
+    g_variant_unref (variant);
+
+    return retval;
+}
+
+static void
+ibus_keymap_save_cache (const gchar *name,
+                        KEYMAP       keymap,
+                        GVariant    *sources)
+{
+    gchar *cachename = ibus_keymap_get_cache_filename (name);
+    GVariant *variant;
+
+    if (cachename == NULL)
+        return;
+
+    variant = g_variant_new ("(@a(stt)@au)",
+                             sources,
+                             g_variant_new_fixed_array (
+                                     G_VARIANT_TYPE_UINT32,
+                                     keymap,
+                                     sizeof (KEYMAP) / sizeof (guint),
+                                     sizeof (guint32)));
+    _ibus_cache_save (cachename,
+                      KEYMAP_CACHE_MAGIC,
+                      KEYMAP_CACHE_VERSION,
+                      variant);
+    g_free (cachename);
+}
+
+/**
+ * ibus_keymap_load_and_fill:
+ * @name: The name of the keymap.
+ * @keymap: The table to be filled.
+ *
+ * Load the compiled keymap of @name, or parse its text files, fill the
+ * table and compile it for the next processes.
+ */
+static gboolean
+ibus_keymap_load_and_fill (const gchar *name,
+                           KEYMAP       keymap)
+{
+    GVariantBuilder sources;
+    GVariant *variant;
+
+    /* parsing the text files with the keysym names is slow and each engine
+     * process which uses keymaps does it on its startup. */
+    if (ibus_keymap_load_cache (name, keymap))
+        return TRUE;
+
+    g_variant_builder_init (&sources, G_VARIANT_TYPE ("a(stt)"));
+    if (!ibus_keymap_load (name, keymap, &sources)) {
+        g_variant_builder_clear (&sources);
+        return FALSE;
+    }
+    ibus_keymap_fill (keymap);
+
+    variant = g_variant_ref_sink (g_variant_builder_end (&sources));
+    ibus_keymap_save_cache (name, keymap, variant);
+    g_variant_unref (variant);
+    return TRUE;
+}
+
 static void
 _keymap_destroy_cb (IBusKeymap *keymap,
                     gpointer    user_data)
@@ -263,8 +427,7 @@ ibus_keymap_get (const gchar *name)
         keymap = g_object_new (IBUS_TYPE_KEYMAP, NULL);
         g_object_ref_sink (keymap);
 
-        if (ibus_keymap_load (name, keymap->keymap)) {
-            ibus_keymap_fill (keymap->keymap);
+        if (ibus_keymap_load_and_fill (name, keymap->keymap)) {
             keymap->name = g_strdup (name);
             g_hash_table_insert (keymaps, g_strdup (keymap->name), keymap);
 
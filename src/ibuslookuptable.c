@@ -20,6 +20,7 @@
  * USA
  */
 #include "ibuslookuptable.h"
+#include "ibusinternal.h"
 
 /* functions prototype */
 static void         ibus_lookup_table_destroy       (IBusLookupTable        *table);
@@ -80,6 +81,25 @@ ibus_lookup_table_destroy (IBusLookupTable *table)
     IBUS_OBJECT_CLASS (ibus_lookup_table_parent_class)->destroy ((IBusObject *) table);
 }
 
+/* Returns TRUE if the candidates can be serialized as "as" without losing
+ * the attributes, the attachments or the subclass type. */
+static gboolean
+ibus_lookup_table_is_packable (IBusLookupTable *table)
+{
+    guint i;
+
+    for (i = 0; i < table->candidates->len; i++) {
+        IBusText *text = g_array_index (table->candidates, IBusText *, i);
+        if (G_OBJECT_TYPE (text) != IBUS_TYPE_TEXT ||
+            (text->attrs != NULL &&
+             ibus_attr_list_get_n_attributes (text->attrs) > 0) ||
+            _ibus_serializable_has_attachments ((IBusSerializable *)text)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
 static gboolean
 ibus_lookup_table_serialize (IBusLookupTable *table,
                              GVariantBuilder *builder)
@@ -100,22 +120,31 @@ ibus_lookup_table_serialize (IBusLookupTable *table,
 
     GVariantBuilder array;
     /* append candidates */
-    g_variant_builder_init (&array, G_VARIANT_TYPE ("av"));
-    for (i = 0;; i++) {
-        IBusText *text = ibus_lookup_table_get_candidate (table, i);
-        if (text == NULL)
-            break;
-        /* Replaced g_variant_builder_add() with g_variant_builder_open() &
-         * g_variant_builder_close() to avoid creating temporary objects during
-         * serialization.
-         */
-        g_variant_builder_open (&array, G_VARIANT_TYPE_VARIANT);
-        g_variant_builder_add_value (
-                &array,
-                ibus_serializable_serialize ((IBusSerializable *)text));
-        g_variant_builder_close (&array);
+    if (ibus_serializable_get_wire_version () >=
+        IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_CANDIDATES &&
+        ibus_lookup_table_is_packable (table)) {
+        g_variant_builder_init (&array, G_VARIANT_TYPE_STRING_ARRAY);
+        for (i = 0; i < table->candidates->len; i++) {
+            IBusText *text = g_array_index (table->candidates, IBusText *, i);
+            g_variant_builder_add (&array, "s", text->text);
+        }
+        g_variant_builder_add (builder, "as", &array);
+    } else {
+        g_variant_builder_init (&array, G_VARIANT_TYPE ("av"));
+        for (i = 0; i < table->candidates->len; i++) {
+            IBusText *text = g_array_index (table->candidates, IBusText *, i);
+            /* Replaced g_variant_builder_add() with g_variant_builder_open() &
+             * g_variant_builder_close() to avoid creating temporary objects
+             * during serialization.
+             */
+            g_variant_builder_open (&array, G_VARIANT_TYPE_VARIANT);
+            g_variant_builder_add_value (
+                    &array,
+                    ibus_serializable_serialize ((IBusSerializable *)text));
+            g_variant_builder_close (&array);
+        }
+        g_variant_builder_add (builder, "av", &array);
     }
-    g_variant_builder_add (builder, "av", &array);
 
     /* append labels */
     g_variant_builder_init (&array, G_VARIANT_TYPE ("av"));
@@ -135,6 +164,38 @@ ibus_lookup_table_serialize (IBusLookupTable *table,
     return TRUE;
 }
 
+/* Returns TRUE if @variant is a serialized IBusAttrList without any
+ * attributes and attachments. */
+static gboolean
+_is_empty_attr_list (GVariant *variant)
+{
+    GVariant *child;
+    gboolean retval;
+
+    if (!g_variant_is_of_type (variant, G_VARIANT_TYPE_TUPLE) ||
+        g_variant_n_children (variant) != 3) {
+        return FALSE;
+    }
+    child = g_variant_get_child_value (variant, 0);
+    retval = g_variant_is_of_type (child, G_VARIANT_TYPE_STRING) &&
+             g_strcmp0 (g_variant_get_string (child, NULL),
+                        "IBusAttrList") == 0;
+    g_variant_unref (child);
+    if (!retval)
+        return FALSE;
+    child = g_variant_get_child_value (variant, 1);
+    retval = g_variant_is_of_type (child, G_VARIANT_TYPE ("a{sv}")) &&
+             g_variant_n_children (child) == 0;
+    g_variant_unref (child);
+    if (!retval)
+        return FALSE;
+    child = g_variant_get_child_value (variant, 2);
+    retval = g_variant_is_container (child) &&
+             g_variant_n_children (child) == 0;
+    g_variant_unref (child);
+    return retval;
+}
+
 static gint
 ibus_lookup_table_deserialize (IBusLookupTable *table,
                                GVariant        *variant)
@@ -153,13 +214,48 @@ ibus_lookup_table_deserialize (IBusLookupTable *table,
     g_variant_get_child (variant, retval++, "i", &table->orientation);
 
     GVariant *var;
-    // deserialize candidates
     GVariantIter *iter = NULL;
-    g_variant_get_child (variant, retval++, "av", &iter);
-    while (g_variant_iter_loop (iter, "v", &var)) {
-        ibus_lookup_table_append_candidate (table, IBUS_TEXT (ibus_serializable_deserialize (var)));
+    // deserialize candidates
+    GVariant *child = g_variant_get_child_value (variant, retval++);
+    if (g_variant_is_of_type (child, G_VARIANT_TYPE_STRING_ARRAY)) {
+        const gchar *candidate;
+
+        iter = g_variant_iter_new (child);
+        while (g_variant_iter_next (iter, "&s", &candidate)) {
+            ibus_lookup_table_append_candidate (
+                    table, ibus_text_new_from_string (candidate));
+        }
+        g_variant_iter_free (iter);
+    } else {
+        iter = g_variant_iter_new (child);
+        while (g_variant_iter_loop (iter, "v", &var)) {
+            const gchar *type_name = NULL;
+            const gchar *candidate = NULL;
+            GVariant *attachments = NULL;
+            GVariant *attrs = NULL;
+
+            /* Create a plain IBusText without looking up the GType. */
+            if (g_variant_is_of_type (var, G_VARIANT_TYPE ("(sa{sv}sv)"))) {
+                g_variant_get (var, "(&s@a{sv}&sv)", &type_name,
+                               &attachments, &candidate, &attrs);
+            }
+            if (attachments != NULL &&
+                g_variant_n_children (attachments) == 0 &&
+                g_strcmp0 (type_name, "IBusText") == 0 &&
+                _is_empty_attr_list (attrs)) {
+                ibus_lookup_table_append_candidate (
+                        table, ibus_text_new_from_string (candidate));
+            } else {
+                ibus_lookup_table_append_candidate (
+                        table,
+                        IBUS_TEXT (ibus_serializable_deserialize (var)));
+            }
+            g_clear_pointer (&attachments, g_variant_unref);
+            g_clear_pointer (&attrs, g_variant_unref);
+        }
+        g_variant_iter_free (iter);
     }
-    g_variant_iter_free (iter);
+    g_variant_unref (child);
 
     // deserialize labels
     iter = NULL;
@@ -255,6 +351,34 @@ ibus_lookup_table_append_candidate (IBusLookupTable *table,
     g_array_append_val (table->candidates, text);
 }
 
+void
+ibus_lookup_table_append_candidates (IBusLookupTable    *table,
+                                     const gchar* const *candidates,
+                                     gint                n_candidates)
+{
+    gint i;
+
+    g_return_if_fail (IBUS_IS_LOOKUP_TABLE (table));
+    g_return_if_fail (candidates != NULL || n_candidates == 0);
+
+    for (i = 0; n_candidates < 0 ? candidates[i] != NULL : i < n_candidates;
+         i++) {
+        ibus_lookup_table_append_candidate (
+                table, ibus_text_new_from_string (candidates[i]));
+    }
+}
+
+void
+ibus_lookup_table_set_candidates (IBusLookupTable    *table,
+                                  const gchar* const *candidates,
+                                  gint                n_candidates)
+{
+    g_return_if_fail (IBUS_IS_LOOKUP_TABLE (table));
+
+    ibus_lookup_table_clear (table);
+    ibus_lookup_table_append_candidates (table, candidates, n_candidates);
+}
+
 IBusText *
 ibus_lookup_table_get_candidate (IBusLookupTable *table,
                                  guint            index)
@@ -267,6 +391,27 @@ ibus_lookup_table_get_candidate (IBusLookupTable *table,
     return g_array_index (table->candidates, IBusText *, index);
 }
 
+GArray *
+ibus_lookup_table_get_candidates (IBusLookupTable *table)
+{
+    g_return_val_if_fail (IBUS_IS_LOOKUP_TABLE (table), NULL);
+
+    return table->candidates;
+}
+
+const gchar *
+ibus_lookup_table_get_candidate_string (IBusLookupTable *table,
+                                        guint            index)
+{
+    g_return_val_if_fail (IBUS_IS_LOOKUP_TABLE (table), NULL);
+
+    if (index >= table->candidates->len)
+        return NULL;
+
+    return ibus_text_get_text (
+            g_array_index (table->candidates, IBusText *, index));
+}
+
 void
 ibus_lookup_table_append_label (IBusLookupTable *table,
                                 IBusText        *text)
@@ -157,6 +157,74 @@ IBusText            *ibus_lookup_table_get_candidate
                                                 (IBusLookupTable    *table,
                                                  guint               index);
 
+/**
+ * ibus_lookup_table_get_candidates:
+ * @table: An IBusLookupTable.
+ *
+ * Returns the array of all the candidates, i.e. @table->candidates.
+ *
+ * Returns: (transfer none) (element-type IBusText): The candidates of
+ *         @table.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+GArray              *ibus_lookup_table_get_candidates
+                                                (IBusLookupTable    *table);
+
+/**
+ * ibus_lookup_table_get_candidate_string:
+ * @table: An IBusLookupTable.
+ * @index: Index in the Lookup table.
+ *
+ * Return the string of the candidate at the given index.
+ *
+ * Returns: (transfer none) (nullable): The string of the candidate at the
+ *         given index; %NULL if no such candidate.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+const gchar         *ibus_lookup_table_get_candidate_string
+                                                (IBusLookupTable    *table,
+                                                 guint               index);
+
+/**
+ * ibus_lookup_table_append_candidates:
+ * @table: An IBusLookupTable.
+ * @candidates: (array length=n_candidates): Candidate words/phrases.
+ * @n_candidates: The length of @candidates or -1 if @candidates is
+ *                %NULL-terminated.
+ *
+ * Append candidate words/phrases without attributes to IBusLookupTable.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void                 ibus_lookup_table_append_candidates
+                                                (IBusLookupTable    *table,
+                                                 const gchar* const *candidates,
+                                                 gint                n_candidates);
+
+/**
+ * ibus_lookup_table_set_candidates:
+ * @table: An IBusLookupTable.
+ * @candidates: (array length=n_candidates): Candidate words/phrases.
+ * @n_candidates: The length of @candidates or -1 if @candidates is
+ *                %NULL-terminated.
+ *
+ * Replace all the candidates of IBusLookupTable, e.g. with the candidates
+ * of the current page. Same as ibus_lookup_table_clear() and
+ * ibus_lookup_table_append_candidates().
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void                 ibus_lookup_table_set_candidates
+                                                (IBusLookupTable    *table,
+                                                 const gchar* const *candidates,
+                                                 gint                n_candidates);
+
 /**
  * ibus_lookup_table_append_label:
  * @table: An IBusLookupTable.
@@ -1720,6 +1720,15 @@ ibus_panel_service_property_hide (IBusPanelService *panel,
                               NULL);
 }
 
+static GVariant *
+ibus_panel_service_serialize (IBusPanelService *panel,
+                              gpointer          object)
+{
+    return _ibus_serializable_serialize_for_connection (
+            (IBusSerializable *)object,
+            ibus_service_get_connection ((IBusService *)panel));
+}
+
 void
 ibus_panel_service_commit_text (IBusPanelService *panel,
                                 IBusText         *text)
@@ -1728,7 +1737,7 @@ ibus_panel_service_commit_text (IBusPanelService *panel,
     g_return_if_fail (IBUS_IS_PANEL_SERVICE (panel));
     g_return_if_fail (IBUS_IS_TEXT (text));
 
-    variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    variant = ibus_panel_service_serialize (panel, text);
     ibus_service_emit_signal ((IBusService *)panel,
                               NULL,
                               IBUS_INTERFACE_PANEL,
@@ -1749,7 +1758,7 @@ ibus_panel_service_panel_extension (IBusPanelService   *panel,
     g_return_if_fail (IBUS_IS_PANEL_SERVICE (panel));
     g_return_if_fail (IBUS_IS_EXTENSION_EVENT (event));
 
-    variant = ibus_serializable_serialize ((IBusSerializable *)event);
+    variant = ibus_panel_service_serialize (panel, event);
     ibus_service_emit_signal ((IBusService *)panel,
                               NULL,
                               IBUS_INTERFACE_PANEL,
@@ -1823,7 +1832,7 @@ ibus_panel_service_update_preedit_text_received (IBusPanelService *panel,
     g_return_if_fail (IBUS_IS_PANEL_SERVICE (panel));
     g_return_if_fail (IBUS_IS_TEXT (text));
 
-    variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    variant = ibus_panel_service_serialize (panel, text);
     g_return_if_fail (variant);
     ibus_service_emit_signal ((IBusService *)panel,
                               NULL,
@@ -1847,7 +1856,7 @@ ibus_panel_service_update_auxiliary_text_received (IBusPanelService *panel,
     g_return_if_fail (IBUS_IS_PANEL_SERVICE (panel));
     g_return_if_fail (IBUS_IS_TEXT (text));
 
-    variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    variant = ibus_panel_service_serialize (panel, text);
     g_return_if_fail (variant);
     ibus_service_emit_signal ((IBusService *)panel,
                               NULL,
@@ -1872,7 +1881,7 @@ ibus_panel_service_update_lookup_table_received (IBusPanelService *panel,
     g_return_if_fail (IBUS_IS_PANEL_SERVICE (panel));
     g_return_if_fail (IBUS_IS_LOOKUP_TABLE (table));
 
-    variant = ibus_serializable_serialize ((IBusSerializable *)table);
+    variant = ibus_panel_service_serialize (panel, table);
     g_return_if_fail (variant);
     ibus_service_emit_signal ((IBusService *)panel,
                               NULL,
@@ -1912,7 +1921,7 @@ ibus_panel_service_send_message (IBusPanelService *panel,
 
     g_return_if_fail (IBUS_IS_PANEL_SERVICE (panel));
     g_return_if_fail (IBUS_IS_MESSAGE (message));
-    variant = ibus_serializable_serialize ((IBusSerializable *)message);
+    variant = ibus_panel_service_serialize (panel, message);
     ibus_service_emit_signal ((IBusService *)panel,
                               NULL,
                               IBUS_INTERFACE_PANEL,
@@ -535,6 +535,67 @@ ibus_registry_output (IBusRegistry *registry,
     g_string_append (output, "</ibus-registry>\n");
 }
 
+typedef struct {
+    GPtrArray *paths;
+    IBusComponent **components;
+} LoadComponentsData;
+
+static void
+_load_component_file_func (gpointer data,
+                           gpointer user_data)
+{
+    LoadComponentsData *load_data = (LoadComponentsData *) user_data;
+    guint i = GPOINTER_TO_UINT (data) - 1;
+    IBusComponent *component;
+
+    component = ibus_component_new_from_file (
+            (const gchar *) g_ptr_array_index (load_data->paths, i));
+    if (component != NULL)
+        g_object_ref_sink (component);
+    load_data->components[i] = component;
+}
+
+/*
+ * Parse the component files in @paths and return the array of the
+ * IBusComponent objects in the same order, or %NULL for the files which
+ * cannot be parsed. Only the components with the exec attribute of
+ * <engines> spawn processes, so the files are parsed on a thread pool to
+ * not wait for them one by one when the registry cache is invalid.
+ */
+static IBusComponent **
+ibus_registry_load_component_files (GPtrArray *paths)
+{
+    LoadComponentsData load_data;
+    GThreadPool *pool = NULL;
+    gint max_threads;
+    guint i;
+
+    load_data.paths = paths;
+    load_data.components = g_new0 (IBusComponent *, paths->len + 1);
+
+    max_threads = MIN (g_get_num_processors (), (gint) paths->len);
+    if (max_threads > 1) {
+        pool = g_thread_pool_new (_load_component_file_func,
+                                  &load_data,
+                                  max_threads,
+                                  FALSE,
+                                  NULL);
+    }
+
+    for (i = 0; i < paths->len; i++) {
+        /* the index is shifted by 1 because a NULL data is not allowed. */
+        if (pool == NULL ||
+            !g_thread_pool_push (pool, GUINT_TO_POINTER (i + 1), NULL)) {
+            _load_component_file_func (GUINT_TO_POINTER (i + 1), &load_data);
+        }
+    }
+
+    if (pool != NULL)
+        g_thread_pool_free (pool, FALSE, TRUE);
+
+    return load_data.components;
+}
+
 void
 ibus_registry_load_in_dir (IBusRegistry *registry,
                            const gchar  *dirname)
@@ -543,6 +604,9 @@ ibus_registry_load_in_dir (IBusRegistry *registry,
     GDir *dir;
     IBusObservedPath *observed_path = NULL;
     const gchar *filename;
+    GPtrArray *paths;
+    IBusComponent **components;
+    guint i;
 
     g_assert (IBUS_IS_REGISTRY (registry));
     g_assert (dirname);
@@ -561,27 +625,27 @@ ibus_registry_load_in_dir (IBusRegistry *registry,
             g_list_append (registry->priv->observed_paths,
                            observed_path);
 
+    paths = g_ptr_array_new_with_free_func (g_free);
     while ((filename = g_dir_read_name (dir)) != NULL) {
         glong size;
-        gchar *path;
-        IBusComponent *component;
 
         size = g_utf8_strlen (filename, -1);
         if (g_strcmp0 (MAX (filename, filename + size - 4), ".xml") != 0)
             continue;
 
-        path = g_build_filename (dirname, filename, NULL);
-        component = ibus_component_new_from_file (path);
-        if (component != NULL) {
-            g_object_ref_sink (component);
+        g_ptr_array_add (paths, g_build_filename (dirname, filename, NULL));
+    }
+    g_dir_close (dir);
+
+    components = ibus_registry_load_component_files (paths);
+    for (i = 0; i < paths->len; i++) {
+        if (components[i] != NULL) {
             registry->priv->components =
-                g_list_append (registry->priv->components, component);
+                g_list_append (registry->priv->components, components[i]);
         }
-
-        g_free (path);
     }
-
-    g_dir_close (dir);
+    g_free (components);
+    g_ptr_array_free (paths, TRUE);
 }
 
 
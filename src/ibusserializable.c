@@ -20,8 +20,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
  * USA
  */
-#include "ibusinternal.h"
 #include "ibusserializable.h"
+#include "ibusattribute.h"
+#include "ibusattrlist.h"
+#include "ibusinternal.h"
+#include "ibuslookuptable.h"
+#include "ibusproperty.h"
+#include "ibusproplist.h"
+#include "ibustext.h"
 
 #define IBUS_SERIALIZABLE_GET_PRIVATE(o)  \
    ((IBusSerializablePrivate *)ibus_serializable_get_instance_private (o))
@@ -34,6 +40,21 @@ struct _IBusSerializablePrivate {
     GData   *attachments;
 };
 
+/* The type tags of IBUS_SERIALIZABLE_WIRE_VERSION_COMPACT.
+ * TYPE_TAG_NAME means that the type name follows the tag.
+ * The values must not be changed since they are sent to other processes.
+ */
+enum {
+    TYPE_TAG_NAME = 0,
+    TYPE_TAG_TEXT,
+    TYPE_TAG_ATTRIBUTE,
+    TYPE_TAG_ATTR_LIST,
+    TYPE_TAG_LOOKUP_TABLE,
+    TYPE_TAG_PROPERTY,
+    TYPE_TAG_PROP_LIST,
+    TYPE_TAG_LAST
+};
+
 // static guint    object_signals[LAST_SIGNAL] = { 0 };
 
 /* functions prototype */
@@ -52,6 +73,10 @@ static gboolean  ibus_serializable_real_copy        (IBusSerializable       *des
 static IBusObjectClass *parent_class = NULL;
 static gint ibus_serializable_private_offset;
 
+static gint wire_version = IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY;
+/* The version of the calling thread + 1, 0 if it is not overridden. */
+static GPrivate thread_wire_version;
+
 G_GNUC_UNUSED
 static inline gpointer
 ibus_serializable_get_instance_private (IBusSerializable *self)
@@ -132,6 +157,76 @@ ibus_serializable_init (IBusSerializable *serializable)
     g_datalist_init (&serializable->priv->attachments);
 }
 
+static void
+_count_attachments_cb (GQuark    key,
+                       gpointer  value,
+                       guint    *count)
+{
+    (*count)++;
+}
+
+gboolean
+_ibus_serializable_has_attachments (IBusSerializable *serializable)
+{
+    guint count = 0;
+
+    g_datalist_foreach (&serializable->priv->attachments,
+                        (GDataForeachFunc) _count_attachments_cb,
+                        &count);
+    return count > 0;
+}
+
+static GType
+_type_from_tag (guchar tag)
+{
+    switch (tag) {
+    case TYPE_TAG_TEXT:
+        return IBUS_TYPE_TEXT;
+    case TYPE_TAG_ATTRIBUTE:
+        return IBUS_TYPE_ATTRIBUTE;
+    case TYPE_TAG_ATTR_LIST:
+        return IBUS_TYPE_ATTR_LIST;
+    case TYPE_TAG_LOOKUP_TABLE:
+        return IBUS_TYPE_LOOKUP_TABLE;
+    case TYPE_TAG_PROPERTY:
+        return IBUS_TYPE_PROPERTY;
+    case TYPE_TAG_PROP_LIST:
+        return IBUS_TYPE_PROP_LIST;
+    default:
+        return G_TYPE_INVALID;
+    }
+}
+
+static guchar
+_tag_from_type (GType type)
+{
+    guchar tag;
+
+    for (tag = TYPE_TAG_NAME + 1; tag < TYPE_TAG_LAST; tag++) {
+        if (_type_from_tag (tag) == type)
+            return tag;
+    }
+    return TYPE_TAG_NAME;
+}
+
+/* Returns TRUE if @serializable is serialized without the attachments. */
+static gboolean
+_is_compact (IBusSerializable *serializable)
+{
+    return ibus_serializable_get_wire_version () >=
+           IBUS_SERIALIZABLE_WIRE_VERSION_COMPACT &&
+           !_ibus_serializable_has_attachments (serializable);
+}
+
+/* Returns TRUE if @variant starts with a type tag instead of a type name. */
+static gboolean
+_variant_is_compact (GVariant *variant)
+{
+    return g_variant_type_equal (
+            g_variant_type_first (g_variant_get_type (variant)),
+            G_VARIANT_TYPE_BYTE);
+}
+
 static void
 ibus_serializable_destroy (IBusSerializable *serializable)
 {
@@ -153,6 +248,10 @@ ibus_serializable_real_serialize (IBusSerializable *serializable,
                                   GVariantBuilder  *builder)
 {
     GVariantBuilder array;
+
+    if (_is_compact (serializable))
+        return TRUE;
+
     g_variant_builder_init (&array, G_VARIANT_TYPE ("a{sv}"));
 
     g_datalist_foreach (&serializable->priv->attachments,
@@ -169,6 +268,14 @@ ibus_serializable_real_deserialize (IBusSerializable *object,
     const gchar *key;
     GVariant *value;
     GVariantIter *iter = NULL;
+
+    /* The compact format does not have the attachments. */
+    if (_variant_is_compact (variant)) {
+        guchar tag = TYPE_TAG_NAME;
+        g_variant_get_child (variant, 0, "y", &tag);
+        return tag == TYPE_TAG_NAME ? 2 : 1;
+    }
+
     g_variant_get_child (variant, 1, "a{sv}", &iter);
     while (g_variant_iter_loop (iter, "{&sv}", &key, &value)) {
         GVariant *attachment = g_variant_get_variant (value);
@@ -274,7 +381,17 @@ ibus_serializable_serialize_object (IBusSerializable *object)
     GVariantBuilder builder;
     g_variant_builder_init (&builder, G_VARIANT_TYPE_TUPLE);
 
-    g_variant_builder_add (&builder, "s", g_type_name (G_OBJECT_TYPE (object)));
+    if (_is_compact (object)) {
+        guchar tag = _tag_from_type (G_OBJECT_TYPE (object));
+        g_variant_builder_add (&builder, "y", tag);
+        if (tag == TYPE_TAG_NAME) {
+            g_variant_builder_add (&builder, "s",
+                                   g_type_name (G_OBJECT_TYPE (object)));
+        }
+    } else {
+        g_variant_builder_add (&builder, "s",
+                               g_type_name (G_OBJECT_TYPE (object)));
+    }
     retval = IBUS_SERIALIZABLE_GET_CLASS (object)->serialize (object, &builder);
     g_assert (retval);
 
@@ -299,8 +416,20 @@ ibus_serializable_deserialize_object (GVariant *variant)
     }
 
     gchar *type_name = NULL;
-    g_variant_get_child (var, 0, "&s", &type_name);
-    GType type = g_type_from_name (type_name);
+    GType type = G_TYPE_INVALID;
+    if (_variant_is_compact (var)) {
+        guchar tag = TYPE_TAG_NAME;
+        g_variant_get_child (var, 0, "y", &tag);
+        if (tag == TYPE_TAG_NAME) {
+            g_variant_get_child (var, 1, "&s", &type_name);
+            type = g_type_from_name (type_name);
+        } else {
+            type = _type_from_tag (tag);
+        }
+    } else {
+        g_variant_get_child (var, 0, "&s", &type_name);
+        type = g_type_from_name (type_name);
+    }
 
     g_return_val_if_fail (g_type_is_a (type, IBUS_TYPE_SERIALIZABLE), NULL);
 
@@ -315,3 +444,75 @@ ibus_serializable_deserialize_object (GVariant *variant)
     g_return_val_if_reached (NULL);
 }
 
+
+guint
+ibus_serializable_get_wire_version (void)
+{
+    gint version = GPOINTER_TO_INT (g_private_get (&thread_wire_version));
+
+    if (version > 0)
+        return version - 1;
+    return g_atomic_int_get (&wire_version);
+}
+
+void
+ibus_serializable_set_wire_version (guint version)
+{
+    g_atomic_int_set (&wire_version, version);
+}
+
+static GQuark
+_connection_wire_version_quark (void)
+{
+    static GQuark quark = 0;
+
+    if (g_once_init_enter (&quark)) {
+        GQuark q = g_quark_from_static_string ("ibus-wire-version");
+        g_once_init_leave (&quark, q);
+    }
+    return quark;
+}
+
+void
+_ibus_serializable_set_connection_wire_version (GDBusConnection *connection,
+                                                guint            version)
+{
+    g_return_if_fail (G_IS_DBUS_CONNECTION (connection));
+
+    /* The version + 1 to distinguish LEGACY from the unset value. */
+    g_object_set_qdata ((GObject *)connection,
+                        _connection_wire_version_quark (),
+                        GUINT_TO_POINTER (version + 1));
+}
+
+GVariant *
+_ibus_serializable_serialize_for_connection (IBusSerializable *serializable,
+                                             GDBusConnection  *connection)
+{
+    guint version = 0;
+    gint old_version;
+    GVariant *variant;
+
+    if (connection != NULL) {
+        version = GPOINTER_TO_UINT (
+                g_object_get_qdata ((GObject *)connection,
+                                    _connection_wire_version_quark ()));
+    }
+    if (version == 0)
+        return ibus_serializable_serialize_object (serializable);
+
+    old_version = ibus_serializable_set_thread_wire_version (version - 1);
+    variant = ibus_serializable_serialize_object (serializable);
+    ibus_serializable_set_thread_wire_version (old_version);
+    return variant;
+}
+
+gint
+ibus_serializable_set_thread_wire_version (gint version)
+{
+    gint old_version = GPOINTER_TO_INT (g_private_get (&thread_wire_version));
+
+    g_private_set (&thread_wire_version,
+                   GINT_TO_POINTER (version < 0 ? 0 : version + 1));
+    return old_version - 1;
+}
@@ -279,6 +279,96 @@ GVariant            *ibus_serializable_serialize_object
 IBusSerializable    *ibus_serializable_deserialize_object
                                             (GVariant           *variant);
 
+/**
+ * IBusSerializableWireVersion:
+ * @IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY: The original format which every
+ *     IBus version can deserialize.
+ * @IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_ATTRS: #IBusAttrList is serialized
+ *     as "a(uuuu)" instead of an array of nested #IBusAttribute.
+ * @IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_CANDIDATES: The candidates of
+ *     #IBusLookupTable without attributes are serialized as "as" instead of
+ *     an array of nested #IBusText.
+ * @IBUS_SERIALIZABLE_WIRE_VERSION_COMPACT: An #IBusSerializable without
+ *     attachments is serialized as "(y...)" with a type tag for the
+ *     built-in types, or "(ys...)" with the type name for the others,
+ *     instead of "(sa{sv}...)".
+ *
+ * The formats of the serialized #IBusSerializable.
+ * ibus_serializable_deserialize_object() can read all the versions but
+ * ibus_serializable_serialize_object() writes a newer version than
+ * %IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY only when the receiver is known
+ * to support it, i.e. the version is negotiated with ibus-daemon.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+typedef enum {
+    IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY = 0,
+    IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_ATTRS = 1,
+    IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_CANDIDATES = 2,
+    IBUS_SERIALIZABLE_WIRE_VERSION_COMPACT = 3,
+} IBusSerializableWireVersion;
+
+/**
+ * IBUS_SERIALIZABLE_WIRE_VERSION_CURRENT:
+ *
+ * The newest #IBusSerializableWireVersion which this library can write.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+#define IBUS_SERIALIZABLE_WIRE_VERSION_CURRENT \
+    IBUS_SERIALIZABLE_WIRE_VERSION_COMPACT
+
+/**
+ * ibus_serializable_get_wire_version:
+ *
+ * Gets the #IBusSerializableWireVersion which is used by
+ * ibus_serializable_serialize_object() in the calling thread.
+ *
+ * Returns: The version set by ibus_serializable_set_thread_wire_version()
+ *     if any, otherwise the version set by
+ *     ibus_serializable_set_wire_version().
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+guint                ibus_serializable_get_wire_version (void);
+
+/**
+ * ibus_serializable_set_wire_version:
+ * @version: An #IBusSerializableWireVersion.
+ *
+ * Sets the default #IBusSerializableWireVersion of the process.
+ * The default is %IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY.
+ * #IBusBus does not change it but keeps the version negotiated with
+ * ibus-daemon for its own #GDBusConnection, which #IBusEngine,
+ * #IBusPanelService and #IBusInputContext use to send objects, so the
+ * objects written to files or to the other peers stay readable.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void                 ibus_serializable_set_wire_version (guint   version);
+
+/**
+ * ibus_serializable_set_thread_wire_version:
+ * @version: An #IBusSerializableWireVersion or -1 to use the default
+ *     version of the process.
+ *
+ * Overrides the #IBusSerializableWireVersion in the calling thread.
+ * A process which talks to several peers, e.g. ibus-daemon, sets the
+ * version of the receiver before serializing objects for it.
+ *
+ * Returns: The previous value of the calling thread, which can be passed
+ *     to this function again to restore it.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+gint                 ibus_serializable_set_thread_wire_version
+                                            (gint    version);
+
 #define ibus_serializable_serialize ibus_serializable_serialize_object
 #define ibus_serializable_deserialize ibus_serializable_deserialize_object
 
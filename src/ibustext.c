@@ -250,8 +250,6 @@ ibus_text_append_attribute (IBusText *text,
 {
     g_assert (IBUS_IS_TEXT (text));
 
-    IBusAttribute *attr;
-
     if (end_index < 0) {
         end_index  += g_utf8_strlen(text->text, -1) + 1;
     }
@@ -265,8 +263,8 @@ ibus_text_append_attribute (IBusText *text,
         g_object_ref_sink (text->attrs);
     }
 
-    attr = ibus_attribute_new (type, value, start_index, end_index);
-    ibus_attr_list_append (text->attrs, attr);
+    ibus_attr_list_append_values (text->attrs, type, value,
+                                  start_index, end_index);
 }
 
 guint
@@ -302,3 +300,27 @@ ibus_text_set_attributes (IBusText     *text,
     text->attrs = attrs;
     g_object_ref_sink (text->attrs);
 }
+
+void
+ibus_text_set_string (IBusText    *text,
+                      const gchar *str)
+{
+    gchar *old_text;
+
+    g_return_if_fail (IBUS_IS_TEXT (text));
+    g_return_if_fail (str != NULL);
+
+    /* @str could be a part of text->text. */
+    old_text = text->is_static ? NULL : text->text;
+    text->text = g_strdup (str);
+    text->is_static = FALSE;
+    g_free (old_text);
+
+    if (text->attrs == NULL)
+        return;
+    /* Do not change the attributes shared with other objects. */
+    if (G_OBJECT (text->attrs)->ref_count == 1)
+        ibus_attr_list_clear (text->attrs);
+    else
+        g_clear_object (&text->attrs);
+}
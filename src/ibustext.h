@@ -214,6 +214,21 @@ IBusAttrList *   ibus_text_get_attributes           (IBusText       *text);
 void             ibus_text_set_attributes           (IBusText       *text,
                                                      IBusAttrList   *attrs);
 
+/**
+ * ibus_text_set_string:
+ * @text: An IBusText.
+ * @str: An text string to be set.
+ *
+ * Replace the text of @text with a copy of @str and remove the attributes
+ * so that an engine can reuse @text for the next update instead of creating
+ * a new #IBusText on each key.
+ *
+ * Since: 1.5.35
+ * Stability: Unstable
+ */
+void             ibus_text_set_string               (IBusText       *text,
+                                                     const gchar    *str);
+
 
 G_END_DECLS
 #endif
@@ -24,10 +24,12 @@
 #include <config.h>
 #endif
 
+#include <errno.h>
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <gio/gio.h>
 #include <string.h>
+#include "ibusinternal.h"
 #include "ibusxml.h"
 
 #ifdef ENABLE_NLS
@@ -37,7 +39,14 @@
 /* gettext macro */
 #define N_(t) t
 
+#define ISO_639_CACHE_MAGIC 0x49534f36 /* "ISO6" */
+#define ISO_639_CACHE_VERSION 0x00000001
+
+static gboolean __languages_loaded;
 static GHashTable *__languages_dict;
+/* The "a(ss)" table of the language codes and names sorted by the codes,
+ * which is mapped from the cache file. */
+static GVariant *__languages_table;
 
 static gboolean
 _iso_codes_parse_xml_node (XMLNode          *node)
@@ -102,6 +111,126 @@ _iso_codes_parse_xml_node (XMLNode          *node)
     return TRUE;
 }
 
+static gchar *
+_lang_cache_get_filename (void)
+{
+    return g_build_filename (g_get_user_cache_dir (),
+                             "ibus", "iso-639-3", NULL);
+}
+
+/**
+ * _load_lang_cache:
+ * @filename: The iso_639_3.xml file.
+ * @buf: The stat of @filename.
+ *
+ * Map the cache file of @filename if it is created from the same version
+ * of @filename. The file header is the magic and the version, and the rest
+ * is a "(stta(ss))" GVariant of the XML file name, its mtime and size,
+ * and the language table.
+ */
+static gboolean
+_load_lang_cache (const gchar       *filename,
+                  const struct stat *buf)
+{
+    gchar *cachename = _lang_cache_get_filename ();
+    GVariant *variant;
+    const gchar *xml_filename = NULL;
+    guint64 mtime = 0, size = 0;
+    gboolean retval = FALSE;
+
+    variant = _ibus_cache_load (cachename,
+                                ISO_639_CACHE_MAGIC,
+                                ISO_639_CACHE_VERSION,
+                                G_VARIANT_TYPE ("(stta(ss))"));
+    g_free (cachename);
+    if (variant == NULL)
+        return FALSE;
+
+    g_variant_get (variant, "(&stt@a(ss))",
+                   &xml_filename, &mtime, &size, &__languages_table);
+    if (g_strcmp0 (xml_filename, filename) == 0 &&
+        mtime == (guint64) buf->st_mtime &&
+        size == (guint64) buf->st_size) {
+        retval = TRUE;
+    } else {
+        g_variant_unref (__languages_table);
+        __languages_table = NULL;
+    }
+    g_variant_unref (variant);
+
+    return retval;
+}
+
+static gint
+_compare_lang_code (gconstpointer a,
+                    gconstpointer b)
+{
+    return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+static void
+_save_lang_cache (const gchar       *filename,
+                  const struct stat *buf)
+{
+    gchar *cachename = _lang_cache_get_filename ();
+    GPtrArray *codes;
+    GHashTableIter iter;
+    gpointer key;
+    GVariantBuilder builder;
+    GVariant *variant;
+    guint i;
+
+    codes = g_ptr_array_sized_new (g_hash_table_size (__languages_dict));
+    g_hash_table_iter_init (&iter, __languages_dict);
+    while (g_hash_table_iter_next (&iter, &key, NULL))
+        g_ptr_array_add (codes, key);
+    g_ptr_array_sort (codes, _compare_lang_code);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ss)"));
+    for (i = 0; i < codes->len; i++) {
+        const gchar *code = g_ptr_array_index (codes, i);
+        g_variant_builder_add (&builder, "(ss)",
+                               code,
+                               g_hash_table_lookup (__languages_dict, code));
+    }
+    g_ptr_array_free (codes, TRUE);
+
+    variant = g_variant_new ("(stta(ss))",
+                             filename,
+                             (guint64) buf->st_mtime,
+                             (guint64) buf->st_size,
+                             &builder);
+    _ibus_cache_save (cachename,
+                      ISO_639_CACHE_MAGIC,
+                      ISO_639_CACHE_VERSION,
+                      variant);
+    g_free (cachename);
+}
+
+static const gchar *
+_lookup_lang_cache (const gchar *lang)
+{
+    gsize low = 0;
+    gsize high = g_variant_n_children (__languages_table);
+
+    while (low < high) {
+        gsize mid = low + (high - low) / 2;
+        const gchar *code = NULL;
+        const gchar *name = NULL;
+        gint cmp;
+
+        g_variant_get_child (__languages_table, mid, "(&s&s)", &code, &name);
+        cmp = strcmp (lang, code);
+        if (cmp == 0)
+            return name;
+        if (cmp < 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return NULL;
+}
+
 void
 _load_lang()
 {
@@ -109,13 +238,13 @@ _load_lang()
     XMLNode *node;
     struct stat buf;
 
+    __languages_loaded = TRUE;
+
 #ifdef ENABLE_NLS
     bindtextdomain ("iso_639_3", LOCALEDIR);
     bind_textdomain_codeset ("iso_639_3", "UTF-8");
 #endif
 
-    __languages_dict = g_hash_table_new_full (g_str_hash,
-            g_str_equal, g_free, g_free);
     filename = g_build_filename (ISOCODES_PREFIX,
                                  "share/xml/iso-codes/iso_639_3.xml",
                                  NULL);
@@ -125,15 +254,25 @@ _load_lang()
         return;
     }
 
+    /* parsing the whole XML file is slow for a few language names. */
+    if (_load_lang_cache (filename, &buf)) {
+        g_free (filename);
+        return;
+    }
+
+    __languages_dict = g_hash_table_new_full (g_str_hash,
+            g_str_equal, g_free, g_free);
     node = ibus_xml_parse_file (filename);
-    g_free (filename);
 
     if (!node) {
+        g_free (filename);
         return;
     }
 
     _iso_codes_parse_xml_node (node);
     ibus_xml_free (node);
+    _save_lang_cache (filename, &buf);
+    g_free (filename);
 }
 
 const static gchar *
@@ -143,7 +282,7 @@ ibus_get_untranslated_raw_language_name (const gchar *_locale)
     gchar *p = NULL;
     gchar *lang = NULL;
 
-    if (__languages_dict == NULL )
+    if (!__languages_loaded)
         _load_lang();
     if ((p = strchr (_locale, '_')) !=  NULL)
         p = g_strndup (_locale, p - _locale);
@@ -151,7 +290,12 @@ ibus_get_untranslated_raw_language_name (const gchar *_locale)
         p = g_strdup (_locale);
     lang = g_ascii_strdown (p, -1);
     g_free (p);
-    retval = (const gchar *) g_hash_table_lookup (__languages_dict, lang);
+    if (__languages_table != NULL)
+        retval = _lookup_lang_cache (lang);
+    else if (__languages_dict != NULL)
+        retval = (const gchar *) g_hash_table_lookup (__languages_dict, lang);
+    else
+        retval = NULL;
     g_free (lang);
     if (retval != NULL)
         return retval;
@@ -227,3 +371,90 @@ ibus_g_variant_get_child_string (GVariant *variant, gsize index, char **str)
     g_free (*str);
     g_variant_get_child (variant, index, "s", str);
 }
+
+GVariant *
+_ibus_cache_load (const gchar        *filename,
+                  guint32             magic,
+                  guint32             version,
+                  const GVariantType *type)
+{
+    GMappedFile *mapped;
+    GBytes *bytes, *body;
+    const guint32 *header;
+    GVariant *variant;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+
+    mapped = g_mapped_file_new (filename, FALSE, NULL);
+    if (mapped == NULL)
+        return NULL;
+
+    bytes = g_mapped_file_get_bytes (mapped);
+    g_mapped_file_unref (mapped);
+    if (g_bytes_get_size (bytes) < 8) {
+        g_bytes_unref (bytes);
+        return NULL;
+    }
+    header = g_bytes_get_data (bytes, NULL);
+    if (GUINT32_FROM_BE (header[0]) != magic ||
+        GUINT32_FROM_BE (header[1]) != version) {
+        g_bytes_unref (bytes);
+        return NULL;
+    }
+
+    /* the mapped memory is page aligned, so is the body at the offset 8. */
+    body = g_bytes_new_from_bytes (bytes, 8, g_bytes_get_size (bytes) - 8);
+    g_bytes_unref (bytes);
+    variant = g_variant_ref_sink (g_variant_new_from_bytes (type, body, FALSE));
+    g_bytes_unref (body);
+
+    /* A truncated or overwritten body is not in the normal form. */
+    if (!g_variant_is_normal_form (variant)) {
+        g_variant_unref (variant);
+        return NULL;
+    }
+    return variant;
+}
+
+void
+_ibus_cache_save (const gchar *filename,
+                  guint32      magic,
+                  guint32      version,
+                  GVariant    *variant)
+{
+    gchar *cachedir;
+    gchar *contents;
+    gsize length;
+    guint32 intval;
+    GError *error = NULL;
+
+    g_return_if_fail (filename != NULL);
+    g_return_if_fail (variant != NULL);
+
+    g_variant_ref_sink (variant);
+
+    cachedir = g_path_get_dirname (filename);
+    errno = 0;
+    if (g_mkdir_with_parents (cachedir, 0775)) {
+        g_warning ("Failed to mkdir %s: %s", cachedir, g_strerror (errno));
+        g_free (cachedir);
+        g_variant_unref (variant);
+        return;
+    }
+    g_free (cachedir);
+
+    length = 8 + g_variant_get_size (variant);
+    contents = g_malloc (length);
+    intval = GUINT32_TO_BE (magic);
+    memcpy (contents, &intval, 4);
+    intval = GUINT32_TO_BE (version);
+    memcpy (contents + 4, &intval, 4);
+    g_variant_store (variant, contents + 8);
+    g_variant_unref (variant);
+
+    if (!g_file_set_contents (filename, contents, length, &error)) {
+        g_warning ("cannot write %s: %s", filename, error->message);
+        g_error_free (error);
+    }
+    g_free (contents);
+}
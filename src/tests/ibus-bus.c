@@ -1011,6 +1011,63 @@ test_get_engines_by_names (void)
     engines = NULL;
 }
 
+static void
+test_query_engines (void)
+{
+    GVariant *query;
+    GVariant *engines;
+    GVariantIter iter;
+    GVariant *fields;
+    guint64 generation = 0;
+    gboolean complete = FALSE;
+    gchar **removed = NULL;
+    gsize n_engines;
+
+    query = g_variant_new_parsed ("{'name-pattern': <'xkb:*'>,"
+                                  " 'fields': <['name', 'layout']>}");
+    engines = ibus_bus_query_engines (bus, query,
+                                      &generation, &complete, &removed);
+    g_assert (engines != NULL);
+    g_assert (complete);
+    g_assert_cmpuint (generation, >, 0);
+    g_assert (removed != NULL && removed[0] == NULL);
+    g_strfreev (removed);
+
+    n_engines = g_variant_n_children (engines);
+    g_variant_iter_init (&iter, engines);
+    while (g_variant_iter_loop (&iter, "@a{sv}", &fields)) {
+        const gchar *name = NULL;
+        const gchar *value = NULL;
+        gboolean found;
+        found = g_variant_lookup (fields, "name", "&s", &name);
+        g_assert (found);
+        g_assert (g_str_has_prefix (name, "xkb:"));
+        found = g_variant_lookup (fields, "layout", "&s", &value);
+        g_assert (found);
+        found = g_variant_lookup (fields, "description", "&s", &value);
+        g_assert (!found);
+    }
+    g_variant_unref (engines);
+
+    /* nothing is changed after the generation. */
+    query = g_variant_new_parsed ("{'name-pattern': <'xkb:*'>,"
+                                  " 'since': <%t>}", generation);
+    engines = ibus_bus_query_engines (bus, query, NULL, &complete, NULL);
+    g_assert (engines != NULL);
+    g_assert (!complete);
+    g_assert_cmpuint (g_variant_n_children (engines), ==, 0);
+    g_variant_unref (engines);
+
+    /* an older generation than the daemon returns all engines. */
+    query = g_variant_new_parsed ("{'name-pattern': <'xkb:*'>,"
+                                  " 'since': <@t 1>}");
+    engines = ibus_bus_query_engines (bus, query, NULL, &complete, NULL);
+    g_assert (engines != NULL);
+    g_assert (complete);
+    g_assert_cmpuint (g_variant_n_children (engines), ==, n_engines);
+    g_variant_unref (engines);
+}
+
 static void
 test_async_apis (void)
 {
@@ -1096,6 +1153,7 @@ main (gint    argc,
     g_test_add_func ("/ibus/create-input-context-async",
                      test_create_input_context_async);
     g_test_add_func ("/ibus/get-engines-by-names", test_get_engines_by_names);
+    g_test_add_func ("/ibus/query-engines", test_query_engines);
     g_test_add_func ("/ibus/get-address", test_get_address);
     g_test_add_func ("/ibus/get-current-input-context",
                      test_get_current_input_context);
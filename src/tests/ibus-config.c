@@ -137,6 +137,52 @@ test_config_set_get (void)
     g_object_unref (config);
 }
 
+static void
+test_config_cache (void)
+{
+    IBusConfig *config = ibus_config_new (ibus_bus_get_connection (bus),
+                                          NULL,
+                                          NULL);
+    g_assert (config);
+    g_assert (!ibus_config_get_cache_enabled (config));
+    ibus_config_set_cache_enabled (config, TRUE);
+    g_assert (ibus_config_get_cache_enabled (config));
+
+    ibus_config_set_value (config, "test", "v1", g_variant_new_int32(1));
+
+    GVariant *var;
+    var = ibus_config_get_value (config, "test", "v1");
+    g_assert (var);
+    g_assert_cmpint (g_variant_get_int32(var), ==, 1);
+    g_variant_unref (var);
+
+    /* a cached value must not survive the write through the same object. */
+    ibus_config_set_value (config, "test", "v1", g_variant_new_int32(2));
+    var = ibus_config_get_value (config, "test", "v1");
+    g_assert (var);
+    g_assert_cmpint (g_variant_get_int32(var), ==, 2);
+    g_variant_unref (var);
+
+    var = ibus_config_get_values (config, "test");
+    g_assert (var);
+    g_assert_cmpint (g_variant_n_children (var), ==, 1);
+    g_variant_unref (var);
+
+    ibus_config_unset (config, "test", "v1");
+    var = ibus_config_get_values (config, "test");
+    g_assert (var);
+    g_assert_cmpint (g_variant_n_children (var), ==, 0);
+    g_variant_unref (var);
+
+    ibus_config_set_cache_enabled (config, FALSE);
+    g_assert (!ibus_config_get_cache_enabled (config));
+
+    /* Since we reuse single D-Bus connection, we need to remove the
+       default match rule for the next ibus_config_new() call.  */
+    ibus_config_unwatch (config, NULL, NULL);
+    g_object_unref (config);
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -148,6 +194,7 @@ main (gint    argc,
 
     g_test_add_func ("/ibus/create-config-async", test_create_config_async);
     g_test_add_func ("/ibus/config-set-get", test_config_set_get);
+    g_test_add_func ("/ibus/config-cache", test_config_cache);
 
     result = g_test_run ();
     g_object_unref (bus);
@@ -1,17 +1,229 @@
 /* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
-#include "ibus.h"
+#include <ibus.h>
 
-int main()
+#define TEST_ENGINE_PATH "/org/freedesktop/IBus/Engine/Test/1"
+#define N_KEY_EVENTS 3
+
+/* An engine which completes the key events in a worker thread in the
+ * reversed order. */
+typedef struct {
+    IBusEngine parent;
+    guint      ids[N_KEY_EVENTS];
+    guint      n_ids;
+    guint      n_complete;
+    GThread   *thread;
+} TestEngine;
+
+typedef struct {
+    IBusEngineClass parent;
+} TestEngineClass;
+
+GType test_engine_get_type (void);
+
+G_DEFINE_TYPE (TestEngine, test_engine, IBUS_TYPE_ENGINE)
+
+static gpointer
+complete_key_events_thread (TestEngine *engine)
+{
+    guint i;
+
+    for (i = engine->n_complete; i > 0; i--) {
+        /* the key event of 'b' is handled. */
+        ibus_engine_process_key_event_return ((IBusEngine *) engine,
+                                              engine->ids[i - 1],
+                                              i == 2);
+    }
+    return NULL;
+}
+
+static void
+test_engine_process_key_event_async (IBusEngine *engine,
+                                     guint       keyval,
+                                     guint       keycode,
+                                     guint       state,
+                                     guint       id)
+{
+    TestEngine *test = (TestEngine *) engine;
+
+    g_assert_cmpuint (test->n_ids, <, N_KEY_EVENTS);
+    test->ids[test->n_ids++] = id;
+    if (test->n_ids == test->n_complete) {
+        test->thread = g_thread_new ("complete-key-events",
+                                     (GThreadFunc) complete_key_events_thread,
+                                     test);
+    }
+}
+
+static void
+test_engine_init (TestEngine *engine)
+{
+}
+
+static void
+test_engine_class_init (TestEngineClass *class)
+{
+    IBUS_ENGINE_CLASS (class)->process_key_event_async =
+            test_engine_process_key_event_async;
+}
+
+typedef struct {
+    GMainLoop *loop;
+    guint      n_replies;
+    gint       order[N_KEY_EVENTS];
+    gboolean   handled[N_KEY_EVENTS];
+} ReplyData;
+
+typedef struct {
+    ReplyData *data;
+    guint      index;
+} KeyEventCall;
+
+static void
+process_key_event_done_cb (GDBusConnection *connection,
+                           GAsyncResult    *res,
+                           KeyEventCall    *call)
+{
+    ReplyData *data = call->data;
+    GError *error = NULL;
+    GVariant *result = g_dbus_connection_call_finish (connection, res, &error);
+
+    g_assert_no_error (error);
+    g_variant_get (result, "(b)", &data->handled[call->index]);
+    g_variant_unref (result);
+    data->order[data->n_replies++] = call->index;
+    g_slice_free (KeyEventCall, call);
+    if (data->n_replies == N_KEY_EVENTS)
+        g_main_loop_quit (data->loop);
+}
+
+/* Send the key events 'a', 'b' and 'c' to @engine through ibus-daemon. */
+static void
+send_key_events (TestEngine *engine,
+                 ReplyData  *data)
+{
+    GDBusConnection *connection =
+            ibus_service_get_connection ((IBusService *) engine);
+    guint i;
+
+    for (i = 0; i < N_KEY_EVENTS; i++) {
+        KeyEventCall *call = g_slice_new (KeyEventCall);
+        call->data = data;
+        call->index = i;
+        g_dbus_connection_call (connection,
+                                g_dbus_connection_get_unique_name (connection),
+                                TEST_ENGINE_PATH,
+                                IBUS_INTERFACE_ENGINE,
+                                "ProcessKeyEvent",
+                                g_variant_new ("(uuu)", IBUS_KEY_a + i, 0, 0),
+                                G_VARIANT_TYPE ("(b)"),
+                                G_DBUS_CALL_FLAGS_NONE,
+                                -1,
+                                NULL,
+                                (GAsyncReadyCallback)
+                                        process_key_event_done_cb,
+                                call);
+    }
+}
+
+static gboolean
+destroy_engine_cb (TestEngine *engine)
+{
+    /* wait for the worker thread to complete the last key event. */
+    g_thread_join (engine->thread);
+    engine->thread = NULL;
+    ibus_object_destroy ((IBusObject *) engine);
+    return G_SOURCE_REMOVE;
+}
+
+static TestEngine *
+create_test_engine (IBusBus *bus,
+                    guint    n_complete)
+{
+    TestEngine *engine = (TestEngine *) ibus_engine_new_with_type (
+            test_engine_get_type (),
+            "test",
+            TEST_ENGINE_PATH,
+            ibus_bus_get_connection (bus));
+
+    engine->n_complete = n_complete;
+    return engine;
+}
+
+static void
+test_engine_process_key_event_async_order (void)
+{
+    IBusBus *bus = ibus_bus_new ();
+    TestEngine *engine;
+    ReplyData data = { NULL, 0, };
+    guint i;
+
+    if (!ibus_bus_is_connected (bus)) {
+        g_test_skip ("ibus-daemon is not running");
+        g_object_unref (bus);
+        return;
+    }
+    engine = create_test_engine (bus, N_KEY_EVENTS);
+    data.loop = g_main_loop_new (NULL, FALSE);
+    send_key_events (engine, &data);
+    g_main_loop_run (data.loop);
+
+    /* the replies keep the order of the key events. */
+    for (i = 0; i < N_KEY_EVENTS; i++)
+        g_assert_cmpint (data.order[i], ==, i);
+    g_assert_false (data.handled[0]);
+    g_assert_true (data.handled[1]);
+    g_assert_false (data.handled[2]);
+
+    g_thread_join (engine->thread);
+    g_main_loop_unref (data.loop);
+    ibus_object_destroy ((IBusObject *) engine);
+    g_object_unref (engine);
+    g_object_unref (bus);
+}
+
+static void
+test_engine_process_key_event_async_destroy (void)
+{
+    IBusBus *bus = ibus_bus_new ();
+    TestEngine *engine;
+    ReplyData data = { NULL, 0, };
+    guint i;
+
+    if (!ibus_bus_is_connected (bus)) {
+        g_test_skip ("ibus-daemon is not running");
+        g_object_unref (bus);
+        return;
+    }
+    /* only the first key event is completed and the others are pending
+     * when the engine is destroyed. */
+    engine = create_test_engine (bus, 1);
+    data.loop = g_main_loop_new (NULL, FALSE);
+    send_key_events (engine, &data);
+    g_timeout_add (100, (GSourceFunc) destroy_engine_cb, engine);
+    g_main_loop_run (data.loop);
+
+    for (i = 0; i < N_KEY_EVENTS; i++) {
+        g_assert_cmpint (data.order[i], ==, i);
+        g_assert_false (data.handled[i]);
+    }
+
+    g_main_loop_unref (data.loop);
+    g_object_unref (engine);
+    g_object_unref (bus);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
 {
     ibus_init ();
 
-    GMainLoop *mainloop;
-    IBusConnection *connection;
-    IBusService *service;
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/ibus/engine-process-key-event-async-order",
+                     test_engine_process_key_event_async_order);
+    g_test_add_func ("/ibus/engine-process-key-event-async-destroy",
+                     test_engine_process_key_event_async_destroy);
 
-    mainloop = g_main_loop_new (NULL, FALSE);
-    connection = ibus_connection_open ("unix:path=/tmp/ibus-phuang/ibus--0.0");
-    service = IBUS_SERVICE (ibus_engine_new ("/a/Engine", connection));
-    g_main_loop_run (mainloop);
-    return 0;
+    return g_test_run ();
 }
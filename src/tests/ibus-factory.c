@@ -29,6 +29,185 @@ test_factory (void)
     g_object_unref (bus);
 }
 
+static void
+test_factory_engine_pool (void)
+{
+    IBusBus *bus = ibus_bus_new ();
+    IBusFactory *factory = ibus_factory_new (ibus_bus_get_connection (bus));
+
+    g_assert_cmpuint (ibus_factory_get_engine_pool_size (factory), ==, 0);
+    ibus_factory_set_engine_pool_size (factory, 2);
+    g_assert_cmpuint (ibus_factory_get_engine_pool_size (factory), ==, 2);
+    ibus_factory_set_engine_pool_size (factory, 0);
+    g_assert_cmpuint (ibus_factory_get_engine_pool_size (factory), ==, 0);
+
+    g_object_unref (factory);
+    g_object_unref (bus);
+}
+
+typedef struct {
+    GMainLoop *loop;
+    GVariant  *result;
+} CallData;
+
+static void
+call_factory_done_cb (GDBusConnection *connection,
+                      GAsyncResult    *res,
+                      CallData        *data)
+{
+    GError *error = NULL;
+
+    data->result = g_dbus_connection_call_finish (connection, res, &error);
+    g_assert_no_error (error);
+    g_main_loop_quit (data->loop);
+}
+
+/* Call a method of @factory through ibus-daemon and wait for the reply. */
+static GVariant *
+call_factory (IBusFactory *factory,
+              const gchar *method_name,
+              GVariant    *parameters)
+{
+    GDBusConnection *connection =
+            ibus_service_get_connection ((IBusService *) factory);
+    CallData data = { g_main_loop_new (NULL, FALSE), NULL };
+
+    g_dbus_connection_call (connection,
+                            g_dbus_connection_get_unique_name (connection),
+                            IBUS_PATH_FACTORY,
+                            IBUS_INTERFACE_FACTORY,
+                            method_name,
+                            parameters,
+                            NULL,
+                            G_DBUS_CALL_FLAGS_NONE,
+                            -1,
+                            NULL,
+                            (GAsyncReadyCallback) call_factory_done_cb,
+                            &data);
+    g_main_loop_run (data.loop);
+    g_main_loop_unref (data.loop);
+    return data.result;
+}
+
+static gchar *
+create_engine (IBusFactory *factory,
+               const gchar *engine_name)
+{
+    GVariant *result = call_factory (factory, "CreateEngine",
+                                     g_variant_new ("(s)", engine_name));
+    gchar *object_path = NULL;
+
+    g_variant_get (result, "(o)", &object_path);
+    g_variant_unref (result);
+    return object_path;
+}
+
+static void
+release_engine (IBusFactory *factory,
+                const gchar *object_path)
+{
+    g_variant_unref (call_factory (factory, "ReleaseEngine",
+                                   g_variant_new ("(o)", object_path)));
+}
+
+typedef struct {
+    guint focus_out;
+    guint reset;
+    guint destroy;
+} EngineCounts;
+
+static void
+count_cb (IBusEngine *engine,
+          guint      *count)
+{
+    (*count)++;
+}
+
+/* Create engines which count the signals, and a "nameless" engine without
+ * the engine name as some engines in the other languages do. */
+static IBusEngine *
+create_counted_engine_cb (IBusFactory  *factory,
+                          const gchar  *engine_name,
+                          EngineCounts *counts)
+{
+    static guint id = 0;
+    gchar *object_path = g_strdup_printf ("/org/freedesktop/IBus/Engine/Test/%u",
+                                          ++id);
+    GDBusConnection *connection =
+            ibus_service_get_connection ((IBusService *) factory);
+    IBusEngine *engine;
+
+    if (g_strcmp0 (engine_name, "nameless") == 0) {
+        engine = g_object_new (IBUS_TYPE_ENGINE,
+                               "object-path", object_path,
+                               "connection", connection,
+                               NULL);
+    } else {
+        engine = ibus_engine_new (engine_name, object_path, connection);
+    }
+    g_free (object_path);
+
+    g_signal_connect (engine, "focus-out",
+                      G_CALLBACK (count_cb), &counts->focus_out);
+    g_signal_connect (engine, "reset",
+                      G_CALLBACK (count_cb), &counts->reset);
+    g_signal_connect (engine, "destroy",
+                      G_CALLBACK (count_cb), &counts->destroy);
+    return engine;
+}
+
+static void
+test_factory_engine_pool_reuse (void)
+{
+    IBusBus *bus = ibus_bus_new ();
+    IBusFactory *factory;
+    EngineCounts counts = { 0, };
+    gchar *path1;
+    gchar *path2;
+
+    if (!ibus_bus_is_connected (bus)) {
+        g_test_skip ("ibus-daemon is not running");
+        g_object_unref (bus);
+        return;
+    }
+    factory = ibus_factory_new (ibus_bus_get_connection (bus));
+    g_signal_connect (factory, "create-engine",
+                      G_CALLBACK (create_counted_engine_cb), &counts);
+
+    /* A released engine is focused out, reset and reused. */
+    path1 = create_engine (factory, "test");
+    ibus_factory_set_engine_pool_size (factory, 1);
+    release_engine (factory, path1);
+    g_assert_cmpuint (counts.focus_out, ==, 1);
+    g_assert_cmpuint (counts.reset, ==, 1);
+    g_assert_cmpuint (counts.destroy, ==, 0);
+    path2 = create_engine (factory, "test");
+    g_assert_cmpstr (path2, ==, path1);
+    g_free (path2);
+
+    /* An engine without the name is destroyed instead of pooled. */
+    path2 = create_engine (factory, "nameless");
+    run_loop_with_timeout (100);
+    counts.destroy = 0;
+    release_engine (factory, path2);
+    g_assert_cmpuint (counts.destroy, ==, 1);
+    g_free (path2);
+
+    /* The pool has the spare engine created in the idle time and does not
+     * keep more engines than the size. */
+    counts.destroy = 0;
+    release_engine (factory, path1);
+    g_assert_cmpuint (counts.destroy, ==, 1);
+    g_free (path1);
+
+    /* The pooled engines are destroyed when the pool is disabled. */
+    ibus_factory_set_engine_pool_size (factory, 0);
+    g_assert_cmpuint (counts.destroy, ==, 2);
+
+    g_object_unref (factory);
+    g_object_unref (bus);
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -38,6 +217,9 @@ main (gint    argc,
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/ibus/factory", test_factory);
+    g_test_add_func ("/ibus/factory-engine-pool", test_factory_engine_pool);
+    g_test_add_func ("/ibus/factory-engine-pool-reuse",
+                     test_factory_engine_pool_reuse);
 
     return g_test_run ();
 }
@@ -73,6 +73,71 @@ test_success (void)
 
 }
 
+static void
+create_with_state_finish_success (GObject      *object,
+                                  GAsyncResult *res,
+                                  gpointer      user_data)
+{
+    g_assert (object == (GObject *)bus);
+    g_assert (user_data == NULL);
+
+    GError *error = NULL;
+    IBusInputContext *context = NULL;
+    context = ibus_bus_create_input_context_with_state_async_finish (bus,
+                                                                     res,
+                                                                     &error);
+
+    g_assert_no_error (error);
+    g_assert (IBUS_IS_INPUT_CONTEXT (context));
+    ibus_proxy_destroy ((IBusProxy *) context);
+    g_object_unref (context);
+    ibus_quit ();
+}
+
+static void
+test_with_state_success (void)
+{
+    IBusRectangle cursor_location = { 10, 20, 1, 16 };
+
+    ibus_bus_create_input_context_with_state_async (
+            bus,
+            "test",
+            IBUS_CAP_PREEDIT_TEXT | IBUS_CAP_FOCUS,
+            IBUS_INPUT_PURPOSE_FREE_FORM,
+            IBUS_INPUT_HINT_NONE,
+            &cursor_location,
+            TRUE,
+            -1,
+            NULL,
+            create_with_state_finish_success,
+            NULL);
+    ibus_main ();
+}
+
+static gboolean
+pool_timeout_cb (gpointer user_data)
+{
+    ibus_quit ();
+    return G_SOURCE_REMOVE;
+}
+
+static void
+test_pool (void)
+{
+    IBusInputContext *context;
+
+    ibus_bus_set_input_context_pool (bus, "test-pool", 2);
+    g_timeout_add (500, pool_timeout_cb, NULL);
+    ibus_main ();
+
+    context = ibus_bus_create_input_context (bus, "test-pool");
+    g_assert (IBUS_IS_INPUT_CONTEXT (context));
+    ibus_proxy_destroy ((IBusProxy *) context);
+    g_object_unref (context);
+
+    ibus_bus_set_input_context_pool (bus, NULL, 0);
+}
+
 static void
 test_failed (void)
 {
@@ -98,6 +163,9 @@ main (gint    argc,
     bus = ibus_bus_new ();
 
     g_test_add_func ("/ibus/input_context_async_create_success", test_success);
+    g_test_add_func ("/ibus/input_context_async_create_with_state",
+                     test_with_state_success);
+    g_test_add_func ("/ibus/input_context_pool", test_pool);
     g_test_add_func ("/ibus/input_context_async_create_failed",  test_failed);
 
     result = g_test_run ();
@@ -1,56 +1,197 @@
 /* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
+
+#include <glib/gstdio.h>
+#include <string.h>
+#include <utime.h>
+
 #include "ibus.h"
 
-#ifndef __linux__
-/* the test is supported only on linux */
-int main (int argc, char **argv)
+#define TMPDIR_ENV "IBUS_TEST_KEYMAP_TMPDIR"
+
+#define KEYMAP_TEST \
+    "include test-common\n" \
+    "keycode 16 = q addupper\n"
+#define KEYMAP_TEST_COMMON \
+    "keycode 30 = a addupper\n"
+
+static const gchar *tmpdir;
+
+static void
+test_keymap_lookup (void)
+{
+    IBusKeymap *keymap;
+
+    /* the keymaps are loaded once per process. */
+    if (!g_test_subprocess ()) {
+        g_test_skip ("run by /ibus-keymap/cache");
+        return;
+    }
+    keymap = ibus_keymap_get ("test");
+    g_assert (keymap);
+    g_print ("%s %s %s\n",
+             ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, 16, 0)),
+             ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, 16,
+                                                          IBUS_SHIFT_MASK)),
+             ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, 30, 0)));
+    g_object_unref (keymap);
+}
+
+static void
+keymap_lookup (const gchar *expected)
 {
-    return 3;
+    g_test_trap_subprocess ("/ibus-keymap/subprocess/lookup", 0, 0);
+    g_test_trap_assert_passed ();
+    g_test_trap_assert_stdout (expected);
 }
-#else
 
-#include <linux/input.h>
+static void
+write_keymap (const gchar *name,
+              const gchar *contents,
+              time_t       mtime)
+{
+    gchar *filename = g_build_filename (tmpdir, "keymaps", name, NULL);
+    struct utimbuf times = { mtime, mtime };
 
-#define KEYBOARDPATH "/dev/input/event4"
+    g_assert (g_file_set_contents (filename, contents, -1, NULL));
+    g_assert_cmpint (g_utime (filename, &times), ==, 0);
+    g_free (filename);
+}
 
-int main (int argc, char **argv)
+static void
+assert_keymap_cache (const gchar *cachename,
+                     const gchar *expected,
+                     gsize        expected_length)
 {
-#if 0
-    gint fd;
-    struct input_event e;
+    gchar *contents = NULL;
+    gsize length = 0;
 
-    ibus_init ();
+    g_assert (g_file_get_contents (cachename, &contents, &length, NULL));
+    g_assert_cmpmem (contents, length, expected, expected_length);
+    g_free (contents);
+}
+
+static void
+test_keymap_cache (void)
+{
+    gchar *cachename = g_build_filename (tmpdir,
+                                         "cache", "ibus", "keymaps", "test",
+                                         NULL);
+    gchar *saved = NULL;
+    gsize saved_length = 0;
+    gchar *contents;
 
-    IBusKeymap *keymap = ibus_keymap_get (argc > 1 ? argv[1] : "us");
+    write_keymap ("test", KEYMAP_TEST, 1000000000);
+    write_keymap ("test-common", KEYMAP_TEST_COMMON, 1000000000);
+    g_remove (cachename);
 
-    g_object_unref (keymap);
-    return 0;
+    /* the first process parses the text files and writes the cache. */
+    keymap_lookup ("*q Q a\n*");
+    g_assert (g_file_get_contents (cachename, &saved, &saved_length, NULL));
+    g_assert_cmpuint (saved_length, >, 8);
+    g_assert_cmpmem (saved, 4, "KMAP", 4);
+
+    /* the next process is served by the cache while the text files have
+     * the same mtimes and sizes. */
+    write_keymap ("test", "include test-common\nkeycode 16 = w addupper\n",
+                  1000000000);
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
+
+    /* a modified file is parsed again. */
+    write_keymap ("test", "include test-common\nkeycode 16 = w addupper\n",
+                  1000000100);
+    keymap_lookup ("*w W a\n*");
+    write_keymap ("test", KEYMAP_TEST, 1000000000);
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
+
+    /* so is a modified included file. */
+    write_keymap ("test-common", "keycode 30 = s addupper\n", 1000000100);
+    keymap_lookup ("*q Q s\n*");
+    write_keymap ("test-common", KEYMAP_TEST_COMMON, 1000000000);
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
+
+    /* a cache of another format version is replaced. */
+    contents = g_malloc (saved_length);
+    memcpy (contents, saved, saved_length);
+    contents[7]++;
+    g_assert (g_file_set_contents (cachename, contents, saved_length, NULL));
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
+
+    /* so is a file which has another magic. */
+    memcpy (contents, saved, saved_length);
+    contents[0] = 'X';
+    g_assert (g_file_set_contents (cachename, contents, saved_length, NULL));
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
+
+    /* and truncated files. */
+    g_assert (g_file_set_contents (cachename, saved, saved_length / 2, NULL));
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
 
-    fd = open (KEYBOARDPATH, O_RDONLY);
+    g_assert (g_file_set_contents (cachename, saved, 8, NULL));
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
 
+    g_assert (g_file_set_contents (cachename, saved, 4, NULL));
+    keymap_lookup ("*q Q a\n*");
+    assert_keymap_cache (cachename, saved, saved_length);
 
-    while (fd >= 0 && read (fd, &e, sizeof (e)) == sizeof (e)) {
-        if (e.type != EV_KEY)
-            continue;
-        if (e.value != 0)
-            continue;
+    g_free (contents);
+    g_free (saved);
+    g_free (cachename);
+}
+
+int
+main (int argc, char *argv[])
+{
+    gchar *dirname;
+    gchar *owned = NULL;
+    gint retval;
 
-        g_debug ("=========================================================================");
-        g_debug ("keycode = %d, %s %s %s %s %s", e.code,
-                    ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, e.code, 0)),
-                    ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, e.code, IBUS_SHIFT_MASK)),
-                    ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, e.code, IBUS_MOD5_MASK)),
-                    ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, e.code, IBUS_MOD5_MASK | IBUS_SHIFT_MASK)),
-                    ibus_keyval_name (ibus_keymap_lookup_keysym (keymap, e.code, IBUS_MOD2_MASK))
-        );
+    /* the subprocesses share the directories of the parent. */
+    if ((tmpdir = g_getenv (TMPDIR_ENV)) == NULL) {
+        owned = g_dir_make_tmp ("ibus-keymap-XXXXXX", NULL);
+        g_assert (owned);
+        g_setenv (TMPDIR_ENV, owned, TRUE);
+        tmpdir = owned;
     }
+    dirname = g_build_filename (tmpdir, "keymaps", NULL);
+    g_mkdir_with_parents (dirname, 0775);
+    g_setenv ("IBUS_KEYMAP_PATH", dirname, TRUE);
+    g_free (dirname);
+    dirname = g_build_filename (tmpdir, "cache", NULL);
+    g_setenv ("XDG_CACHE_HOME", dirname, TRUE);
+    g_free (dirname);
 
-    g_object_unref (keymap);
-#endif
-    return 0;
+    g_test_init (&argc, &argv, NULL);
+    ibus_init ();
+    g_test_add_func ("/ibus-keymap/cache", test_keymap_cache);
+    g_test_add_func ("/ibus-keymap/subprocess/lookup", test_keymap_lookup);
+    retval = g_test_run ();
+
+    if (owned != NULL) {
+        const gchar *files[] = {
+            "keymaps/test",
+            "keymaps/test-common",
+            "keymaps",
+            "cache/ibus/keymaps/test",
+            "cache/ibus/keymaps",
+            "cache/ibus",
+            "cache",
+        };
+        gint i;
+
+        for (i = 0; i < G_N_ELEMENTS (files); i++) {
+            gchar *filename = g_build_filename (owned, files[i], NULL);
+            g_remove (filename);
+            g_free (filename);
+        }
+        g_rmdir (owned);
+        g_free (owned);
+    }
+    return retval;
 }
-#endif
@@ -1,4 +1,28 @@
+#include <glib/gstdio.h>
 #include <ibus.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COMPONENT_XML \
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n" \
+    "<component>\n" \
+    "  <name>org.freedesktop.IBus.Test%d</name>\n" \
+    "  <description>Test &amp; component</description>\n" \
+    "  <exec>/bin/true</exec>\n" \
+    "  <version>1.0</version>\n" \
+    "  <engines>\n" \
+    "    <engine>\n" \
+    "      <name>test%d</name>\n" \
+    "      <language>ja</language>\n" \
+    "      <layout>jp</layout>\n" \
+    "      <rank>%d</rank>\n" \
+    "    </engine>\n" \
+    "    <engine>\n" \
+    "      <name>test%d-2</name>\n" \
+    "      <symbol></symbol>\n" \
+    "    </engine>\n" \
+    "  </engines>\n" \
+    "</component>\n"
 
 static void
 test (void)
@@ -7,11 +31,92 @@ test (void)
     g_object_unref (registry);
 }
 
+static void
+test_load_in_dir (void)
+{
+    gchar *dirname = g_dir_make_tmp ("ibus-registry-XXXXXX", NULL);
+    IBusRegistry *registry;
+    GList *components, *p;
+    gint i;
+
+    g_assert (dirname);
+    for (i = 0; i < 4; i++) {
+        gchar *basename = g_strdup_printf ("test%d.xml", i);
+        gchar *filename = g_build_filename (dirname, basename, NULL);
+        gchar *contents = g_strdup_printf (COMPONENT_XML, i, i, i, i);
+        g_assert (g_file_set_contents (filename, contents, -1, NULL));
+        g_free (contents);
+        g_free (filename);
+        g_free (basename);
+    }
+
+    registry = ibus_registry_new ();
+    ibus_registry_load_in_dir (registry, dirname);
+    components = ibus_registry_get_components (registry);
+    g_assert_cmpint (g_list_length (components), ==, 4);
+
+    for (p = components; p != NULL; p = p->next) {
+        IBusComponent *component = (IBusComponent *) p->data;
+        const gchar *name = ibus_component_get_name (component);
+        gchar *filename;
+        gchar *contents = NULL;
+        XMLNode *node;
+        IBusComponent *expected;
+        GList *engines, *expected_engines, *e, *f;
+
+        g_assert (g_str_has_prefix (name, "org.freedesktop.IBus.Test"));
+        g_assert_cmpstr (ibus_component_get_description (component),
+                         ==, "Test & component");
+        g_assert_cmpstr (ibus_component_get_exec (component), ==, "/bin/true");
+
+        /* compare with the component parsed from the XMLNode tree. */
+        i = atoi (name + strlen ("org.freedesktop.IBus.Test"));
+        contents = g_strdup_printf (COMPONENT_XML, i, i, i, i);
+        node = ibus_xml_parse_buffer (contents);
+        expected = ibus_component_new_from_xml_node (node);
+        ibus_xml_free (node);
+        g_free (contents);
+
+        engines = ibus_component_get_engines (component);
+        expected_engines = ibus_component_get_engines (expected);
+        g_assert_cmpint (g_list_length (engines), ==, 2);
+        g_assert_cmpint (g_list_length (engines),
+                         ==, g_list_length (expected_engines));
+        for (e = engines, f = expected_engines; e; e = e->next, f = f->next) {
+            IBusEngineDesc *desc = (IBusEngineDesc *) e->data;
+            IBusEngineDesc *expected_desc = (IBusEngineDesc *) f->data;
+            g_assert_cmpstr (ibus_engine_desc_get_name (desc),
+                             ==, ibus_engine_desc_get_name (expected_desc));
+            g_assert_cmpstr (ibus_engine_desc_get_language (desc),
+                             ==,
+                             ibus_engine_desc_get_language (expected_desc));
+            g_assert_cmpstr (ibus_engine_desc_get_layout (desc),
+                             ==, ibus_engine_desc_get_layout (expected_desc));
+            g_assert_cmpstr (ibus_engine_desc_get_symbol (desc),
+                             ==, ibus_engine_desc_get_symbol (expected_desc));
+            g_assert_cmpuint (ibus_engine_desc_get_rank (desc),
+                              ==, ibus_engine_desc_get_rank (expected_desc));
+        }
+        g_list_free (engines);
+        g_list_free (expected_engines);
+        g_object_unref (expected);
+
+        filename = g_strdup_printf ("%s/test%d.xml", dirname, i);
+        g_unlink (filename);
+        g_free (filename);
+    }
+    g_list_free (components);
+    g_object_unref (registry);
+    g_rmdir (dirname);
+    g_free (dirname);
+}
+
 int
 main(int argc, char *argv[])
 {
     g_test_init (&argc, &argv, NULL);
     ibus_init ();
     g_test_add_func ("/ibus-registry", test);
+    g_test_add_func ("/ibus-registry/load-in-dir", test_load_in_dir);
     return g_test_run ();
 }
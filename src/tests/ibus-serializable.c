@@ -44,6 +44,67 @@ test_attr_list (void)
     g_variant_type_info_assert_no_infos ();
 }
 
+static void
+test_attr_list_packed (void)
+{
+    IBusAttrList *list = ibus_attr_list_new ();
+    IBusAttrList *copy;
+    GVariant *variant, *child;
+    guint type, value, start_index, end_index;
+    gint old_version;
+
+    g_object_ref_sink (list);
+    ibus_attr_list_append_values (list, IBUS_ATTR_TYPE_UNDERLINE,
+                                  IBUS_ATTR_UNDERLINE_SINGLE, 0, 5);
+    ibus_attr_list_append_values (list, IBUS_ATTR_TYPE_FOREGROUND,
+                                  0xff0000, 1, 2);
+    g_assert_cmpuint (ibus_attr_list_get_n_attributes (list), ==, 2);
+    g_assert_cmpuint (list->attributes->len, ==, 2);
+    g_assert (ibus_attr_list_get_values (list, 1, &type, &value,
+                                         &start_index, &end_index));
+    g_assert_cmpuint (type, ==, IBUS_ATTR_TYPE_FOREGROUND);
+    g_assert_cmpuint (value, ==, 0xff0000);
+    g_assert_cmpuint (start_index, ==, 1);
+    g_assert_cmpuint (end_index, ==, 2);
+    g_assert (!ibus_attr_list_get_values (list, 2, NULL, NULL, NULL, NULL));
+
+    /* The legacy format unless the version is negotiated. */
+    variant = ibus_serializable_serialize ((IBusSerializable *)list);
+    child = g_variant_get_child_value (variant, 2);
+    g_assert (g_variant_is_of_type (child, G_VARIANT_TYPE ("av")));
+    g_variant_unref (child);
+    g_variant_unref (variant);
+
+    old_version = ibus_serializable_set_thread_wire_version (
+            IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_ATTRS);
+    variant = ibus_serializable_serialize ((IBusSerializable *)list);
+    child = g_variant_get_child_value (variant, 2);
+    g_assert (g_variant_is_of_type (child, G_VARIANT_TYPE ("a(uuuu)")));
+    g_variant_unref (child);
+
+    /* The public array is filled by the packed format too. */
+    copy = (IBusAttrList *)ibus_serializable_deserialize (variant);
+    g_object_ref_sink (copy);
+    g_assert_cmpuint (copy->attributes->len, ==, 2);
+    g_assert_cmpuint (g_array_index (copy->attributes, IBusAttribute *,
+                                     1)->value, ==, 0xff0000);
+    g_object_unref (copy);
+    g_variant_unref (variant);
+
+    /* The attributes keep the order. */
+    g_assert_cmpuint (ibus_attr_list_get (list, 0)->type, ==,
+                      IBUS_ATTR_TYPE_UNDERLINE);
+    ibus_attr_list_append_values (list, IBUS_ATTR_TYPE_BACKGROUND,
+                                  0x00ff00, 3, 4);
+    g_assert_cmpuint (ibus_attr_list_get (list, 2)->type, ==,
+                      IBUS_ATTR_TYPE_BACKGROUND);
+    test_serializable ((IBusSerializable *)list);
+    ibus_serializable_set_thread_wire_version (old_version);
+    g_assert_cmpuint (ibus_serializable_get_wire_version (), ==,
+                      IBUS_SERIALIZABLE_WIRE_VERSION_LEGACY);
+    g_variant_type_info_assert_no_infos ();
+}
+
 static void
 test_text (void)
 {
@@ -54,6 +115,77 @@ test_text (void)
     g_variant_type_info_assert_no_infos ();
 }
 
+static void
+_count_cb (gpointer data)
+{
+    (*(guint *)data)++;
+}
+
+static void
+_count_weak_cb (gpointer data,
+                GObject *where_the_object_was)
+{
+    (*(guint *)data)++;
+}
+
+static void
+test_text_reuse (void)
+{
+    IBusText *text = ibus_text_new_from_string ("Hello");
+    IBusAttribute *attr;
+    guint destroyed = 0;
+    guint data_freed = 0;
+    guint weak_notified = 0;
+
+    g_object_ref_sink (text);
+    ibus_text_append_attribute (text, IBUS_ATTR_TYPE_UNDERLINE,
+                                IBUS_ATTR_UNDERLINE_SINGLE, 0, 5);
+    attr = ibus_attr_list_get (text->attrs, 0);
+    g_signal_connect_swapped (attr, "destroy",
+                              G_CALLBACK (_count_cb), &destroyed);
+    g_object_set_data_full (G_OBJECT (attr), "test-data",
+                            &data_freed, _count_cb);
+    g_object_weak_ref (G_OBJECT (attr), _count_weak_cb, &weak_notified);
+    ibus_serializable_set_attachment ((IBusSerializable *)attr, "test",
+                                      g_variant_new_int32 (1));
+
+    /* The released attribute is destroyed. */
+    ibus_text_set_string (text, "World!");
+    g_assert_cmpstr (ibus_text_get_text (text), ==, "World!");
+    g_assert_null (ibus_attr_list_get (text->attrs, 0));
+    g_assert_cmpuint (destroyed, ==, 1);
+    g_assert_cmpuint (data_freed, ==, 1);
+    g_assert_cmpuint (weak_notified, ==, 1);
+
+    /* A new attribute has no trace of the previous user. */
+    ibus_text_append_attribute (text, IBUS_ATTR_TYPE_FOREGROUND,
+                                0xff0000, 1, 6);
+    attr = ibus_attr_list_get (text->attrs, 0);
+    g_assert_nonnull (attr);
+    g_assert_cmpuint (attr->type, ==, IBUS_ATTR_TYPE_FOREGROUND);
+    g_assert_cmpuint (attr->value, ==, 0xff0000);
+    g_assert_cmpuint (attr->start_index, ==, 1);
+    g_assert_cmpuint (attr->end_index, ==, 6);
+    g_assert (!g_object_is_floating (attr));
+    g_assert_null (g_object_get_data (G_OBJECT (attr), "test-data"));
+    g_assert_null (ibus_serializable_get_attachment ((IBusSerializable *)attr,
+                                                     "test"));
+    g_assert (!g_signal_has_handler_pending (
+            attr, g_signal_lookup ("destroy", IBUS_TYPE_OBJECT), 0, FALSE));
+    g_assert (!(IBUS_OBJECT_FLAGS (attr) & IBUS_DESTROYED));
+
+    /* Nothing is notified twice when the attribute is released again. */
+    ibus_text_set_string (text, "");
+    g_assert_cmpuint (destroyed, ==, 1);
+    g_assert_cmpuint (data_freed, ==, 1);
+    g_assert_cmpuint (weak_notified, ==, 1);
+
+    ibus_text_append_attribute (text, IBUS_ATTR_TYPE_UNDERLINE,
+                                IBUS_ATTR_UNDERLINE_DOUBLE, 0, 1);
+    test_serializable ((IBusSerializable *)text);
+    g_variant_type_info_assert_no_infos ();
+}
+
 static void
 test_engine_desc (void)
 {
@@ -92,6 +224,83 @@ test_lookup_table (void)
     g_variant_type_info_assert_no_infos ();
 }
 
+static void
+test_lookup_table_packed (void)
+{
+    static const gchar * const candidates[] = { "Hello", "Cool", NULL };
+    IBusLookupTable *table, *copy;
+    GVariant *variant, *child;
+    IBusText *text;
+    gint old_version;
+
+    table = ibus_lookup_table_new (9, 0, TRUE, FALSE);
+    g_object_ref_sink (table);
+    ibus_lookup_table_append_candidates (table, candidates, -1);
+    g_assert_cmpuint (ibus_lookup_table_get_number_of_candidates (table), ==,
+                      2);
+    g_assert_cmpuint (table->candidates->len, ==, 2);
+    g_assert_cmpstr (ibus_lookup_table_get_candidate_string (table, 1), ==,
+                     "Cool");
+    g_assert_null (ibus_lookup_table_get_candidate_string (table, 2));
+
+    /* The legacy format unless the version is negotiated. */
+    variant = ibus_serializable_serialize ((IBusSerializable *)table);
+    child = g_variant_get_child_value (variant, 7);
+    g_assert (g_variant_is_of_type (child, G_VARIANT_TYPE ("av")));
+    g_variant_unref (child);
+    g_variant_unref (variant);
+
+    old_version = ibus_serializable_set_thread_wire_version (
+            IBUS_SERIALIZABLE_WIRE_VERSION_PACKED_CANDIDATES);
+    variant = ibus_serializable_serialize ((IBusSerializable *)table);
+    child = g_variant_get_child_value (variant, 7);
+    g_assert (g_variant_is_of_type (child, G_VARIANT_TYPE ("as")));
+    g_variant_unref (child);
+    g_variant_unref (variant);
+
+    /* The order is kept with the IBusText candidates. */
+    text = ibus_lookup_table_get_candidate (table, 0);
+    g_assert_cmpstr (ibus_text_get_text (text), ==, "Hello");
+    g_assert (ibus_lookup_table_get_candidate (table, 0) == text);
+    ibus_lookup_table_append_candidate (table,
+            ibus_text_new_from_static_string ("Text"));
+    g_assert (ibus_lookup_table_get_candidate (table, 0) == text);
+    g_assert_cmpstr (ibus_lookup_table_get_candidate_string (table, 2), ==,
+                     "Text");
+
+    ibus_lookup_table_set_candidates (table, candidates, 1);
+    g_assert_cmpuint (ibus_lookup_table_get_number_of_candidates (table), ==,
+                      1);
+
+    ibus_lookup_table_append_candidates (table, candidates, -1);
+    g_assert_cmpuint (ibus_lookup_table_get_candidates (table)->len, ==, 3);
+    g_assert (ibus_lookup_table_get_candidates (table) == table->candidates);
+    g_assert_cmpstr (ibus_text_get_text (g_array_index (table->candidates,
+                                                        IBusText *, 2)),
+                     ==, "Cool");
+    g_assert_cmpuint (ibus_lookup_table_get_number_of_candidates (table), ==,
+                      3);
+    test_serializable ((IBusSerializable *)g_object_ref (table));
+
+    /* The candidates of both formats are in the public array. */
+    variant = ibus_serializable_serialize ((IBusSerializable *)table);
+    copy = (IBusLookupTable *)ibus_serializable_deserialize (variant);
+    g_assert_cmpuint (copy->candidates->len, ==, 3);
+    g_object_unref (copy);
+    g_variant_unref (variant);
+    ibus_serializable_set_thread_wire_version (old_version);
+    variant = ibus_serializable_serialize ((IBusSerializable *)table);
+    copy = (IBusLookupTable *)ibus_serializable_deserialize (variant);
+    g_assert_cmpuint (copy->candidates->len, ==, 3);
+    g_assert_cmpstr (ibus_text_get_text (g_array_index (copy->candidates,
+                                                        IBusText *, 2)),
+                     ==, "Cool");
+    g_object_unref (copy);
+    g_variant_unref (variant);
+    g_object_unref (table);
+    g_variant_type_info_assert_no_infos ();
+}
+
 static void
 test_property (void)
 {
@@ -179,6 +388,49 @@ test_attachment (void)
     g_variant_type_info_assert_no_infos ();
 }
 
+static void
+test_compact (void)
+{
+    IBusText *text;
+    IBusEngineDesc *desc;
+    GVariant *variant;
+    gint old_version;
+
+    old_version = ibus_serializable_set_thread_wire_version (
+            IBUS_SERIALIZABLE_WIRE_VERSION_COMPACT);
+
+    /* A built-in type is serialized with a type tag. */
+    text = ibus_text_new_from_static_string ("Hello");
+    g_object_ref_sink (text);
+    ibus_text_append_attribute (text, IBUS_ATTR_TYPE_UNDERLINE,
+                                IBUS_ATTR_UNDERLINE_SINGLE, 0, -1);
+    variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    g_assert (g_str_has_prefix (g_variant_get_type_string (variant), "(ys"));
+    g_variant_unref (variant);
+    test_serializable ((IBusSerializable *)g_object_ref (text));
+
+    /* The attachments are kept in the legacy format. */
+    ibus_serializable_set_attachment ((IBusSerializable *)text, "key",
+                                      g_variant_new_int32 (100));
+    variant = ibus_serializable_serialize ((IBusSerializable *)text);
+    g_assert (g_str_has_prefix (g_variant_get_type_string (variant),
+                                "(sa{sv}"));
+    g_variant_unref (variant);
+    g_object_unref (text);
+
+    /* The other types are serialized with the type name. */
+    desc = ibus_engine_desc_new ("Hello", "Hello Engine", "Hello Engine Desc",
+                                 "zh", "GPLv2", "Peng Huang", "icon", "en");
+    g_object_ref_sink (desc);
+    variant = ibus_serializable_serialize ((IBusSerializable *)desc);
+    g_assert (g_str_has_prefix (g_variant_get_type_string (variant), "(ys"));
+    g_variant_unref (variant);
+    test_serializable ((IBusSerializable *)desc);
+
+    ibus_serializable_set_thread_wire_version (old_version);
+    g_variant_type_info_assert_no_infos ();
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -188,11 +440,15 @@ main (gint    argc,
     g_test_init (&argc, &argv, NULL);
     g_test_add_func ("/ibus/varianttypeinfo", test_varianttypeinfo);
     g_test_add_func ("/ibus/attrlist", test_attr_list);
+    g_test_add_func ("/ibus/attrlistpacked", test_attr_list_packed);
     g_test_add_func ("/ibus/text", test_text);
+    g_test_add_func ("/ibus/textreuse", test_text_reuse);
     g_test_add_func ("/ibus/enginedesc", test_engine_desc);
     g_test_add_func ("/ibus/lookuptable", test_lookup_table);
+    g_test_add_func ("/ibus/lookuptablepacked", test_lookup_table_packed);
     g_test_add_func ("/ibus/property", test_property);
     g_test_add_func ("/ibus/attachment", test_attachment);
+    g_test_add_func ("/ibus/compact", test_compact);
 
     return g_test_run ();
 }
@@ -1,22 +1,166 @@
 /* -*- mode: C; c-basic-offset: 4; indent-tabs-mode: nil; -*- */
 
+#include <glib/gstdio.h>
 #include <locale.h>
+#include <string.h>
 
 #include "ibus.h"
 
+#define CACHE_HOME_ENV "IBUS_TEST_UTIL_CACHE_HOME"
+
 static void
 test (void)
 {
     gchar *name;
     g_assert_cmpstr (name = ibus_get_language_name ("eng"), ==, "English");
     g_free (name);
+    /* the second look up could be served by the language name cache. */
+    g_assert_cmpstr (name = ibus_get_language_name ("jpn"), ==, "Japanese");
+    g_free (name);
+    g_assert_cmpstr (name = ibus_get_untranslated_language_name ("zzzz"),
+                     ==, "Other");
+    g_free (name);
+}
+
+static void
+test_lang_cache_lookup (void)
+{
+    gchar *name;
+
+    /* the language table is loaded once per process. */
+    if (!g_test_subprocess ()) {
+        g_test_skip ("run by /ibus-util/lang-cache");
+        return;
+    }
+    name = ibus_get_untranslated_language_name ("eng");
+    g_print ("%s\n", name);
+    g_free (name);
+}
+
+static void
+lang_cache_lookup (void)
+{
+    g_test_trap_subprocess ("/ibus-util/subprocess/lang-cache-lookup",
+                            0, 0);
+    g_test_trap_assert_passed ();
+}
+
+static void
+assert_lang_cache (const gchar *cachename,
+                   const gchar *expected,
+                   gsize        expected_length)
+{
+    gchar *contents = NULL;
+    gsize length = 0;
+
+    g_assert (g_file_get_contents (cachename, &contents, &length, NULL));
+    g_assert_cmpmem (contents, length, expected, expected_length);
+    g_free (contents);
+}
+
+static void
+test_lang_cache (void)
+{
+    gchar *cachename = g_build_filename (g_get_user_cache_dir (),
+                                         "ibus", "iso-639-3", NULL);
+    gchar *saved = NULL;
+    gsize saved_length = 0;
+    gchar *contents;
+    gchar *p;
+
+    g_remove (cachename);
+
+    /* the first process parses the XML file and writes the cache. */
+    lang_cache_lookup ();
+    g_test_trap_assert_stdout ("*English*");
+    g_assert (g_file_get_contents (cachename, &saved, &saved_length, NULL));
+    g_assert_cmpuint (saved_length, >, 8);
+    g_assert_cmpmem (saved, 4, "ISO6", 4);
+
+    /* the next process is served by the cache. */
+    contents = g_malloc (saved_length);
+    memcpy (contents, saved, saved_length);
+    for (p = contents; p + 12 <= contents + saved_length; p++) {
+        if (memcmp (p, "eng\0English\0", 12) == 0)
+            break;
+    }
+    g_assert (p + 12 <= contents + saved_length);
+    p[10] = 'z';
+    g_assert (g_file_set_contents (cachename, contents, saved_length, NULL));
+    lang_cache_lookup ();
+    g_test_trap_assert_stdout ("*Englisz*");
+    assert_lang_cache (cachename, contents, saved_length);
+
+    /* a cache of another format version is replaced. */
+    memcpy (contents, saved, saved_length);
+    contents[7]++;
+    g_assert (g_file_set_contents (cachename, contents, saved_length, NULL));
+    lang_cache_lookup ();
+    g_test_trap_assert_stdout ("*English*");
+    assert_lang_cache (cachename, saved, saved_length);
+
+    /* so is a file which has another magic. */
+    memcpy (contents, saved, saved_length);
+    contents[0] = 'X';
+    g_assert (g_file_set_contents (cachename, contents, saved_length, NULL));
+    lang_cache_lookup ();
+    g_test_trap_assert_stdout ("*English*");
+    assert_lang_cache (cachename, saved, saved_length);
+
+    /* and truncated files. */
+    g_assert (g_file_set_contents (cachename, saved, saved_length / 2, NULL));
+    lang_cache_lookup ();
+    g_test_trap_assert_stdout ("*English*");
+    assert_lang_cache (cachename, saved, saved_length);
+
+    g_assert (g_file_set_contents (cachename, saved, 8, NULL));
+    lang_cache_lookup ();
+    g_test_trap_assert_stdout ("*English*");
+    assert_lang_cache (cachename, saved, saved_length);
+
+    g_assert (g_file_set_contents (cachename, saved, 4, NULL));
+    lang_cache_lookup ();
+    g_test_trap_assert_stdout ("*English*");
+    assert_lang_cache (cachename, saved, saved_length);
+
+    g_free (contents);
+    g_free (saved);
+    g_free (cachename);
 }
 
 int
 main (int argc, char *argv[])
 {
+    const gchar *cache_home;
+    gchar *tmpdir = NULL;
+    gint retval;
+
+    /* the subprocesses share the cache directory of the parent. */
+    if ((cache_home = g_getenv (CACHE_HOME_ENV)) == NULL) {
+        tmpdir = g_dir_make_tmp ("ibus-util-XXXXXX", NULL);
+        g_assert (tmpdir);
+        g_setenv (CACHE_HOME_ENV, tmpdir, TRUE);
+        cache_home = tmpdir;
+    }
+    g_setenv ("XDG_CACHE_HOME", cache_home, TRUE);
+
     g_test_init (&argc, &argv, NULL);
     setlocale(LC_ALL, "C");
     g_test_add_func ("/ibus-util", test);
-    return g_test_run ();
+    g_test_add_func ("/ibus-util/lang-cache", test_lang_cache);
+    g_test_add_func ("/ibus-util/subprocess/lang-cache-lookup",
+                     test_lang_cache_lookup);
+    retval = g_test_run ();
+
+    if (tmpdir != NULL) {
+        gchar *dirname = g_build_filename (tmpdir, "ibus", NULL);
+        gchar *cachename = g_build_filename (dirname, "iso-639-3", NULL);
+        g_remove (cachename);
+        g_rmdir (dirname);
+        g_rmdir (tmpdir);
+        g_free (cachename);
+        g_free (dirname);
+        g_free (tmpdir);
+    }
+    return retval;
 }
@@ -463,7 +463,40 @@ int list_engine(string[] argv) {
         return Posix.EXIT_FAILURE;
     }
 
-    var engines = bus.list_engines();
+    /* Let ibus-daemon send only the printed properties. */
+    string[] fields = { "name" };
+    if (!name_only) {
+        fields += "longname";
+        fields += "language";
+    }
+    var query = new VariantBuilder(VariantType.VARDICT);
+    query.add("{sv}", "fields", new Variant.strv(fields));
+    uint64 generation;
+    bool complete;
+    string[] removed;
+    var result = bus.query_engines(query.end(),
+                                   out generation,
+                                   out complete,
+                                   out removed);
+
+    IBus.EngineDesc[] engines = {};
+    if (result != null) {
+        foreach (var desc_fields in result) {
+            string name = "";
+            string longname = "";
+            string language = "";
+            desc_fields.lookup("name", "s", out name);
+            desc_fields.lookup("longname", "s", out longname);
+            desc_fields.lookup("language", "s", out language);
+            engines += new IBus.EngineDesc(name, longname, "", language,
+                                           "", "", "", "");
+        }
+    } else {
+        /* ibus-daemon does not support QueryEngines yet. */
+        foreach (var engine in bus.list_engines()) {
+            engines += engine;
+        }
+    }
 
     if (name_only) {
         foreach (var engine in engines) {
@@ -983,6 +1016,88 @@ int print_address(string[] argv) {
 }
 
 
+GLib.Variant stats_call_sync(GLib.DBusConnection connection,
+                             string              method,
+                             string              reply_type) throws GLib.Error {
+    return connection.call_sync(IBus.SERVICE_IBUS,
+                                IBus.PATH_IBUS,
+                                "org.freedesktop.IBus.Stats",
+                                method,
+                                null,
+                                new GLib.VariantType(reply_type),
+                                GLib.DBusCallFlags.NONE,
+                                -1,
+                                null);
+}
+
+
+int print_stats(string[] argv) {
+    var bus = get_bus();
+    if (bus == null) {
+        stderr.printf(_("Can't connect to IBus.\n"));
+        return Posix.EXIT_FAILURE;
+    }
+    var connection = bus.get_connection();
+
+    try {
+        var stats = stats_call_sync(connection, "GetStats", "(a{sv})");
+        print("%s\n", _("Counters:"));
+        var iter = stats.get_child_value(0).iterator();
+        string key;
+        GLib.Variant value;
+        while (iter.next("{sv}", out key, out value))
+            print("  %-24s %s\n", key, value.print(false));
+
+        var connections = stats_call_sync(connection,
+                                          "GetConnectionStats",
+                                          "(a(stttt))");
+        print("\n%s\n", _("Connections:"));
+        print("  %-24s %10s %12s %10s %12s\n",
+              "NAME", "IN", "IN-BYTES", "OUT", "OUT-BYTES");
+        iter = connections.get_child_value(0).iterator();
+        string name;
+        uint64 n_in, in_bytes, n_out, out_bytes;
+        while (iter.next("(stttt)", out name, out n_in, out in_bytes,
+                         out n_out, out out_bytes)) {
+            print("  %-24s %10s %12s %10s %12s\n",
+                  name, n_in.to_string(), in_bytes.to_string(),
+                  n_out.to_string(), out_bytes.to_string());
+        }
+
+        var round_trips = stats_call_sync(connection,
+                                          "GetEngineRoundTrips",
+                                          "(ata(sat))");
+        var bounds = round_trips.get_child_value(0);
+        print("\n%s\n", _("Engine round trips (usec):"));
+        iter = round_trips.get_child_value(1).iterator();
+        string method;
+        GLib.Variant buckets;
+        while (iter.next("(s@at)", out method, out buckets)) {
+            print("  %s\n", method);
+            for (size_t i = 0; i < buckets.n_children(); i++) {
+                uint64 count = buckets.get_child_value(i).get_uint64();
+                if (count == 0)
+                    continue;
+                if (i < bounds.n_children()) {
+                    print("    < %-10s %s\n",
+                          bounds.get_child_value(i).get_uint64().to_string(),
+                          count.to_string());
+                } else {
+                    print("    >= %-9s %s\n",
+                          bounds.get_child_value(i - 1).get_uint64()
+                                  .to_string(),
+                          count.to_string());
+                }
+            }
+        }
+    } catch (GLib.Error e) {
+        stderr.printf("%s\n", e.message);
+        return Posix.EXIT_FAILURE;
+    }
+    return Posix.EXIT_SUCCESS;
+}
+
+
 private int read_config_options(string[] argv) {
     const OptionEntry[] options = {
         { "engine-id", 0, 0, OptionArg.STRING, out engine_id,
@@ -1161,6 +1276,7 @@ const CommandEntry commands[]  = {
     { "read-cache", N_("Show the content of registry cache"), read_cache },
     { "write-cache", N_("Create registry cache"), write_cache },
     { "address", N_("Print the D-Bus address of ibus-daemon"), print_address },
+    { "stats", N_("Show statistics of ibus-daemon"), print_stats },
     { "read-config", N_("Show the configuration values"), read_config },
     { "reset-config", N_("Reset the configuration values"), reset_config },
 #if EMOJI_DICT
@@ -22,18 +22,47 @@
  */
 
 class CandidateArea : Gtk.Box {
+    // The widgets of an orientation. They are kept when the orientation
+    // is toggled and each cell remembers what it shows so that
+    // set_candidates() only touches the changed cells.
+    private class CandidateCells {
+        public Gtk.Widget container;
+        public Gtk.Label[] labels;
+        public Gtk.Label[] candidates;
+        public Gtk.Widget[] widgets;
+
+        public IBus.Text?[] texts = new IBus.Text?[16];
+        public bool[] focused = new bool[16];
+        public bool[] visible = new bool[16];
+
+        public void invalidate() {
+            for (int i = 0; i < 16; i++)
+                texts[i] = null;
+        }
+    }
+
+    // The maximum number of the cached Pango.AttrList of candidates.
+    private const uint MAX_ATTRS_CACHE_SIZE = 256;
+
     private bool m_vertical;
     private Gtk.Widget m_text_view;
-    private Gtk.Label[] m_labels;
-    private Gtk.Label[] m_candidates;
-    private Gtk.Widget[] m_widgets;
+    private CandidateCells m_cells;
+    private CandidateCells m_vertical_cells;
+    private CandidateCells m_horizontal_cells;
+    private string[] m_label_texts;
 
     private IBus.Text[] m_ibus_candidates;
     private uint m_focus_candidate;
     private bool m_show_cursor;
     private ThemedRGBA m_rgba;
+    private Gdk.RGBA? m_selected_fg;
+    private Gdk.RGBA? m_selected_bg;
 
     private Pango.Attribute m_language_attribute;
+    // A map from a candidate string and its attributes to the Pango
+    // attributes including m_language_attribute.
+    private GLib.HashTable<string, Pango.AttrList> m_attrs_cache =
+            new GLib.HashTable<string, Pango.AttrList>(str_hash, str_equal);
 
     private const string LABELS[] = {
         "1.", "2.", "3.", "4.", "5.", "6.", "7.", "8.",
@@ -58,6 +87,7 @@ class CandidateArea : Gtk.Box {
 
     public CandidateArea(bool vertical) {
         GLib.Object();
+        m_label_texts = LABELS;
         set_vertical(vertical, true);
         m_text_view = new Gtk.TextView();
         var style_context = m_text_view.get_style_context();
@@ -66,9 +96,9 @@ class CandidateArea : Gtk.Box {
 
     ~CandidateArea() {
         m_ibus_candidates = null;
-        m_labels = null;
-        m_candidates = null;
-        m_widgets = null;
+        m_cells = null;
+        m_vertical_cells = null;
+        m_horizontal_cells = null;
         m_rgba = null;
         m_text_view = null;
     }
@@ -97,7 +127,20 @@ class CandidateArea : Gtk.Box {
         orientation = vertical ?
             Gtk.Orientation.VERTICAL :
             Gtk.Orientation.HORIZONTAL;
-        recreate_ui();
+
+        if (m_cells != null)
+            remove(m_cells.container);
+        if (vertical) {
+            if (m_vertical_cells == null)
+                m_vertical_cells = create_cells(true);
+            m_cells = m_vertical_cells;
+        } else {
+            if (m_horizontal_cells == null)
+                m_horizontal_cells = create_cells(false);
+            m_cells = m_horizontal_cells;
+        }
+        add(m_cells.container);
+        update_labels();
 
         if (m_ibus_candidates.length > 0) {
             // Workaround a vala issue
@@ -111,14 +154,28 @@ class CandidateArea : Gtk.Box {
 
     public void set_labels(IBus.Text[] labels) {
         int i;
+        string[] texts = {};
         for (i = 0; i < int.min(16, labels.length); i++)
-            m_labels[i].set_text(labels[i].get_text());
+            texts += labels[i].get_text();
         for (; i < 16; i++)
-            m_labels[i].set_text(LABELS[i]);
+            texts += LABELS[i];
+        m_label_texts = texts;
+        update_labels();
     }
 
     public void set_language(Pango.Attribute language_attribute) {
         m_language_attribute = language_attribute.copy();
+        m_attrs_cache.remove_all();
+        invalidate_cells();
+    }
+
+    // Invalidate the cells of both orientations since the cells of the
+    // hidden orientation are shown again when the orientation is toggled.
+    private void invalidate_cells() {
+        if (m_vertical_cells != null)
+            m_vertical_cells.invalidate();
+        if (m_horizontal_cells != null)
+            m_horizontal_cells.invalidate();
     }
 
     public void set_candidates(IBus.Text[] candidates,
@@ -129,49 +186,120 @@ class CandidateArea : Gtk.Box {
         m_show_cursor = show_cursor;
 
         assert(candidates.length <= 16);
+        if (!rgba_equal(m_selected_fg, m_rgba.selected_fg) ||
+            !rgba_equal(m_selected_bg, m_rgba.selected_bg)) {
+            m_selected_fg = m_rgba.selected_fg;
+            m_selected_bg = m_rgba.selected_bg;
+            invalidate_cells();
+        }
         for (int i = 0 ; i < 16 ; i++) {
-            Gtk.Label label = m_candidates[i];
+            Gtk.Label label = m_cells.candidates[i];
             bool visible = false;
             if (i < candidates.length) {
-                Pango.AttrList attrs = get_pango_attr_list_from_ibus_text(candidates[i]);
-                attrs.change(m_language_attribute.copy());
-                if (i == focus_candidate && show_cursor) {
-                    Pango.Attribute pango_attr = Pango.attr_foreground_new(
-                            (uint16)(m_rgba.selected_fg.red * uint16.MAX),
-                            (uint16)(m_rgba.selected_fg.green * uint16.MAX),
-                            (uint16)(m_rgba.selected_fg.blue * uint16.MAX));
-                    pango_attr.start_index = 0;
-                    pango_attr.end_index = candidates[i].get_text().length;
-                    attrs.insert((owned)pango_attr);
-
-                    pango_attr = Pango.attr_background_new(
-                           (uint16)(m_rgba.selected_bg.red * uint16.MAX),
-                           (uint16)(m_rgba.selected_bg.green * uint16.MAX),
-                           (uint16)(m_rgba.selected_bg.blue * uint16.MAX));
-                    pango_attr.start_index = 0;
-                    pango_attr.end_index = candidates[i].get_text().length;
-                    attrs.insert((owned)pango_attr);
-                }
-                label.set_text(candidates[i].get_text());
-                label.set_attributes(attrs);
+                bool focused = (i == focus_candidate && show_cursor);
                 visible = true;
-            } else {
+                if (m_cells.texts[i] == null ||
+                    m_cells.focused[i] != focused ||
+                    !ibus_text_equal(m_cells.texts[i], candidates[i])) {
+                    update_cell(label, candidates[i], focused);
+                    m_cells.texts[i] = candidates[i];
+                    m_cells.focused[i] = focused;
+                }
+            } else if (m_cells.visible[i] || m_cells.texts[i] != null) {
                 label.set_text("");
                 label.set_attributes(new Pango.AttrList());
+                m_cells.texts[i] = null;
             }
+            if (m_cells.visible[i] == visible)
+                continue;
+            m_cells.visible[i] = visible;
             if (m_vertical) {
-                m_widgets[i * 2].set_visible(visible);
-                m_widgets[i * 2 +1].set_visible(visible);
+                m_cells.widgets[i * 2].set_visible(visible);
+                m_cells.widgets[i * 2 +1].set_visible(visible);
             } else {
-                m_widgets[i].set_visible(visible);
+                m_cells.widgets[i].set_visible(visible);
             }
         }
     }
 
-    private void recreate_ui() {
-        foreach (Gtk.Widget w in get_children()) {
-            w.destroy();
+    private static bool rgba_equal(Gdk.RGBA? a, Gdk.RGBA? b) {
+        if (a == null || b == null)
+            return a == b;
+        return a.equal(b);
+    }
+
+    private static bool ibus_text_equal(IBus.Text a, IBus.Text b) {
+        if (a == b)
+            return true;
+        if (a.get_text() != b.get_text())
+            return false;
+        return get_attrs_key(a) == get_attrs_key(b);
+    }
+
+    private static string get_attrs_key(IBus.Text text) {
+        unowned IBus.AttrList attrs = text.get_attributes();
+        if (attrs == null)
+            return "";
+        var builder = new GLib.StringBuilder();
+        IBus.Attribute attr;
+        for (int i = 0; (attr = attrs.get(i)) != null; i++) {
+            builder.append_printf("%u:%u:%u:%u;",
+                                  (uint)attr.type, attr.value,
+                                  attr.start_index, attr.end_index);
+        }
+        return builder.str;
+    }
+
+    private Pango.AttrList get_cached_attrs(IBus.Text text) {
+        string key = text.get_text() + "\n" + get_attrs_key(text);
+        Pango.AttrList? attrs = m_attrs_cache.lookup(key);
+        if (attrs != null)
+            return attrs;
+        attrs = get_pango_attr_list_from_ibus_text(text);
+        attrs.change(m_language_attribute.copy());
+        if (m_attrs_cache.size() >= MAX_ATTRS_CACHE_SIZE)
+            m_attrs_cache.remove_all();
+        m_attrs_cache.insert(key, attrs);
+        return attrs;
+    }
+
+    private void update_cell(Gtk.Label label,
+                             IBus.Text candidate,
+                             bool      focused) {
+        Pango.AttrList attrs = get_cached_attrs(candidate);
+        if (focused) {
+            // The cached list is shared by the other cells.
+            attrs = attrs.copy();
+            Pango.Attribute pango_attr = Pango.attr_foreground_new(
+                    (uint16)(m_rgba.selected_fg.red * uint16.MAX),
+                    (uint16)(m_rgba.selected_fg.green * uint16.MAX),
+                    (uint16)(m_rgba.selected_fg.blue * uint16.MAX));
+            pango_attr.start_index = 0;
+            pango_attr.end_index = candidate.get_text().length;
+            attrs.insert((owned)pango_attr);
+
+            pango_attr = Pango.attr_background_new(
+                   (uint16)(m_rgba.selected_bg.red * uint16.MAX),
+                   (uint16)(m_rgba.selected_bg.green * uint16.MAX),
+                   (uint16)(m_rgba.selected_bg.blue * uint16.MAX));
+            pango_attr.start_index = 0;
+            pango_attr.end_index = candidate.get_text().length;
+            attrs.insert((owned)pango_attr);
+        }
+        if (label.get_text() != candidate.get_text())
+            label.set_text(candidate.get_text());
+        label.set_attributes(attrs);
+    }
+
+    private void update_labels() {
+        for (int i = 0; i < 16; i++) {
+            if (m_cells.labels[i].get_text() != m_label_texts[i])
+                m_cells.labels[i].set_text(m_label_texts[i]);
         }
+    }
+
+    private CandidateCells create_cells(bool vertical) {
+        CandidateCells cells = new CandidateCells();
 
         Gtk.Button prev_button = new Gtk.Button();
         prev_button.clicked.connect((b) => page_up());
@@ -187,11 +315,11 @@ class CandidateArea : Gtk.Box {
                                   Gtk.IconSize.MENU));
         next_button.set_relief(Gtk.ReliefStyle.NONE);
 
-        if (m_vertical) {
+        if (vertical) {
             Gtk.EventBox container_ebox = new Gtk.EventBox();
             container_ebox.add_events(Gdk.EventMask.SCROLL_MASK);
             container_ebox.scroll_event.connect(candidate_scrolled);
-            add(container_ebox);
+            cells.container = container_ebox;
 
             Gtk.Box vbox = new Gtk.Box(Gtk.Orientation.VERTICAL, 0);
             container_ebox.add(vbox);
@@ -219,21 +347,21 @@ class CandidateArea : Gtk.Box {
             buttons_hbox.pack_start(next_button, false, false, 0);
             vbox.pack_start(buttons_hbox, false, false, 0);
 
-            m_labels = {};
-            m_candidates = {};
-            m_widgets = {};
+            cells.labels = {};
+            cells.candidates = {};
+            cells.widgets = {};
             for (int i = 0; i < 16; i++) {
                 Gtk.Label label = new Gtk.Label(LABELS[i]);
                 label.set_halign(Gtk.Align.START);
                 label.set_valign(Gtk.Align.CENTER);
                 label.show();
-                m_labels += label;
+                cells.labels += label;
 
                 Gtk.Label candidate = new Gtk.Label("test");
                 candidate.set_halign(Gtk.Align.START);
                 candidate.set_valign(Gtk.Align.CENTER);
                 candidate.show();
-                m_candidates += candidate;
+                cells.candidates += candidate;
 
                 label.set_margin_start (8);
                 label.set_margin_end (8);
@@ -251,7 +379,7 @@ class CandidateArea : Gtk.Box {
                 });
                 label_ebox.add(label);
                 labels_vbox.pack_start(label_ebox, false, false, 2);
-                m_widgets += label_ebox;
+                cells.widgets += label_ebox;
 
                 Gtk.EventBox candidate_ebox = new Gtk.EventBox();
                 candidate_ebox.set_no_show_all(true);
@@ -261,32 +389,32 @@ class CandidateArea : Gtk.Box {
                 });
                 candidate_ebox.add(candidate);
                 candidates_vbox.pack_start(candidate_ebox, false, false, 2);
-                m_widgets += candidate_ebox;
+                cells.widgets += candidate_ebox;
             }
         } else {
             Gtk.EventBox container_ebox = new Gtk.EventBox();
             container_ebox.add_events(Gdk.EventMask.SCROLL_MASK);
             container_ebox.scroll_event.connect(candidate_scrolled);
-            add(container_ebox);
+            cells.container = container_ebox;
 
             Gtk.Box hbox = new Gtk.Box(Gtk.Orientation.HORIZONTAL, 0);
             container_ebox.add(hbox);
 
-            m_labels = {};
-            m_candidates = {};
-            m_widgets = {};
+            cells.labels = {};
+            cells.candidates = {};
+            cells.widgets = {};
             for (int i = 0; i < 16; i++) {
                 Gtk.Label label = new Gtk.Label(LABELS[i]);
                 label.set_halign(Gtk.Align.START);
                 label.set_valign(Gtk.Align.CENTER);
                 label.show();
-                m_labels += label;
+                cells.labels += label;
 
                 Gtk.Label candidate = new Gtk.Label("test");
                 candidate.set_halign(Gtk.Align.START);
                 candidate.set_valign(Gtk.Align.CENTER);
                 candidate.show();
-                m_candidates += candidate;
+                cells.candidates += candidate;
 
                 Gtk.Box candidate_hbox = new Gtk.Box(Gtk.Orientation.HORIZONTAL, 0);
                 candidate_hbox.show();
@@ -304,12 +432,12 @@ class CandidateArea : Gtk.Box {
                 });
                 ebox.add(candidate_hbox);
                 hbox.pack_start(ebox, false, false, 4);
-                m_widgets += ebox;
+                cells.widgets += ebox;
             }
             hbox.pack_start(new VSeparator(), false, false, 0);
             hbox.pack_start(prev_button, false, false, 0);
             hbox.pack_start(next_button, false, false, 0);
         }
+        return cells;
     }
 }
-
@@ -47,6 +47,27 @@ int _Xi18nStatusDrawCallback (XIMS ims, IMProtocol *call_data);
 int _Xi18nStatusDoneCallback (XIMS ims, IMProtocol *call_data);
 int _Xi18nStringConversionCallback (XIMS ims, IMProtocol *call_data);
 
+/* i18nCodec.c */
+void _Xi18nEncodeForwardEvent (unsigned char *buf, int need_swap,
+                               CARD16 im_id, CARD16 ic_id, CARD16 flag,
+                               CARD16 serial);
+void _Xi18nDecodeForwardEvent (const unsigned char *buf, int need_swap,
+                               CARD16 *im_id, CARD16 *ic_id, CARD16 *flag,
+                               CARD16 *serial);
+int _Xi18nCommitCharsSize (int length);
+void _Xi18nEncodeCommitChars (unsigned char *buf, int need_swap,
+                              CARD16 im_id, CARD16 ic_id, CARD16 flag,
+                              const char *string, int length);
+void _Xi18nEncodeSync (unsigned char *buf, int need_swap,
+                       CARD16 im_id, CARD16 ic_id);
+int _Xi18nPreeditDrawSize (int length, int feedback_count);
+void _Xi18nEncodePreeditDraw (unsigned char *buf, int need_swap,
+                              CARD16 im_id, CARD16 ic_id, INT32 caret,
+                              INT32 chg_first, INT32 chg_length,
+                              BITMASK32 status, const char *string,
+                              int length, const XIMFeedback *feedback,
+                              int feedback_count);
+
 /* i18nIc.c */
 void _Xi18nChangeIC (XIMS ims, IMProtocol *call_data, unsigned char *p,
                      int create_flag);
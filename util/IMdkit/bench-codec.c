@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2026 IBus contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this
+ * software and its documentation for any purpose is hereby granted
+ * without fee, provided that the above copyright notice appear in
+ * all copies and that both that copyright notice and this permission
+ * notice appear in supporting documentation, and that the name of
+ * the copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+ * ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF
+ * THIS SOFTWARE.
+ */
+
+/*
+ * Compares the specialized codecs in i18nCodec.c with the FrameMgr.
+ * Every message is encoded by both in the both byte orders and the
+ * results must be the same bytes.  Then the time of each is printed.
+ *
+ * Usage: xim-codec-bench [iterations]
+ */
+
+#include <X11/Xlib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FrameMgr.h"
+#include "IMdkit.h"
+#include "Xi18n.h"
+#include "XimFunc.h"
+
+extern XimFrameRec forward_event_fr[];
+extern XimFrameRec commit_chars_fr[];
+extern XimFrameRec sync_fr[];
+extern XimFrameRec preedit_draw_fr[];
+
+#define BUFFER_SIZE 256
+
+static const char commit_string[] = "\xe3\x81\x82\xe3\x81\x84";
+static const char preedit_string[] = "\x1b%G\xe3\x81\x8b\xe3\x81\x8d\xe3\x81\x8f";
+static XIMFeedback feedback[] = {
+    XIMUnderline, XIMUnderline, XIMUnderline | XIMReverse, 0
+};
+
+static int failed = 0;
+
+static double now (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int frame_forward_event (unsigned char *buf, int swap)
+{
+    FrameMgr fm = FrameMgrInit (forward_event_fr, (char *) buf, swap);
+    CARD16 im_id = 1, ic_id = 2, flag = 1, serial = 0x1234;
+    int size;
+
+    FrameMgrPutToken (fm, im_id);
+    FrameMgrPutToken (fm, ic_id);
+    FrameMgrPutToken (fm, flag);
+    FrameMgrPutToken (fm, serial);
+    size = FrameMgrGetTotalSize (fm);
+    FrameMgrFree (fm);
+    return size;
+}
+
+static int codec_forward_event (unsigned char *buf, int swap)
+{
+    _Xi18nEncodeForwardEvent (buf, swap, 1, 2, 1, 0x1234);
+    return sizeof (CARD16) * 4;
+}
+
+static int frame_commit_chars (unsigned char *buf, int swap)
+{
+    FrameMgr fm = FrameMgrInit (commit_chars_fr, NULL, swap);
+    CARD16 im_id = 1, ic_id = 2, flag = XimLookupChars;
+    CARD16 str_length = strlen (commit_string);
+    char *string = (char *) commit_string;
+    int size;
+
+    FrameMgrSetSize (fm, str_length);
+    size = FrameMgrGetTotalSize (fm);
+    memset (buf, 0, size);
+    FrameMgrSetBuffer (fm, buf);
+    str_length = FrameMgrGetSize (fm);
+    FrameMgrPutToken (fm, im_id);
+    FrameMgrPutToken (fm, ic_id);
+    FrameMgrPutToken (fm, flag);
+    FrameMgrPutToken (fm, str_length);
+    FrameMgrPutToken (fm, string);
+    FrameMgrFree (fm);
+    return size;
+}
+
+static int codec_commit_chars (unsigned char *buf, int swap)
+{
+    int str_length = strlen (commit_string);
+
+    _Xi18nEncodeCommitChars (buf, swap, 1, 2, XimLookupChars,
+                             commit_string, str_length);
+    return _Xi18nCommitCharsSize (str_length);
+}
+
+static int frame_sync (unsigned char *buf, int swap)
+{
+    FrameMgr fm = FrameMgrInit (sync_fr, (char *) buf, swap);
+    CARD16 im_id = 1, ic_id = 2;
+    int size;
+
+    FrameMgrPutToken (fm, im_id);
+    FrameMgrPutToken (fm, ic_id);
+    size = FrameMgrGetTotalSize (fm);
+    FrameMgrFree (fm);
+    return size;
+}
+
+static int codec_sync (unsigned char *buf, int swap)
+{
+    _Xi18nEncodeSync (buf, swap, 1, 2);
+    return sizeof (CARD16) * 2;
+}
+
+static int frame_preedit_draw (unsigned char *buf, int swap)
+{
+    FrameMgr fm = FrameMgrInit (preedit_draw_fr, NULL, swap);
+    CARD16 im_id = 1, ic_id = 2;
+    INT32 caret = 3, chg_first = 0, chg_length = 2;
+    BITMASK32 status = 0;
+    CARD16 length = strlen (preedit_string);
+    char *string = (char *) preedit_string;
+    int feedback_count = 3;
+    int size;
+    int i;
+
+    FrameMgrSetSize (fm, length);
+    FrameMgrSetIterCount (fm, feedback_count);
+    size = FrameMgrGetTotalSize (fm);
+    memset (buf, 0, size);
+    FrameMgrSetBuffer (fm, buf);
+    FrameMgrPutToken (fm, im_id);
+    FrameMgrPutToken (fm, ic_id);
+    FrameMgrPutToken (fm, caret);
+    FrameMgrPutToken (fm, chg_first);
+    FrameMgrPutToken (fm, chg_length);
+    FrameMgrPutToken (fm, status);
+    FrameMgrPutToken (fm, length);
+    FrameMgrPutToken (fm, string);
+    for (i = 0;  i < feedback_count;  i++)
+        FrameMgrPutToken (fm, feedback[i]);
+    /*endfor*/
+    FrameMgrFree (fm);
+    return size;
+}
+
+static int codec_preedit_draw (unsigned char *buf, int swap)
+{
+    int length = strlen (preedit_string);
+
+    _Xi18nEncodePreeditDraw (buf, swap, 1, 2, 3, 0, 2, 0,
+                             preedit_string, length, feedback, 3);
+    return _Xi18nPreeditDrawSize (length, 3);
+}
+
+static void check_decode_forward_event (void)
+{
+    unsigned char buf[BUFFER_SIZE];
+    CARD16 im_id, ic_id, flag, serial;
+    int swap;
+
+    for (swap = 0;  swap < 2;  swap++)
+    {
+        frame_forward_event (buf, swap);
+        _Xi18nDecodeForwardEvent (buf, swap, &im_id, &ic_id, &flag, &serial);
+        if (im_id != 1 || ic_id != 2 || flag != 1 || serial != 0x1234)
+        {
+            fprintf (stderr, "forward_event: decode failed (swap=%d)\n",
+                     swap);
+            failed = 1;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+}
+
+typedef int (*EncodeFunc) (unsigned char *buf, int swap);
+
+static void run (const char *name,
+                 EncodeFunc  frame,
+                 EncodeFunc  codec,
+                 long        iterations)
+{
+    unsigned char frame_buf[BUFFER_SIZE];
+    unsigned char codec_buf[BUFFER_SIZE];
+    double frame_time, codec_time, start;
+    int frame_size, codec_size;
+    int swap;
+    long i;
+
+    for (swap = 0;  swap < 2;  swap++)
+    {
+        memset (frame_buf, 0xaa, sizeof (frame_buf));
+        memset (codec_buf, 0xaa, sizeof (codec_buf));
+        frame_size = frame (frame_buf, swap);
+        codec_size = codec (codec_buf, swap);
+        if (frame_size != codec_size
+            ||
+            memcmp (frame_buf, codec_buf, frame_size) != 0)
+        {
+            fprintf (stderr, "%s: codec differs from FrameMgr (swap=%d)\n",
+                     name, swap);
+            failed = 1;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+
+    start = now ();
+    for (i = 0;  i < iterations;  i++)
+        frame (frame_buf, i & 1);
+    /*endfor*/
+    frame_time = now () - start;
+
+    start = now ();
+    for (i = 0;  i < iterations;  i++)
+        codec (codec_buf, i & 1);
+    /*endfor*/
+    codec_time = now () - start;
+
+    printf ("%-14s FrameMgr %8.1f ns  codec %8.1f ns  (x%.1f)\n",
+            name,
+            frame_time * 1e9 / iterations,
+            codec_time * 1e9 / iterations,
+            codec_time > 0 ? frame_time / codec_time : 0.0);
+}
+
+int main (int argc, char **argv)
+{
+    long iterations = 1000000;
+
+    if (argc > 1)
+        iterations = atol (argv[1]);
+    /*endif*/
+    if (iterations <= 0)
+        iterations = 1;
+    /*endif*/
+
+    check_decode_forward_event ();
+    run ("forward_event", frame_forward_event, codec_forward_event,
+         iterations);
+    run ("commit_chars", frame_commit_chars, codec_commit_chars,
+         iterations);
+    run ("sync", frame_sync, codec_sync, iterations);
+    run ("preedit_draw", frame_preedit_draw, codec_preedit_draw,
+         iterations);
+
+    return failed;
+}
@@ -123,8 +123,6 @@ int _Xi18nPreeditStartCallback (XIMS ims, IMProtocol *call_data)
 int _Xi18nPreeditDrawCallback (XIMS ims, IMProtocol *call_data)
 {
     Xi18n i18n_core = ims->protocol;
-    FrameMgr fm;
-    extern XimFrameRec preedit_draw_fr[];
     register int total_size;
     unsigned char *reply = NULL;
     IMPreeditCBStruct *preedit_CB =
@@ -142,51 +140,41 @@ int _Xi18nPreeditDrawCallback (XIMS ims, IMProtocol *call_data)
         status = 0x00000002;
     /*endif*/
 
-    fm = FrameMgrInit (preedit_draw_fr,
-                       NULL,
-                       _Xi18nNeedSwap (i18n_core, connect_id));
-
-    /* set length of preedit string */
-    FrameMgrSetSize (fm, draw->text->length);
-
-    /* set iteration count for list of feedback */
+    /* count of the list of feedback */
     for (i = 0;  draw->text->feedback[i] != 0;  i++)
         ;
     /*endfor*/
     feedback_count = i;
-    FrameMgrSetIterCount (fm, feedback_count);
 
-    total_size = FrameMgrGetTotalSize (fm);
+    /* preedit_draw_fr is encoded without FrameMgr since it is sent on
+     * every key stroke while composing. */
+    total_size = _Xi18nPreeditDrawSize (draw->text->length, feedback_count);
     reply = (unsigned char *) malloc (total_size);
     if (!reply)
     {
         _Xi18nSendMessage (ims, connect_id, XIM_ERROR, 0, 0, 0);
-        FrameMgrFree (fm);
         return False;
     }
     /*endif*/
-    memset (reply, 0, total_size);
-    FrameMgrSetBuffer (fm, reply);
+    _Xi18nEncodePreeditDraw (reply,
+                             _Xi18nNeedSwap (i18n_core, connect_id),
+                             connect_id,
+                             preedit_CB->icid,
+                             draw->caret,
+                             draw->chg_first,
+                             draw->chg_length,
+                             status,
+                             draw->text->string.multi_byte,
+                             draw->text->length,
+                             draw->text->feedback,
+                             feedback_count);
 
-    FrameMgrPutToken (fm, connect_id);
-    FrameMgrPutToken (fm, preedit_CB->icid);
-    FrameMgrPutToken (fm, draw->caret);
-    FrameMgrPutToken (fm, draw->chg_first);
-    FrameMgrPutToken (fm, draw->chg_length);
-    FrameMgrPutToken (fm, status);
-    FrameMgrPutToken (fm, draw->text->length);
-    FrameMgrPutToken (fm, draw->text->string);
-    for (i = 0;  i < feedback_count;  i++)
-        FrameMgrPutToken (fm, draw->text->feedback[i]);
-    /*endfor*/
-    
     _Xi18nSendMessage (ims,
                        connect_id,
                        XIM_PREEDIT_DRAW,
                        0,
                        reply,
                        total_size);
-    FrameMgrFree (fm);
     XFree (reply);
 
     /* XIM_PREEDIT_DRAW is an asyncronous protocol, so return immediately. */
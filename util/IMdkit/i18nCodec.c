@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 IBus contributors
+ *
+ * Permission to use, copy, modify, distribute, and sell this
+ * software and its documentation for any purpose is hereby granted
+ * without fee, provided that the above copyright notice appear in
+ * all copies and that both that copyright notice and this permission
+ * notice appear in supporting documentation, and that the name of
+ * the copyright holders not be used in advertising or publicity
+ * pertaining to distribution of the software without specific,
+ * written prior permission.  The copyright holders make no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied
+ * warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+ * ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF
+ * THIS SOFTWARE.
+ */
+
+/*
+ * Hand written encoders and decoders of the XIM messages sent or received
+ * on every key stroke.  They produce the same bytes as the FrameMgr with
+ * the templates in i18nIMProto.c without interpreting the templates.
+ */
+
+#include <X11/Xlib.h>
+#include <string.h>
+#include "IMdkit.h"
+#include "Xi18n.h"
+#include "XimFunc.h"
+
+#define PAD4(n) ((4 - ((n) % 4)) % 4)
+
+static void Put16 (unsigned char *p, int need_swap, CARD16 value)
+{
+    if (need_swap)
+        value = (CARD16) ((value << 8 & 0xFF00) | (value >> 8 & 0xFF));
+    /*endif*/
+    memcpy (p, &value, sizeof (CARD16));
+}
+
+static void Put32 (unsigned char *p, int need_swap, CARD32 value)
+{
+    if (need_swap)
+    {
+        value = (value << 24 & 0xFF000000)
+                | (value << 8 & 0xFF0000)
+                | (value >> 8 & 0xFF00)
+                | (value >> 24 & 0xFF);
+    }
+    /*endif*/
+    memcpy (p, &value, sizeof (CARD32));
+}
+
+static CARD16 Get16 (const unsigned char *p, int need_swap)
+{
+    CARD16 value;
+
+    memcpy (&value, p, sizeof (CARD16));
+    if (need_swap)
+        value = (CARD16) ((value << 8 & 0xFF00) | (value >> 8 & 0xFF));
+    /*endif*/
+    return value;
+}
+
+/* forward_event_fr */
+void _Xi18nEncodeForwardEvent (unsigned char *buf,
+                               int need_swap,
+                               CARD16 im_id,
+                               CARD16 ic_id,
+                               CARD16 flag,
+                               CARD16 serial)
+{
+    Put16 (buf, need_swap, im_id);
+    Put16 (buf + 2, need_swap, ic_id);
+    Put16 (buf + 4, need_swap, flag);
+    Put16 (buf + 6, need_swap, serial);
+}
+
+void _Xi18nDecodeForwardEvent (const unsigned char *buf,
+                               int need_swap,
+                               CARD16 *im_id,
+                               CARD16 *ic_id,
+                               CARD16 *flag,
+                               CARD16 *serial)
+{
+    *im_id = Get16 (buf, need_swap);
+    *ic_id = Get16 (buf + 2, need_swap);
+    *flag = Get16 (buf + 4, need_swap);
+    *serial = Get16 (buf + 6, need_swap);
+}
+
+/* commit_chars_fr */
+int _Xi18nCommitCharsSize (int length)
+{
+    return 8 + length + PAD4 (length);
+}
+
+void _Xi18nEncodeCommitChars (unsigned char *buf,
+                              int need_swap,
+                              CARD16 im_id,
+                              CARD16 ic_id,
+                              CARD16 flag,
+                              const char *string,
+                              int length)
+{
+    Put16 (buf, need_swap, im_id);
+    Put16 (buf + 2, need_swap, ic_id);
+    Put16 (buf + 4, need_swap, flag);
+    Put16 (buf + 6, need_swap, (CARD16) length);
+    memcpy (buf + 8, string, length);
+    memset (buf + 8 + length, 0, PAD4 (length));
+}
+
+/* sync_fr */
+void _Xi18nEncodeSync (unsigned char *buf,
+                       int need_swap,
+                       CARD16 im_id,
+                       CARD16 ic_id)
+{
+    Put16 (buf, need_swap, im_id);
+    Put16 (buf + 2, need_swap, ic_id);
+}
+
+/* preedit_draw_fr */
+int _Xi18nPreeditDrawSize (int length, int feedback_count)
+{
+    return 22 + length + PAD4 (2 + length) + 4 + 4 * feedback_count;
+}
+
+void _Xi18nEncodePreeditDraw (unsigned char *buf,
+                              int need_swap,
+                              CARD16 im_id,
+                              CARD16 ic_id,
+                              INT32 caret,
+                              INT32 chg_first,
+                              INT32 chg_length,
+                              BITMASK32 status,
+                              const char *string,
+                              int length,
+                              const XIMFeedback *feedback,
+                              int feedback_count)
+{
+    int i;
+
+    Put16 (buf, need_swap, im_id);
+    Put16 (buf + 2, need_swap, ic_id);
+    Put32 (buf + 4, need_swap, (CARD32) caret);
+    Put32 (buf + 8, need_swap, (CARD32) chg_first);
+    Put32 (buf + 12, need_swap, (CARD32) chg_length);
+    Put32 (buf + 16, need_swap, status);
+    Put16 (buf + 20, need_swap, (CARD16) length);
+    if (length > 0)
+        memcpy (buf + 22, string, length);
+    /*endif*/
+    buf += 22 + length;
+    memset (buf, 0, PAD4 (2 + length));
+    buf += PAD4 (2 + length);
+    /* byte length of the feedback array and its padding */
+    Put16 (buf, need_swap, (CARD16) (4 * feedback_count));
+    memset (buf + 2, 0, 2);
+    buf += 4;
+    for (i = 0;  i < feedback_count;  i++)
+        Put32 (buf + 4 * i, need_swap, (CARD32) feedback[i]);
+    /*endfor*/
+}
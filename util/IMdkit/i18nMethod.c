@@ -901,65 +901,40 @@ static Status xi18n_forwardEvent (XIMS ims, XPointer xp)
 {
     Xi18n i18n_core = ims->protocol;
     IMForwardEventStruct *call_data = (IMForwardEventStruct *)xp;
-    FrameMgr fm;
-    extern XimFrameRec forward_event_fr[];
-    register int total_size;
-    unsigned char *reply = NULL;
-    unsigned char *replyp;
+    /* the size of forward_event_fr */
+    const int total_size = sizeof (CARD16) * 4;
+    unsigned char reply[sizeof (CARD16) * 4 + sizeof (xEvent)];
     CARD16 serial;
-    int event_size;
+    int need_swap;
     Xi18nClient *client;
 
     client = (Xi18nClient *) _Xi18nFindClient (i18n_core, call_data->connect_id);
+    need_swap = _Xi18nNeedSwap (i18n_core, call_data->connect_id);
 
-    /* create FrameMgr */
-    fm = FrameMgrInit (forward_event_fr,
-                       NULL,
-                       _Xi18nNeedSwap (i18n_core, call_data->connect_id));
-
-    total_size = FrameMgrGetTotalSize (fm);
-    event_size = sizeof (xEvent);
-    reply = (unsigned char *) malloc (total_size + event_size);
-    if (!reply)
-    {
-        _Xi18nSendMessage (ims,
-                           call_data->connect_id,
-                           XIM_ERROR,
-                           0,
-                           0,
-                           0);
-        FrameMgrFree (fm);
-        return False;
-    }
-    /*endif*/
-    memset (reply, 0, total_size + event_size);
-    FrameMgrSetBuffer (fm, reply);
-    replyp = reply;
+    /* XIM_FORWARD_EVENT is sent on every key stroke, so the fixed size
+     * frame is encoded without FrameMgr. */
+    memset (reply, 0, sizeof (reply));
 
     call_data->sync_bit = 1; 	/* always sync */
     client->sync = True;
 
-    FrameMgrPutToken (fm, call_data->connect_id);
-    FrameMgrPutToken (fm, call_data->icid);
-    FrameMgrPutToken (fm, call_data->sync_bit);
-
-    replyp += total_size;
     EventToWireEvent (&(call_data->event),
-                      (xEvent *) replyp,
+                      (xEvent *) (reply + total_size),
                       &serial,
-                      _Xi18nNeedSwap (i18n_core, call_data->connect_id));
-
-    FrameMgrPutToken (fm, serial);
+                      need_swap);
+    _Xi18nEncodeForwardEvent (reply,
+                              need_swap,
+                              call_data->connect_id,
+                              call_data->icid,
+                              call_data->sync_bit,
+                              serial);
 
     _Xi18nSendMessage (ims,
                        call_data->connect_id,
                        XIM_FORWARD_EVENT,
                        0,
                        reply,
-                       total_size + event_size);
-
-    XFree (reply);
-    FrameMgrFree (fm);
+                       sizeof (reply));
 
     return True;
 }
@@ -969,7 +944,6 @@ static Status xi18n_commit (XIMS ims, XPointer xp)
     Xi18n i18n_core = ims->protocol;
     IMCommitStruct *call_data = (IMCommitStruct *)xp;
     FrameMgr fm;
-    extern XimFrameRec commit_chars_fr[];
     extern XimFrameRec commit_both_fr[];
     register int total_size;
     unsigned char *reply = NULL;
@@ -981,14 +955,10 @@ static Status xi18n_commit (XIMS ims, XPointer xp)
         &&
         (call_data->flag & XimLookupChars))
     {
-        fm = FrameMgrInit (commit_chars_fr,
-                           NULL,
-                           _Xi18nNeedSwap (i18n_core, call_data->connect_id));
-
-        /* set length of STRING8 */
+        /* commit_chars_fr is encoded without FrameMgr since it is sent on
+         * every committed character. */
         str_length = strlen (call_data->commit_string);
-        FrameMgrSetSize (fm, str_length);
-        total_size = FrameMgrGetTotalSize (fm);
+        total_size = _Xi18nCommitCharsSize (str_length);
         reply = (unsigned char *) malloc (total_size);
         if (!reply)
         {
@@ -998,19 +968,25 @@ static Status xi18n_commit (XIMS ims, XPointer xp)
                                0,
                                0,
                                0);
-            FrameMgrFree (fm);
             return False;
         }
         /*endif*/
-        memset (reply, 0, total_size);
-        FrameMgrSetBuffer (fm, reply);
-
-        str_length = FrameMgrGetSize (fm);
-        FrameMgrPutToken (fm, call_data->connect_id);
-        FrameMgrPutToken (fm, call_data->icid);
-        FrameMgrPutToken (fm, call_data->flag);
-        FrameMgrPutToken (fm, str_length);
-        FrameMgrPutToken (fm, call_data->commit_string);
+        _Xi18nEncodeCommitChars (reply,
+                                 _Xi18nNeedSwap (i18n_core,
+                                                 call_data->connect_id),
+                                 call_data->connect_id,
+                                 call_data->icid,
+                                 call_data->flag,
+                                 call_data->commit_string,
+                                 str_length);
+        _Xi18nSendMessage (ims,
+                           call_data->connect_id,
+                           XIM_COMMIT,
+                           0,
+                           reply,
+                           total_size);
+        XFree (reply);
+        return True;
     }
     else
     {
@@ -1155,33 +1131,16 @@ static int xi18n_syncXlib (XIMS ims, XPointer xp)
     Xi18n i18n_core = ims->protocol;
     IMSyncXlibStruct *sync_xlib;
 
-    extern XimFrameRec sync_fr[];
-    FrameMgr fm;
     CARD16 connect_id = call_data->any.connect_id;
-    int total_size;
-    unsigned char *reply;
+    /* the size of sync_fr */
+    unsigned char reply[sizeof (CARD16) * 2];
 
     sync_xlib = (IMSyncXlibStruct *) &call_data->sync_xlib;
-    fm = FrameMgrInit (sync_fr, NULL,
-                       _Xi18nNeedSwap (i18n_core, connect_id));
-    total_size = FrameMgrGetTotalSize(fm);
-    reply = (unsigned char *) malloc (total_size);
-    if (!reply) {
-        _Xi18nSendMessage (ims, connect_id, XIM_ERROR, 0, 0, 0);
-        FrameMgrFree (fm);
-        return False;
-    }
-    memset (reply, 0, total_size);
-    FrameMgrSetBuffer (fm, reply);
-
-    /* input input-method ID */
-    FrameMgrPutToken (fm, connect_id);
-    /* input input-context ID */
-    FrameMgrPutToken (fm, sync_xlib->icid);
-    _Xi18nSendMessage (ims, connect_id, XIM_SYNC, 0, reply, total_size);
-
-    FrameMgrFree (fm);
-    XFree(reply);
+    _Xi18nEncodeSync (reply,
+                      _Xi18nNeedSwap (i18n_core, connect_id),
+                      connect_id,
+                      sync_xlib->icid);
+    _Xi18nSendMessage (ims, connect_id, XIM_SYNC, 0, reply, sizeof (reply));
     return True;
 }
 
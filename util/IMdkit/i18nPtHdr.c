@@ -1192,27 +1192,27 @@ static void ForwardEventMessageProc (XIMS ims,
                                      unsigned char *p)
 {
     Xi18n i18n_core = ims->protocol;
-    FrameMgr fm;
-    extern XimFrameRec forward_event_fr[];
     xEvent wire_event;
     IMForwardEventStruct *forward =
         (IMForwardEventStruct*) &call_data->forwardevent;
     CARD16 connect_id = call_data->any.connect_id;
     CARD16 input_method_ID;
-
-    fm = FrameMgrInit (forward_event_fr,
-                       (char *) p,
-                       _Xi18nNeedSwap (i18n_core, connect_id));
-    /* get data */
-    FrameMgrGetToken (fm, input_method_ID);
-    FrameMgrGetToken (fm, forward->icid);
-    FrameMgrGetToken (fm, forward->sync_bit);
-    FrameMgrGetToken (fm, forward->serial_number);
+    CARD16 icid, sync_bit, serial_number;
+
+    /* get data of forward_event_fr without FrameMgr since this is
+     * received on every key stroke. */
+    _Xi18nDecodeForwardEvent (p,
+                              _Xi18nNeedSwap (i18n_core, connect_id),
+                              &input_method_ID,
+                              &icid,
+                              &sync_bit,
+                              &serial_number);
+    forward->icid = icid;
+    forward->sync_bit = sync_bit;
+    forward->serial_number = serial_number;
     p += sizeof (CARD16)*4;
     memmove (&wire_event, p, sizeof (xEvent));
 
-    FrameMgrFree (fm);
-
     if (WireEventToEvent (i18n_core,
                           &wire_event,
                           forward->serial_number,